@@ -0,0 +1,185 @@
+// SweepAndPrune と総当たり(O(n^2))の接触検出を物体数 1k ～ 1M で比較するベンチマーク
+//  物体の密度は一定にして、毎フレーム少しずつ動かしたときの1フレームあたりの時間を計測する
+//  総当たりは kBruteForceLimit 個までだけ実測し、それより多い場合は n^2 で外挿する
+//  実測する場合は一部のプロキシを削除・再追加してから結果を総当たりと照合する
+//  最後に SpatialHashGrid::Query を、近傍の範囲が構築時より広くなる半径も含めて総当たりと照合する
+#include "../Math/BroadPhase.h"
+#include "../Math/SpatialHashGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+	const size_t kBruteForceLimit = 20000;
+	const int kFrameCount = 10;
+	const float kRadius = 0.5f;
+	// 1物体あたりの空間の体積
+	const float kVolumePerObject = 30.0f;
+
+	struct Scene {
+		std::vector<Sphere> spheres;
+		std::vector<AABB> boxes;
+	};
+
+	Scene MakeScene(size_t count, std::mt19937& engine) {
+		float halfSize = 0.5f * std::cbrt(kVolumePerObject * static_cast<float>(count));
+		std::uniform_real_distribution<float> position(-halfSize, halfSize);
+		std::uniform_real_distribution<float> extent(0.2f, kRadius);
+		Scene scene;
+		for (size_t i = 0; i < count; ++i) {
+			Vector3 center = { position(engine), position(engine), position(engine) };
+			if (i % 2 == 0) {
+				scene.spheres.push_back({ center, kRadius });
+			} else {
+				Vector3 half = { extent(engine), extent(engine), extent(engine) };
+				scene.boxes.push_back({ center - half, center + half });
+			}
+		}
+		return scene;
+	}
+
+	void Jitter(Scene& scene, std::mt19937& engine) {
+		std::uniform_real_distribution<float> move(-0.05f, 0.05f);
+		for (Sphere& sphere : scene.spheres) {
+			sphere.center += { move(engine), move(engine), move(engine) };
+		}
+		for (AABB& box : scene.boxes) {
+			Vector3 offset = { move(engine), move(engine), move(engine) };
+			box.min += offset;
+			box.max += offset;
+		}
+	}
+
+	size_t BruteForce(const Scene& scene) {
+		size_t contacts = 0;
+		for (size_t i = 0; i < scene.spheres.size(); ++i) {
+			for (size_t j = i + 1; j < scene.spheres.size(); ++j) {
+				contacts += Collision::isCollision(scene.spheres[i], scene.spheres[j]) ? 1 : 0;
+			}
+			for (const AABB& box : scene.boxes) {
+				contacts += Collision::isCollision(box, scene.spheres[i]) ? 1 : 0;
+			}
+		}
+		for (size_t i = 0; i < scene.boxes.size(); ++i) {
+			for (size_t j = i + 1; j < scene.boxes.size(); ++j) {
+				contacts += Collision::isCollision(scene.boxes[i], scene.boxes[j]) ? 1 : 0;
+			}
+		}
+		return contacts;
+	}
+
+	// 小さい範囲に詰めた球に対して、いろいろな半径で Query した結果が総当たりと一致するか
+	bool CheckSpatialHashQuery(std::mt19937& engine) {
+		std::uniform_real_distribution<float> position(0.05f, 1.9f);
+		std::vector<Sphere> spheres;
+		for (int i = 0; i < 1000; ++i) {
+			spheres.push_back({ { position(engine), position(engine), position(engine) }, 1.0f });
+		}
+		SpatialHashGrid grid;
+		grid.Build(spheres);
+
+		std::uniform_real_distribution<float> center(-2.0f, 4.0f);
+		std::vector<uint32_t> result;
+		for (float radius : { 0.1f, 1.0f, 2.0f, 3.5f, 5.0f }) {
+			for (int query = 0; query < 20; ++query) {
+				Sphere sphere = { { center(engine), center(engine), center(engine) }, radius };
+				grid.Query(sphere, result);
+				std::sort(result.begin(), result.end());
+				std::vector<uint32_t> expected;
+				for (uint32_t i = 0; i < spheres.size(); ++i) {
+					// Query と同じく距離の2乗で比べる
+					float radiusSum = sphere.radius + spheres[i].radius;
+					if ((sphere.center - spheres[i].center).LengthSquared() <= radiusSum * radiusSum) {
+						expected.push_back(i);
+					}
+				}
+				if (result != expected) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	double ElapsedMs(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main() {
+	std::printf("%10s %14s %14s %14s %10s\n", "objects", "SAP first(ms)", "SAP frame(ms)", "brute(ms)", "contacts");
+	double bruteReferenceMs = 0.0;
+	size_t bruteReferenceCount = 0;
+
+	for (size_t count : { size_t(1000), size_t(10000), size_t(100000), size_t(1000000) }) {
+		std::mt19937 engine(static_cast<unsigned int>(count));
+		Scene scene = MakeScene(count, engine);
+
+		SweepAndPrune sap;
+		std::vector<uint32_t> sphereIds;
+		std::vector<uint32_t> boxIds;
+		for (const Sphere& sphere : scene.spheres) {
+			sphereIds.push_back(sap.Add(sphere));
+		}
+		for (const AABB& box : scene.boxes) {
+			boxIds.push_back(sap.Add(box));
+		}
+
+		std::vector<BroadPhasePair> contacts;
+		auto start = std::chrono::steady_clock::now();
+		sap.FindContacts(contacts);
+		double firstMs = ElapsedMs(start);
+
+		double frameMs = 0.0;
+		for (int frame = 0; frame < kFrameCount; ++frame) {
+			Jitter(scene, engine);
+			start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < scene.spheres.size(); ++i) {
+				sap.Update(sphereIds[i], scene.spheres[i]);
+			}
+			for (size_t i = 0; i < scene.boxes.size(); ++i) {
+				sap.Update(boxIds[i], scene.boxes[i]);
+			}
+			sap.FindContacts(contacts);
+			frameMs += ElapsedMs(start);
+		}
+		frameMs /= kFrameCount;
+
+		char brute[32];
+		if (count <= kBruteForceLimit) {
+			// 一部を削除してすぐ追加し直し (削除した ID が再利用される)、その後も総当たりと一致するか確かめる
+			for (size_t i = 0; i < scene.spheres.size(); i += 3) {
+				sap.Remove(sphereIds[i]);
+			}
+			for (size_t i = 0; i < scene.boxes.size(); i += 5) {
+				sap.Remove(boxIds[i]);
+			}
+			for (size_t i = 0; i < scene.spheres.size(); i += 3) {
+				sphereIds[i] = sap.Add(scene.spheres[i]);
+			}
+			for (size_t i = 0; i < scene.boxes.size(); i += 5) {
+				boxIds[i] = sap.Add(scene.boxes[i]);
+			}
+			sap.FindContacts(contacts);
+
+			start = std::chrono::steady_clock::now();
+			size_t bruteContacts = BruteForce(scene);
+			bruteReferenceMs = ElapsedMs(start);
+			bruteReferenceCount = count;
+			std::snprintf(brute, sizeof(brute), "%.2f%s", bruteReferenceMs, bruteContacts == contacts.size() ? "" : " MISMATCH");
+		} else {
+			double ratio = static_cast<double>(count) / static_cast<double>(bruteReferenceCount);
+			std::snprintf(brute, sizeof(brute), "~%.0f (est.)", bruteReferenceMs * ratio * ratio);
+		}
+
+		std::printf("%10zu %14.2f %14.2f %14s %10zu\n", count, firstMs, frameMs, brute, contacts.size());
+	}
+
+	std::mt19937 engine(1);
+	bool queryMatches = CheckSpatialHashQuery(engine);
+	std::printf("SpatialHashGrid::Query vs brute: %s\n", queryMatches ? "OK" : "MISMATCH");
+	return queryMatches ? 0 : 1;
+}
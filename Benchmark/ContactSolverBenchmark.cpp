@@ -0,0 +1,180 @@
+// ContactSolver の積み重ねを検証するベンチマーク
+//  縦に積んだボールの列と、壁で囲った床に落として積もらせた山を固定ステップで進め、1ステップの時間と最終状態の誤差を出力する
+//  列は静止位置からのずれ、山は最後の1秒で動いた距離・めり込み・速さを見て、許容値を超えたか値が有限でなくなれば DIVERGED を出して終了コード1を返す
+//  山はスレッドなしと JobSystem の両方で解き、結果が一致するか (スレッド数に依存しないか) も調べる
+#include "../Math/ContactSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+	const float kDeltaTime = 1.0f / 240.0f;
+	const float kGravity = -9.8f;
+
+	const int kColumnHeight = 10;
+	const float kColumnRadius = 0.5f;
+	const int kColumnSteps = 240 * 4;
+	// 静止位置からのずれの許容値 (接触ごとに linearSlop まではめり込んでよいので段数に比例させる)
+	const float kColumnTolerance = 0.005f * kColumnHeight;
+
+	const int kPileSide = 12;
+	const int kPileLayers = 10;
+	const float kPileHalfWidth = 2.5f;
+	const int kPileSteps = 240 * 6;
+	const int kSettleCheckSteps = 240;
+	const float kPileDriftTolerance = 0.01f;
+	const float kPilePenetrationTolerance = 0.02f;
+	const float kPileSpeedTolerance = 0.05f;
+
+	struct Result {
+		double milliseconds; //!< 1ステップあたりの時間
+		float positionError; //!< 列: 静止位置からのずれの最大、山: 最後の1秒で動いた距離の最大
+		float penetration; //!< 最大のめり込み
+		float maxSpeed; //!< 最後の速さの最大
+		bool finite; //!< 位置と速度が全て有限か
+	};
+
+	bool IsFinite(const Vector3& v) {
+		return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+	}
+
+	Ball MakeBall(const Vector3& position, float radius) {
+		Ball ball{};
+		ball.position = position;
+		ball.acceleration = { 0.0f, kGravity, 0.0f };
+		ball.mass = 1.0f;
+		ball.radius = radius;
+		return ball;
+	}
+
+	template<typename Function>
+	double MeasureSteps(int steps, Function function) {
+		auto start = std::chrono::steady_clock::now();
+		for (int step = 0; step < steps; ++step) {
+			function();
+		}
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / steps;
+	}
+
+	// 最大のめり込みと速さを調べる (平面は solver に追加したもの)
+	void MeasureState(const BallSystem& balls, const std::vector<Plane>& planes, Result& result) {
+		result.penetration = 0.0f;
+		result.maxSpeed = 0.0f;
+		result.finite = true;
+		for (size_t i = 0; i < balls.Size(); ++i) {
+			Vector3 position = balls.GetPosition(i);
+			Vector3 velocity = balls.GetVelocity(i);
+			result.finite = result.finite && IsFinite(position) && IsFinite(velocity);
+			result.maxSpeed = std::max(result.maxSpeed, velocity.Length());
+			for (const Plane& plane : planes) {
+				result.penetration = std::max(result.penetration, balls.GetRadius(i) - plane.SignedDistance(position));
+			}
+			for (size_t j = i + 1; j < balls.Size(); ++j) {
+				float distance = (position - balls.GetPosition(j)).Length();
+				result.penetration = std::max(result.penetration, balls.GetRadius(i) + balls.GetRadius(j) - distance);
+			}
+		}
+	}
+
+	// 床に縦に積んだ列 (静止位置から始めて、崩れたり沈んだりしないか)
+	Result RunColumn() {
+		Plane floor = { { 0.0f, 1.0f, 0.0f }, 0.0f };
+		ContactSolver solver;
+		solver.AddPlane(floor);
+		BallSystem balls;
+		for (int i = 0; i < kColumnHeight; ++i) {
+			balls.Add(MakeBall({ 0.0f, kColumnRadius * static_cast<float>(2 * i + 1), 0.0f }, kColumnRadius));
+		}
+
+		Result result;
+		result.milliseconds = MeasureSteps(kColumnSteps, [&]() { solver.Step(balls, kDeltaTime); });
+		MeasureState(balls, { floor }, result);
+		result.positionError = 0.0f;
+		for (int i = 0; i < kColumnHeight; ++i) {
+			Vector3 rest = { 0.0f, kColumnRadius * static_cast<float>(2 * i + 1), 0.0f };
+			result.positionError = std::max(result.positionError, (balls.GetPosition(i) - rest).Length());
+		}
+		return result;
+	}
+
+	// 壁で囲った床に格子状に並べたボールを落として積もらせる (奇数段は半分ずらし、下の段の隙間へ崩れ落ちるようにする)
+	Result RunPile(JobSystem* jobSystem, BallSystem& balls) {
+		std::vector<Plane> planes = {
+			{ { 0.0f, 1.0f, 0.0f }, 0.0f },
+			{ { 1.0f, 0.0f, 0.0f }, -kPileHalfWidth },
+			{ { -1.0f, 0.0f, 0.0f }, -kPileHalfWidth },
+			{ { 0.0f, 0.0f, 1.0f }, -kPileHalfWidth },
+			{ { 0.0f, 0.0f, -1.0f }, -kPileHalfWidth },
+		};
+		ContactSolver solver;
+		for (const Plane& plane : planes) {
+			solver.AddPlane(plane);
+		}
+
+		std::mt19937 engine(12345);
+		std::uniform_real_distribution<float> radius(0.15f, 0.2f);
+		std::uniform_real_distribution<float> jitter(-0.02f, 0.02f);
+		float spacing = 2.0f * kPileHalfWidth / kPileSide;
+		balls.Clear();
+		for (int y = 0; y < kPileLayers; ++y) {
+			int offset = y % 2;
+			for (int z = 0; z < kPileSide - offset; ++z) {
+				for (int x = 0; x < kPileSide - offset; ++x) {
+					Vector3 position = {
+						-kPileHalfWidth + spacing * (static_cast<float>(x) + 0.5f + 0.5f * static_cast<float>(offset)) + jitter(engine),
+						spacing * (static_cast<float>(y) + 0.5f),
+						-kPileHalfWidth + spacing * (static_cast<float>(z) + 0.5f + 0.5f * static_cast<float>(offset)) + jitter(engine),
+					};
+					balls.Add(MakeBall(position, radius(engine)));
+				}
+			}
+		}
+
+		Result result;
+		result.milliseconds = MeasureSteps(kPileSteps - kSettleCheckSteps, [&]() { solver.Step(balls, kDeltaTime, jobSystem); });
+		std::vector<Vector3> settled(balls.Size());
+		for (size_t i = 0; i < balls.Size(); ++i) {
+			settled[i] = balls.GetPosition(i);
+		}
+		for (int step = 0; step < kSettleCheckSteps; ++step) {
+			solver.Step(balls, kDeltaTime, jobSystem);
+		}
+		MeasureState(balls, planes, result);
+		result.positionError = 0.0f;
+		for (size_t i = 0; i < balls.Size(); ++i) {
+			result.positionError = std::max(result.positionError, (balls.GetPosition(i) - settled[i]).Length());
+		}
+		return result;
+	}
+
+	bool Report(const char* name, const Result& result, float positionTolerance, float penetrationTolerance, float speedTolerance) {
+		bool diverged = !result.finite || !(result.positionError <= positionTolerance) ||
+			!(result.penetration <= penetrationTolerance) || !(result.maxSpeed <= speedTolerance);
+		std::printf("%-22s %8.3f ms/step  position error %8.5f  penetration %8.5f  speed %8.5f  %s\n",
+			name, result.milliseconds, result.positionError, result.penetration, result.maxSpeed, diverged ? "DIVERGED" : "OK");
+		return !diverged;
+	}
+}
+
+int main() {
+	bool ok = Report("column", RunColumn(), kColumnTolerance, kColumnTolerance, kPileSpeedTolerance);
+
+	BallSystem serialBalls;
+	BallSystem parallelBalls;
+	JobSystem jobSystem;
+	ok = Report("pile", RunPile(nullptr, serialBalls), kPileDriftTolerance, kPilePenetrationTolerance, kPileSpeedTolerance) && ok;
+	ok = Report("pile (JobSystem)", RunPile(&jobSystem, parallelBalls), kPileDriftTolerance, kPilePenetrationTolerance, kPileSpeedTolerance) && ok;
+
+	bool same = serialBalls.Size() == parallelBalls.Size();
+	for (size_t i = 0; same && i < serialBalls.Size(); ++i) {
+		Vector3 a = serialBalls.GetPosition(i);
+		Vector3 b = parallelBalls.GetPosition(i);
+		same = a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+	std::printf("pile serial vs JobSystem: %s\n", same ? "OK" : "MISMATCH");
+	return ok && same ? 0 : 1;
+}
@@ -0,0 +1,951 @@
+// Math / Collision / Draw / Curve / Camera / Transform の全ての入口を計測するマイクロベンチマーク (Google Benchmark 風の最小限のハーネス)
+//  入力はシード付きの乱数で作り、衝突判定は当たりの割合 (--hit-ratio) を指定できる
+//  結果は表で出力し、--json=<file> で Google Benchmark と同じ形の JSON にも書き出す
+//  --baseline=<file> を渡すと前回の JSON と比較し、threshold 以上遅くなったものがあれば終了コード1を返す
+//  最後にパケット版の判定と TriangleBVH をスカラー版と照合し、食い違えば MISMATCH を出して終了コード1を返す
+//
+//  MathBenchmark [--filter=<部分一致>] [--hit-ratio=0.5] [--seed=12345] [--min-time=0.1]
+//                [--repetitions=3] [--json=<file>] [--baseline=<file>] [--threshold=0.1]
+#include "../Math/Draw.h"
+#include "../Math/Curve.h"
+#include "../Math/Camera.h"
+#include "../Math/TransformHierarchy.h"
+#include "../Math/RayPacket.h"
+#include "../Math/TriangleBVH.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+	// 入力の数 (2の累乗。反復ごとに順番に使い回す)
+	const size_t kPoolSize = 1024;
+	const size_t kPoolMask = kPoolSize - 1;
+	// Draw で1フレームに描く数の目安 (バッチが大きくなりすぎないよう、この回数ごとに Flush する)
+	const size_t kFlushInterval = 16;
+
+	volatile float gSink;
+	volatile size_t gHitSink;
+
+	struct Options {
+		std::string filter;
+		double hitRatio = 0.5;
+		uint32_t seed = 12345;
+		double minTime = 0.1;
+		int repetitions = 3;
+		std::string jsonPath;
+		std::string baselinePath;
+		double threshold = 0.1;
+	};
+
+	// 計測中のベンチマークの状態
+	//  for (size_t i : state) { ... } の形で回し、ループの開始から終了までを計測する
+	class BenchmarkState {
+	public:
+		class Iterator {
+		public:
+			Iterator(BenchmarkState* state, size_t index) : state_(state), index_(index) {}
+			size_t operator*() const { return index_; }
+			Iterator& operator++() {
+				++index_;
+				return *this;
+			}
+			bool operator!=(const Iterator& other) const {
+				if (index_ != other.index_) {
+					return true;
+				}
+				state_->Stop();
+				return false;
+			}
+
+		private:
+			BenchmarkState* state_;
+			size_t index_;
+		};
+
+		explicit BenchmarkState(size_t iterations) : iterations_(iterations) {}
+
+		Iterator begin() {
+			start_ = std::chrono::steady_clock::now();
+			return Iterator(this, 0);
+		}
+		Iterator end() { return Iterator(this, iterations_); }
+
+		size_t Iterations() const { return iterations_; }
+		double Seconds() const { return seconds_; }
+
+		// 衝突判定の当たりの数 (当たりの割合として出力する)
+		void SetHits(size_t hits) {
+			hits_ = hits;
+			hasHits_ = true;
+		}
+		bool HasHits() const { return hasHits_; }
+		double HitRatio() const { return static_cast<double>(hits_) / static_cast<double>(iterations_); }
+
+	private:
+		void Stop() { seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count(); }
+
+		size_t iterations_;
+		std::chrono::steady_clock::time_point start_;
+		double seconds_ = 0.0;
+		size_t hits_ = 0;
+		bool hasHits_ = false;
+	};
+
+	struct Benchmark {
+		std::string name;
+		std::function<void(BenchmarkState&)> function;
+	};
+
+	struct BenchmarkResult {
+		std::string name;
+		size_t iterations;
+		double nanoseconds; //!< 1回あたりの時間 (繰り返しの中央値)
+		double hitRatio; //!< 当たりの割合 (衝突判定以外は負)
+	};
+
+	// 1回あたり minTime 秒以上になるまで反復回数を増やして計測する
+	BenchmarkResult Run(const Benchmark& benchmark, const Options& options) {
+		size_t iterations = 1;
+		BenchmarkState state(iterations);
+		for (;;) {
+			state = BenchmarkState(iterations);
+			benchmark.function(state);
+			if (state.Seconds() >= options.minTime || iterations >= (size_t(1) << 34)) {
+				break;
+			}
+			double scale = state.Seconds() > 0.0 ? 1.4 * options.minTime / state.Seconds() : 10.0;
+			scale = std::clamp(scale, 2.0, 10.0);
+			iterations = static_cast<size_t>(static_cast<double>(iterations) * scale);
+		}
+
+		std::vector<double> times = { state.Seconds() };
+		for (int repetition = 1; repetition < options.repetitions; ++repetition) {
+			BenchmarkState repeated(iterations);
+			benchmark.function(repeated);
+			times.push_back(repeated.Seconds());
+		}
+		std::sort(times.begin(), times.end());
+
+		BenchmarkResult result;
+		result.name = benchmark.name;
+		result.iterations = iterations;
+		result.nanoseconds = times[times.size() / 2] * 1e9 / static_cast<double>(iterations);
+		result.hitRatio = state.HasHits() ? state.HitRatio() : -1.0;
+		return result;
+	}
+
+	//--------------------------------------------------------------------------------
+	// 入力の生成
+	//--------------------------------------------------------------------------------
+
+	Vector3 RandomVector(std::mt19937& engine, float range) {
+		std::uniform_real_distribution<float> value(-range, range);
+		return { value(engine), value(engine), value(engine) };
+	}
+
+	Vector3 RandomDirection(std::mt19937& engine) {
+		for (;;) {
+			Vector3 v = RandomVector(engine, 1.0f);
+			float lengthSquared = v.LengthSquared();
+			if (lengthSquared > 1e-4f && lengthSquared <= 1.0f) {
+				return v / std::sqrt(lengthSquared);
+			}
+		}
+	}
+
+	float RandomFloat(std::mt19937& engine, float min, float max) {
+		return std::uniform_real_distribution<float>(min, max)(engine);
+	}
+
+	Sphere RandomSphere(std::mt19937& engine) {
+		return { RandomVector(engine, 2.0f), RandomFloat(engine, 0.2f, 1.0f) };
+	}
+
+	// 画面上の半径が数ピクセルの球 (LOD で分割数が減る)
+	Sphere RandomSmallSphere(std::mt19937& engine) {
+		return { RandomVector(engine, 2.0f), RandomFloat(engine, 0.01f, 0.05f) };
+	}
+
+	Plane RandomPlane(std::mt19937& engine) {
+		return { RandomDirection(engine), RandomFloat(engine, -1.0f, 1.0f) };
+	}
+
+	AABB RandomAABB(std::mt19937& engine) {
+		Vector3 center = RandomVector(engine, 2.0f);
+		Vector3 half = { RandomFloat(engine, 0.1f, 1.0f), RandomFloat(engine, 0.1f, 1.0f), RandomFloat(engine, 0.1f, 1.0f) };
+		return { center - half, center + half };
+	}
+
+	Triangle RandomTriangle(std::mt19937& engine) {
+		Vector3 center = RandomVector(engine, 0.5f);
+		return { { center + RandomVector(engine, 1.0f), center + RandomVector(engine, 1.0f), center + RandomVector(engine, 1.0f) } };
+	}
+
+	CubicBezier RandomCubicBezier(std::mt19937& engine) {
+		Vector3 center = RandomVector(engine, 0.5f);
+		return { { center + RandomVector(engine, 1.0f), center + RandomVector(engine, 1.0f), center + RandomVector(engine, 1.0f), center + RandomVector(engine, 1.0f) } };
+	}
+
+	// 4区間の Catmull-Rom スプライン
+	Curve RandomCurve(std::mt19937& engine) {
+		Curve curve{ CurveType::kCatmullRom, {} };
+		for (int i = 0; i < 7; ++i) {
+			curve.controlPoints.push_back(RandomVector(engine, 2.0f));
+		}
+		return curve;
+	}
+
+	Quaternion RandomQuaternion(std::mt19937& engine) {
+		return MakeRotateXYZQuaternion(RandomVector(engine, 3.14f));
+	}
+
+	// 始点と差分 (Segment / Ray / Line 共通)
+	template<typename T>
+	T RandomLinear(std::mt19937& engine) {
+		return { RandomVector(engine, 2.0f), RandomVector(engine, 2.0f) };
+	}
+
+	Capsule RandomCapsule(std::mt19937& engine) {
+		return { RandomLinear<Segment>(engine), RandomFloat(engine, 0.1f, 0.5f) };
+	}
+
+	// 直線と平面は平行でなければ必ず当たるので、軸に沿った平面と平行な直線を半分混ぜる
+	std::pair<Line, Plane> RandomLinePlane(std::mt19937& engine) {
+		int axis = std::uniform_int_distribution<int>(0, 2)(engine);
+		Plane plane = { { 0.0f, 0.0f, 0.0f }, RandomFloat(engine, -1.0f, 1.0f) };
+		(&plane.normal.x)[axis] = 1.0f;
+		Line line = RandomLinear<Line>(engine);
+		if (std::uniform_int_distribution<int>(0, 1)(engine) == 0) {
+			(&line.diff.x)[axis] = 0.0f;
+		}
+		return { line, plane };
+	}
+
+	// 当たり・外れを判定しながら組を作り、当たりの割合が hitRatio になるように集めてシャッフルする
+	//  外れ (当たり) が出にくい組み合わせで集めきれなかったときは、出たものをそのまま使う
+	template<typename A, typename B, typename Generate, typename Test>
+	std::vector<std::pair<A, B>> MakePairs(std::mt19937& engine, double hitRatio, Generate generate, Test test) {
+		size_t hitTarget = static_cast<size_t>(std::lround(hitRatio * static_cast<double>(kPoolSize)));
+		std::vector<std::pair<A, B>> hits;
+		std::vector<std::pair<A, B>> misses;
+		std::vector<std::pair<A, B>> rest;
+		for (size_t attempt = 0; attempt < kPoolSize * 1000 && (hits.size() < hitTarget || misses.size() < kPoolSize - hitTarget); ++attempt) {
+			std::pair<A, B> pair = generate(engine);
+			std::vector<std::pair<A, B>>& bucket = test(pair.first, pair.second) ? hits : misses;
+			size_t target = &bucket == &hits ? hitTarget : kPoolSize - hitTarget;
+			if (bucket.size() < target) {
+				bucket.push_back(pair);
+			} else if (rest.size() < kPoolSize) {
+				rest.push_back(pair);
+			}
+		}
+		std::vector<std::pair<A, B>> pairs = hits;
+		pairs.insert(pairs.end(), misses.begin(), misses.end());
+		for (size_t i = 0; pairs.size() < kPoolSize; ++i) {
+			pairs.push_back(rest[i]);
+		}
+		std::shuffle(pairs.begin(), pairs.end(), engine);
+		return pairs;
+	}
+
+	template<typename A, typename B>
+	std::function<std::pair<A, B>(std::mt19937&)> Independent(A(*generateA)(std::mt19937&), B(*generateB)(std::mt19937&)) {
+		return [=](std::mt19937& engine) { return std::pair<A, B>(generateA(engine), generateB(engine)); };
+	}
+
+	template<typename A, typename B, typename Test>
+	Benchmark CollisionBenchmark(const std::string& name, std::vector<std::pair<A, B>> pairs, Test test) {
+		return { "Collision/" + name, [pairs = std::move(pairs), test](BenchmarkState& state) {
+			size_t hits = 0;
+			for (size_t i : state) {
+				const std::pair<A, B>& pair = pairs[i & kPoolMask];
+				hits += test(pair.first, pair.second) ? 1 : 0;
+			}
+			gHitSink = hits;
+			state.SetHits(hits);
+		} };
+	}
+
+	// 回転・拡縮・平行移動を持つランダムなアフィン行列
+	Matrix4x4 RandomAffine(std::mt19937& engine) {
+		Vector3 scale = { RandomFloat(engine, 0.5f, 2.0f), RandomFloat(engine, 0.5f, 2.0f), RandomFloat(engine, 0.5f, 2.0f) };
+		return MakeAffineMatrix(scale, RandomVector(engine, 3.14f), RandomVector(engine, 10.0f));
+	}
+
+	// 一般的な(射影成分を含む)ランダム行列
+	Matrix4x4 RandomGeneral(std::mt19937& engine) {
+		Matrix4x4 result;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				result.m[i][j] = RandomFloat(engine, -1.0f, 1.0f) + (i == j ? 2.0f : 0.0f);
+			}
+		}
+		return result;
+	}
+
+	// 入力を順番に使って結果の1要素を gSink に書き出す (最適化で消されないように)
+	template<typename T, typename Function>
+	Benchmark UnaryBenchmark(const std::string& name, std::vector<T> inputs, Function function) {
+		return { name, [inputs = std::move(inputs), function](BenchmarkState& state) {
+			float sink = 0.0f;
+			for (size_t i : state) {
+				sink += function(inputs[i & kPoolMask]);
+			}
+			gSink = sink;
+		} };
+	}
+
+	template<typename T>
+	std::vector<T> MakePool(std::mt19937& engine, T(*generate)(std::mt19937&)) {
+		std::vector<T> pool(kPoolSize);
+		for (T& value : pool) {
+			value = generate(engine);
+		}
+		return pool;
+	}
+
+	//--------------------------------------------------------------------------------
+	// ベンチマークの登録
+	//--------------------------------------------------------------------------------
+
+	void AddCollisionBenchmarks(std::vector<Benchmark>& benchmarks, std::mt19937& engine, double hitRatio) {
+		auto collide = [](const auto& a, const auto& b) { return Collision::isCollision(a, b); };
+
+		benchmarks.push_back(CollisionBenchmark("Sphere_Sphere", MakePairs<Sphere, Sphere>(engine, hitRatio, Independent(RandomSphere, RandomSphere), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("Sphere_Sphere<Fast>", MakePairs<Sphere, Sphere>(engine, hitRatio, Independent(RandomSphere, RandomSphere), collide),
+			[](const Sphere& a, const Sphere& b) { return Collision::isCollision<FastMath::Fast>(a, b); }));
+		benchmarks.push_back(CollisionBenchmark("Sphere_Plane", MakePairs<Sphere, Plane>(engine, hitRatio, Independent(RandomSphere, RandomPlane), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("Segment_Plane", MakePairs<Segment, Plane>(engine, hitRatio, Independent(RandomLinear<Segment>, RandomPlane), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("Ray_Plane", MakePairs<Ray, Plane>(engine, hitRatio, Independent(RandomLinear<Ray>, RandomPlane), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("Line_Plane", MakePairs<Line, Plane>(engine, hitRatio, RandomLinePlane, collide), collide));
+		benchmarks.push_back(CollisionBenchmark("Triangle_Segment", MakePairs<Triangle, Segment>(engine, hitRatio, Independent(RandomTriangle, RandomLinear<Segment>), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("Triangle_Ray", MakePairs<Triangle, Ray>(engine, hitRatio, Independent(RandomTriangle, RandomLinear<Ray>), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("Triangle_Line", MakePairs<Triangle, Line>(engine, hitRatio, Independent(RandomTriangle, RandomLinear<Line>), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("AABB_AABB", MakePairs<AABB, AABB>(engine, hitRatio, Independent(RandomAABB, RandomAABB), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("AABB_Sphere", MakePairs<AABB, Sphere>(engine, hitRatio, Independent(RandomAABB, RandomSphere), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("AABB_Segment", MakePairs<AABB, Segment>(engine, hitRatio, Independent(RandomAABB, RandomLinear<Segment>), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("AABB_Ray", MakePairs<AABB, Ray>(engine, hitRatio, Independent(RandomAABB, RandomLinear<Ray>), collide), collide));
+		benchmarks.push_back(CollisionBenchmark("AABB_Line", MakePairs<AABB, Line>(engine, hitRatio, Independent(RandomAABB, RandomLinear<Line>), collide), collide));
+
+		auto capsule = [](const Capsule& a, const Plane& b) { return Collision::IsCollision(a, b); };
+		benchmarks.push_back(CollisionBenchmark("Capsule_Plane", MakePairs<Capsule, Plane>(engine, hitRatio, Independent(RandomCapsule, RandomPlane), capsule), capsule));
+	}
+
+	void AddMatrixBenchmarks(std::vector<Benchmark>& benchmarks, std::mt19937& engine) {
+		std::vector<Matrix4x4> affine = MakePool(engine, RandomAffine);
+		std::vector<Matrix4x4> general = MakePool(engine, RandomGeneral);
+		std::vector<Vector3> vectors = MakePool<Vector3>(engine, [](std::mt19937& e) { return RandomVector(e, 10.0f); });
+		std::vector<Vector3> scales = MakePool<Vector3>(engine, [](std::mt19937& e) { return RandomVector(e, 2.0f); });
+		std::vector<Vector3> angles = MakePool<Vector3>(engine, [](std::mt19937& e) { return RandomVector(e, 3.14f); });
+		std::vector<float> radians(angles.size());
+		std::vector<std::pair<Matrix4x4, Matrix4x4>> products(kPoolSize);
+		std::vector<std::pair<Vector3, Matrix4x4>> transforms(kPoolSize);
+		std::vector<std::pair<Vector3, std::pair<Vector3, Vector3>>> srt(kPoolSize);
+		for (size_t i = 0; i < kPoolSize; ++i) {
+			radians[i] = angles[i].x;
+			products[i] = { affine[i], general[(i * 7) & kPoolMask] };
+			transforms[i] = { vectors[i], general[i] };
+			srt[i] = { scales[i], { angles[i], vectors[i] } };
+		}
+
+		benchmarks.push_back(UnaryBenchmark("Matrix/Multiply", products, [](const auto& p) { return (p.first * p.second).m[3][3]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/Inverse", general, [](const Matrix4x4& m) { return m.Inverse().m[3][3]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/InverseAffine", affine, [](const Matrix4x4& m) { return m.InverseAffine().m[3][0]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/Transpose", general, [](const Matrix4x4& m) { return m.Transpose().m[3][0]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeTranslateMatrix", vectors, [](const Vector3& v) { return MakeTranslateMatrix(v).m[3][0]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeScaleMatrix", scales, [](const Vector3& v) { return MakeScaleMatrix(v).m[0][0]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeRotateXMatrix", radians, [](float r) { return MakeRotateXMatrix(r).m[1][2]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeRotateYMatrix", radians, [](float r) { return MakeRotateYMatrix(r).m[2][0]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeRotateZMatrix", radians, [](float r) { return MakeRotateZMatrix(r).m[0][1]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeAffineMatrix", srt, [](const auto& p) { return MakeAffineMatrix(p.first, p.second.first, p.second.second).m[2][1]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakePerspectiveFovMatrix", radians,
+			[](float r) { return MakePerspectiveFovMatrix(0.3f + std::fabs(r) * 0.25f, 16.0f / 9.0f, 0.1f, 100.0f).m[1][1]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeOrthographicMatrix", radians,
+			[](float r) { return MakeOrthographicMatrix(-r, 1.0f, 4.0f, -1.0f, 0.1f, 100.0f).m[0][0]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/MakeViewportMatrix", radians,
+			[](float r) { return MakeViewportMatrix(r, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f).m[3][0]; }));
+		benchmarks.push_back(UnaryBenchmark("Matrix/Transform", transforms, [](const auto& p) { return Transform(p.first, p.second).x; }));
+
+		// 1回 = kPoolSize 頂点をまとめて変換する
+		Matrix4x4 matrix = general[0];
+		benchmarks.push_back({ "Matrix/TransformPoints/1024", [vectors, matrix](BenchmarkState& state) {
+			std::vector<Vector3> points(kPoolSize);
+			for (size_t i : state) {
+				TransformPoints(vectors.data(), points.data(), kPoolSize, matrix);
+				gSink = points[i & kPoolMask].x;
+			}
+		} });
+
+		// 毎回カメラを動かす場合 (Camera/Update) と動かさない場合 (Camera/Cached) を、毎回全部作り直す場合 (Camera/Rebuild) と比べる
+		benchmarks.push_back(UnaryBenchmark("Camera/Rebuild", srt, [](const auto& p) {
+			Matrix4x4 viewMatrix = MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, p.second.first, p.second.second).Inverse();
+			Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f, 1280.0f / 720.0f, 0.1f, 100.0f);
+			return (viewMatrix * projectionMatrix * MakeViewportMatrix(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f)).m[3][0];
+			}));
+		benchmarks.push_back({ "Camera/Update", [srt](BenchmarkState& state) {
+			Camera camera;
+			for (size_t i : state) {
+				const auto& p = srt[i & kPoolMask];
+				camera.SetRotate(p.second.first);
+				camera.SetTranslate(p.second.second);
+				gSink = camera.GetViewProjectionViewportMatrix().m[3][0];
+			}
+		} });
+		benchmarks.push_back({ "Camera/Cached", [srt](BenchmarkState& state) {
+			Camera camera;
+			camera.SetRotate(srt[0].second.first);
+			camera.SetTranslate(srt[0].second.second);
+			for (size_t i : state) {
+				gSink = camera.GetViewProjectionViewportMatrix().m[i & 3][0];
+			}
+		} });
+	}
+
+	void AddCurveBenchmarks(std::vector<Benchmark>& benchmarks, std::mt19937& engine) {
+		std::vector<CubicBezier> beziers = MakePool(engine, RandomCubicBezier);
+		std::vector<float> parameters = MakePool<float>(engine, [](std::mt19937& e) { return RandomFloat(e, 0.0f, 1.0f); });
+		std::vector<Curve> curves = MakePool(engine, RandomCurve);
+		std::vector<std::pair<CubicBezier, float>> samples(kPoolSize);
+		for (size_t i = 0; i < kPoolSize; ++i) {
+			samples[i] = { beziers[i], parameters[i] };
+		}
+
+		benchmarks.push_back(UnaryBenchmark("Curve/Evaluate", samples, [](const auto& p) { return Evaluate(p.first, p.second).x; }));
+		benchmarks.push_back(UnaryBenchmark("Curve/EvaluateBezier", samples, [](const auto& p) { return EvaluateBezier(p.first.points, 4, p.second).x; }));
+		benchmarks.push_back(UnaryBenchmark("Curve/SampleUniform/100", beziers, [](const CubicBezier& b) {
+			Vector3 points[101];
+			SampleUniform(b, 100, points);
+			return points[50].x;
+			}));
+
+		// 1回 = kPoolSize 本をまとめて求める
+		CubicBezierBatch batch;
+		for (const CubicBezier& bezier : beziers) {
+			batch.Add(bezier);
+		}
+		benchmarks.push_back({ "Curve/CubicBezierBatch/1024", [batch, parameters](BenchmarkState& state) {
+			std::vector<Vector3> positions(kPoolSize);
+			std::vector<Vector3> tangents(kPoolSize);
+			for (size_t i : state) {
+				batch.Evaluate(parameters.data(), positions.data(), tangents.data());
+				gSink = positions[i & kPoolMask].x;
+			}
+		} });
+
+		// main.cpp と同じカメラのスクリーン座標で 0.5 ピクセル
+		Matrix4x4 cameraMatrix = MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, { 0.26f, 0.0f, 0.0f }, { 0.0f, 2.0f, -6.5f });
+		Matrix4x4 screen = cameraMatrix.Inverse() * MakePerspectiveFovMatrix(0.45f, 1280.0f / 720.0f, 0.1f, 100.0f) *
+			MakeViewportMatrix(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f);
+		benchmarks.push_back(UnaryBenchmark("Curve/Flatten", curves, [screen](const Curve& c) {
+			thread_local std::vector<Vector3> points;
+			c.Flatten(screen, 0.5f, points);
+			return points.back().x;
+			}));
+
+		ArcLengthTable table(curves[0]);
+		std::vector<float> distances(parameters);
+		for (float& distance : distances) {
+			distance *= table.Length();
+		}
+		benchmarks.push_back(UnaryBenchmark("Curve/ArcLengthTable/ParameterAt", distances, [table](float d) { return table.ParameterAt(d); }));
+	}
+
+	void AddTransformBenchmarks(std::vector<Benchmark>& benchmarks, std::mt19937& engine) {
+		std::vector<Quaternion> rotates = MakePool(engine, RandomQuaternion);
+		std::vector<Vector3> vectors = MakePool<Vector3>(engine, [](std::mt19937& e) { return RandomVector(e, 10.0f); });
+		std::vector<Vector3> angles = MakePool<Vector3>(engine, [](std::mt19937& e) { return RandomVector(e, 3.14f); });
+		std::vector<float> parameters = MakePool<float>(engine, [](std::mt19937& e) { return RandomFloat(e, 0.0f, 1.0f); });
+		std::vector<std::pair<Quaternion, Vector3>> rotateVectors(kPoolSize);
+		std::vector<std::pair<std::pair<Quaternion, Quaternion>, float>> slerps(kPoolSize);
+		for (size_t i = 0; i < kPoolSize; ++i) {
+			rotateVectors[i] = { rotates[i], vectors[i] };
+			slerps[i] = { { rotates[i], rotates[(i * 7) & kPoolMask] }, parameters[i] };
+		}
+
+		// Matrix/MakeAffineMatrix (オイラー角) と比べる
+		benchmarks.push_back(UnaryBenchmark("Quaternion/MakeAffineMatrix", rotateVectors,
+			[](const auto& p) { return MakeAffineMatrixFromQuaternion({ 1.0f, 1.0f, 1.0f }, p.first, p.second).m[2][1]; }));
+		benchmarks.push_back(UnaryBenchmark("Quaternion/MakeRotateXYZQuaternion", angles, [](const Vector3& v) { return MakeRotateXYZQuaternion(v).w; }));
+		benchmarks.push_back(UnaryBenchmark("Quaternion/Multiply", slerps, [](const auto& p) { return (p.first.first * p.first.second).w; }));
+		benchmarks.push_back(UnaryBenchmark("Quaternion/RotateVector", rotateVectors, [](const auto& p) { return RotateVector(p.second, p.first).x; }));
+		benchmarks.push_back(UnaryBenchmark("Quaternion/Slerp", slerps, [](const auto& p) { return Slerp(p.first.first, p.first.second, p.second).w; }));
+
+		// 4096 ノードの階層で、1回の Update の前に何も変えない (Idle)・1% を変える・全部を変える場合
+		const size_t kNodeCount = 4096;
+		TransformHierarchy hierarchy;
+		hierarchy.Reserve(kNodeCount);
+		for (size_t i = 0; i < kNodeCount; ++i) {
+			uint32_t parent = i == 0 ? TransformHierarchy::kNoParent : static_cast<uint32_t>(engine() % i);
+			hierarchy.Add(parent, { 1.0f, 1.0f, 1.0f }, rotates[i & kPoolMask], vectors[i & kPoolMask]);
+		}
+		hierarchy.Update();
+		std::vector<uint32_t> nodes(kPoolSize);
+		for (uint32_t& node : nodes) {
+			node = static_cast<uint32_t>(engine() % kNodeCount);
+		}
+		for (size_t dirtyCount : { size_t(0), kNodeCount / 100, kNodeCount }) {
+			std::string name = dirtyCount == 0 ? "Idle" : dirtyCount == kNodeCount ? "All" : "1%";
+			benchmarks.push_back({ "TransformHierarchy/Update/4096/" + name, [hierarchy, nodes, rotates, dirtyCount](BenchmarkState& state) mutable {
+				size_t updated = 0;
+				for (size_t i : state) {
+					for (size_t k = 0; k < dirtyCount; ++k) {
+						uint32_t node = dirtyCount == kNodeCount ? static_cast<uint32_t>(k) : nodes[(i * dirtyCount + k) & kPoolMask];
+						hierarchy.SetRotate(node, rotates[(i + k) & kPoolMask]);
+					}
+					updated += hierarchy.Update();
+				}
+				gHitSink = updated;
+			} });
+		}
+	}
+
+	void AddDrawBenchmarks(std::vector<Benchmark>& benchmarks, std::mt19937& engine) {
+		// main.cpp と同じカメラ
+		const float kWidth = 1280.0f;
+		const float kHeight = 720.0f;
+		Matrix4x4 cameraMatrix = MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, { 0.26f, 0.0f, 0.0f }, { 0.0f, 2.0f, -6.5f });
+		Matrix4x4 viewProjection = cameraMatrix.Inverse() * MakePerspectiveFovMatrix(0.45f, kWidth / kHeight, 0.1f, 100.0f);
+		Matrix4x4 viewport = MakeViewportMatrix(0.0f, 0.0f, kWidth, kHeight, 0.0f, 1.0f);
+
+		// 描画した線分はバッチに溜め、kFlushInterval 回ごとに何もしない描画先へ流す
+		//  lod なら既定の LodSettings で分割数を選ぶ
+		auto drawBenchmark = [&](const std::string& name, auto inputs, auto draw, bool lod = false) {
+			return Benchmark{ "Draw/" + name, [inputs = std::move(inputs), draw, lod, viewProjection, viewport, kWidth, kHeight](BenchmarkState& state) {
+				LineBatch batch;
+				NullLineSink sink;
+				batch.SetCullRect(0, 0, static_cast<int>(kWidth), static_cast<int>(kHeight));
+				Draw::SetLineBatch(&batch);
+				if (lod) {
+					Draw::SetLodSettings(LodSettings());
+				}
+				for (size_t i : state) {
+					draw(inputs[i & kPoolMask], viewProjection, viewport);
+					if (i % kFlushInterval == kFlushInterval - 1) {
+						batch.Flush(sink);
+					}
+				}
+				batch.Flush(sink);
+				Draw::DisableLod();
+				Draw::SetLineBatch(nullptr);
+			} };
+		};
+
+		std::vector<int> none(kPoolSize);
+		std::vector<Sphere> spheres = MakePool(engine, RandomSphere);
+		std::vector<Plane> planes = MakePool(engine, RandomPlane);
+		std::vector<Segment> segments = MakePool(engine, RandomLinear<Segment>);
+		std::vector<Triangle> triangles = MakePool(engine, RandomTriangle);
+		std::vector<AABB> boxes = MakePool(engine, RandomAABB);
+		std::vector<Triangle> beziers = MakePool(engine, RandomTriangle);
+		std::vector<Sphere> smallSpheres = MakePool(engine, RandomSmallSphere);
+		std::vector<Curve> curves = MakePool(engine, RandomCurve);
+
+		benchmarks.push_back(drawBenchmark("Grid", none,
+			[](int, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawGrid(vp, v); }));
+		benchmarks.push_back(drawBenchmark("Sphere", spheres,
+			[](const Sphere& s, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawSphere(s, vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("Sphere<Fast>", spheres,
+			[](const Sphere& s, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawSphere<FastMath::Fast>(s, vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("Sphere/Lod", spheres,
+			[](const Sphere& s, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawSphere(s, vp, v, 0xFFFFFFFF); }, true));
+		benchmarks.push_back(drawBenchmark("Sphere/Small", smallSpheres,
+			[](const Sphere& s, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawSphere(s, vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("Sphere/Small/Lod", smallSpheres,
+			[](const Sphere& s, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawSphere(s, vp, v, 0xFFFFFFFF); }, true));
+		benchmarks.push_back(drawBenchmark("Plane", planes,
+			[](const Plane& p, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawPlane(p, vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("Segment", segments,
+			[](const Segment& s, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawSegment(s, vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("Triangle", triangles,
+			[](const Triangle& t, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawTriangle(t, vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("AABB", boxes,
+			[](const AABB& b, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawAABB(b, vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("Bezier", beziers,
+			[](const Triangle& t, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawBezier(t.vertices[0], t.vertices[1], t.vertices[2], vp, v, 0xFFFFFFFF); }));
+		benchmarks.push_back(drawBenchmark("Bezier/Lod", beziers,
+			[](const Triangle& t, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawBezier(t.vertices[0], t.vertices[1], t.vertices[2], vp, v, 0xFFFFFFFF); }, true));
+		benchmarks.push_back(drawBenchmark("Curve", curves,
+			[](const Curve& c, const Matrix4x4& vp, const Matrix4x4& v) { Draw::DrawCurve(c, vp, v, 0xFFFFFFFF); }));
+	}
+
+	//--------------------------------------------------------------------------------
+	// スカラー版との照合
+	//--------------------------------------------------------------------------------
+
+	// 参照値の ULP を単位にした差
+	int64_t UlpDistance(float reference, float value) {
+		float magnitude = std::fabs(reference);
+		float ulp = std::nextafter(magnitude, INFINITY) - magnitude;
+		return static_cast<int64_t>(std::ceil(std::fabs(reference - value) / ulp));
+	}
+
+	// スカラーで求めた t (AABB は箱に入る位置、三角形は平面と交わる位置)
+	float ReferenceT(const AABB& aabb, const Ray& ray) {
+		float tMin = 0.0f;
+		for (int axis = 0; axis < 3; ++axis) {
+			float diff = (&ray.diff.x)[axis];
+			if (diff != 0.0f) {
+				float t1 = ((&aabb.min.x)[axis] - (&ray.origin.x)[axis]) / diff;
+				float t2 = ((&aabb.max.x)[axis] - (&ray.origin.x)[axis]) / diff;
+				tMin = std::max(tMin, std::min(t1, t2));
+			}
+		}
+		return tMin;
+	}
+
+	float ReferenceT(const Triangle& triangle, const Ray& ray) {
+		Vector3 normal = (triangle.vertices[1] - triangle.vertices[0]).Cross(triangle.vertices[2] - triangle.vertices[0]);
+		return (triangle.vertices[0] - ray.origin).Dot(normal) / ray.diff.Dot(normal);
+	}
+
+	float ReferenceT(const PreparedTriangle& triangle, const Ray& ray) {
+		return (triangle.distance - triangle.normal.Dot(ray.origin)) / triangle.normal.Dot(ray.diff);
+	}
+
+	struct PacketCheck {
+		size_t lanes = 0;
+		size_t hits = 0;
+		size_t mismatches = 0;
+		int64_t maxUlp = 0;
+	};
+
+	// activeMask のレーンだけ Set したパケットを判定し、レーンごとに Collision::isCollision と比べる
+	template<size_t N, typename Shape>
+	void CheckPacket(const Shape& shape, const Ray* rays, uint32_t activeMask, PacketCheck& check) {
+		RayPacket<N> packet;
+		for (size_t lane = 0; lane < N; ++lane) {
+			if (activeMask & (1u << lane)) {
+				packet.Set(lane, rays[lane]);
+			}
+		}
+		RayPacketHit<N> hit = Collision::Intersect(shape, packet);
+		for (size_t lane = 0; lane < N; ++lane) {
+			bool expected = (activeMask & (1u << lane)) != 0 && Collision::isCollision(shape, rays[lane]);
+			bool actual = (hit.mask & (1u << lane)) != 0;
+			++check.lanes;
+			if (expected != actual || (!actual && hit.t[lane] != INFINITY)) {
+				++check.mismatches;
+			} else if (actual) {
+				++check.hits;
+				check.maxUlp = std::max(check.maxUlp, UlpDistance(ReferenceT(shape, rays[lane]), hit.t[lane]));
+			}
+		}
+	}
+
+	// 形の中心付近を狙ったレイ (軸に平行なものと、後ろ向きで外れるものを混ぜる)
+	Ray RandomAimedRay(std::mt19937& engine, const Vector3& target) {
+		Vector3 origin = RandomVector(engine, 4.0f);
+		Vector3 diff = target + RandomVector(engine, 0.5f) - origin;
+		int choice = std::uniform_int_distribution<int>(0, 7)(engine);
+		if (choice < 3) {
+			(&diff.x)[choice] = 0.0f;
+		} else if (choice == 3) {
+			diff = -diff;
+		}
+		return { origin, diff };
+	}
+
+	void ReportPacketCheck(const char* name, const PacketCheck& check) {
+		std::printf("%-34s lanes %6zu  hits %6zu  max %lld ulp  %s\n", name, check.lanes, check.hits,
+			static_cast<long long>(check.maxUlp), check.mismatches == 0 ? "OK" : "MISMATCH");
+	}
+
+	// RayPacket4/8 の判定をスカラー版と照合する (食い違いがなければ true)
+	bool CheckRayPackets(std::mt19937& engine) {
+		const size_t kPacketCount = 4096;
+		PacketCheck checks[6];
+		for (size_t i = 0; i < kPacketCount; ++i) {
+			AABB aabb = RandomAABB(engine);
+			Triangle triangle = RandomTriangle(engine);
+			PreparedTriangle prepared = PrepareTriangle(triangle);
+			Vector3 aabbCenter = (aabb.min + aabb.max) * 0.5f;
+			Vector3 triangleCenter = (triangle.vertices[0] + triangle.vertices[1] + triangle.vertices[2]) * (1.0f / 3.0f);
+			Ray aabbRays[8];
+			Ray triangleRays[8];
+			for (size_t lane = 0; lane < 8; ++lane) {
+				aabbRays[lane] = RandomAimedRay(engine, aabbCenter);
+				triangleRays[lane] = RandomAimedRay(engine, triangleCenter);
+			}
+			// 1/4 のパケットは一部のレーンを無効にする
+			uint32_t activeMask = std::uniform_int_distribution<uint32_t>(0, 3)(engine) == 0 ? std::uniform_int_distribution<uint32_t>(0, 0xff)(engine) : 0xffu;
+			CheckPacket<4>(aabb, aabbRays, activeMask & 0xfu, checks[0]);
+			CheckPacket<8>(aabb, aabbRays, activeMask, checks[1]);
+			CheckPacket<4>(triangle, triangleRays, activeMask & 0xfu, checks[2]);
+			CheckPacket<8>(triangle, triangleRays, activeMask, checks[3]);
+			CheckPacket<4>(prepared, triangleRays, activeMask & 0xfu, checks[4]);
+			CheckPacket<8>(prepared, triangleRays, activeMask, checks[5]);
+		}
+		ReportPacketCheck("RayPacket4/AABB", checks[0]);
+		ReportPacketCheck("RayPacket8/AABB", checks[1]);
+		ReportPacketCheck("RayPacket4/Triangle", checks[2]);
+		ReportPacketCheck("RayPacket8/Triangle", checks[3]);
+		ReportPacketCheck("RayPacket4/PreparedTriangle", checks[4]);
+		ReportPacketCheck("RayPacket8/PreparedTriangle", checks[5]);
+		bool matches = true;
+		for (const PacketCheck& check : checks) {
+			matches = matches && check.mismatches == 0;
+		}
+		return matches;
+	}
+
+	struct BVHCheck {
+		size_t queries = 0;
+		size_t hits = 0;
+		size_t mismatches = 0;
+	};
+
+	// 総当たりで最も近い交点の t を求める (Line は |t| が最小のもの)
+	template<typename T>
+	bool BruteClosest(const std::vector<Triangle>& triangles, const T& query, float& closest) {
+		bool found = false;
+		for (const Triangle& triangle : triangles) {
+			if (Collision::isCollision(triangle, query)) {
+				float t = ReferenceT(triangle, Ray{ query.origin, query.diff });
+				if (!found || std::fabs(t) < std::fabs(closest)) {
+					closest = t;
+				}
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	// AnyHit / ClosestHit を総当たりの Collision::isCollision と比べる
+	//  t は計算の式が違うので相対誤差で比べ、重心座標から戻した点が交点と一致するかも調べる
+	template<typename T>
+	void CheckBVHQuery(const TriangleBVH& bvh, const std::vector<Triangle>& triangles, const T& query, BVHCheck& check) {
+		const float kTolerance = 1e-3f;
+		++check.queries;
+		float closest = 0.0f;
+		bool expected = BruteClosest(triangles, query, closest);
+		TriangleHit hit;
+		bool closestFound = bvh.ClosestHit(query, hit);
+		if (bvh.AnyHit(query) != expected || closestFound != expected) {
+			++check.mismatches;
+			return;
+		}
+		if (!expected) {
+			return;
+		}
+		++check.hits;
+		const Triangle& triangle = triangles[hit.triangleIndex];
+		Vector3 point = query.origin + query.diff * hit.t;
+		Vector3 barycentric = triangle.vertices[0] + (triangle.vertices[1] - triangle.vertices[0]) * hit.u + (triangle.vertices[2] - triangle.vertices[0]) * hit.v;
+		float scale = std::max(1.0f, std::fabs(closest));
+		if (std::fabs(hit.t - closest) > kTolerance * scale || (point - barycentric).Length() > kTolerance * std::max(1.0f, point.Length())) {
+			++check.mismatches;
+		}
+	}
+
+	void ReportBVHCheck(const char* name, const BVHCheck& check) {
+		std::printf("%-34s queries %6zu  hits %6zu  %s\n", name, check.queries, check.hits, check.mismatches == 0 ? "OK" : "MISMATCH");
+	}
+
+	// ばらばらの三角形から作った TriangleBVH を総当たりと照合する (食い違いがなければ true)
+	bool CheckTriangleBVH(std::mt19937& engine) {
+		const size_t kTriangleCount = 2000;
+		const size_t kQueryCount = 2000;
+		std::vector<Triangle> triangles(kTriangleCount);
+		for (Triangle& triangle : triangles) {
+			Vector3 center = RandomVector(engine, 2.0f);
+			triangle = { { center + RandomVector(engine, 0.3f), center + RandomVector(engine, 0.3f), center + RandomVector(engine, 0.3f) } };
+		}
+		TriangleBVH bvh;
+		bvh.Build(triangles);
+
+		BVHCheck checks[3];
+		for (size_t i = 0; i < kQueryCount; ++i) {
+			Ray ray = RandomAimedRay(engine, RandomVector(engine, 2.0f));
+			CheckBVHQuery(bvh, triangles, ray, checks[0]);
+			CheckBVHQuery(bvh, triangles, Segment{ ray.origin, ray.diff }, checks[1]);
+			CheckBVHQuery(bvh, triangles, Line{ ray.origin, ray.diff }, checks[2]);
+		}
+		ReportBVHCheck("TriangleBVH/Ray", checks[0]);
+		ReportBVHCheck("TriangleBVH/Segment", checks[1]);
+		ReportBVHCheck("TriangleBVH/Line", checks[2]);
+		return checks[0].mismatches == 0 && checks[1].mismatches == 0 && checks[2].mismatches == 0;
+	}
+
+	//--------------------------------------------------------------------------------
+	// 出力
+	//--------------------------------------------------------------------------------
+
+	const char* KernelName() {
+#if defined(MT3_SIMD_AVX)
+		return "AVX";
+#elif defined(MT3_SIMD_SSE)
+		return "SSE";
+#elif defined(MT3_SIMD_NEON)
+		return "NEON";
+#else
+		return "scalar";
+#endif
+	}
+
+	bool WriteJson(const std::string& path, const Options& options, const std::vector<BenchmarkResult>& results) {
+		FILE* file = std::fopen(path.c_str(), "w");
+		if (file == nullptr) {
+			return false;
+		}
+		std::fprintf(file, "{\n  \"context\": {\n");
+		std::fprintf(file, "    \"executable\": \"MathBenchmark\",\n");
+		std::fprintf(file, "    \"kernel\": \"%s\",\n", KernelName());
+		std::fprintf(file, "    \"seed\": %u,\n", options.seed);
+		std::fprintf(file, "    \"hit_ratio\": %.3f,\n", options.hitRatio);
+		std::fprintf(file, "    \"min_time\": %.3f,\n", options.minTime);
+		std::fprintf(file, "    \"repetitions\": %d\n", options.repetitions);
+		std::fprintf(file, "  },\n  \"benchmarks\": [\n");
+		for (size_t i = 0; i < results.size(); ++i) {
+			const BenchmarkResult& result = results[i];
+			// 比較で読み戻すため、1件を1行に書く
+			std::fprintf(file, "    {\"name\": \"%s\", \"iterations\": %zu, \"real_time\": %.4f, \"time_unit\": \"ns\"",
+				result.name.c_str(), result.iterations, result.nanoseconds);
+			if (result.hitRatio >= 0.0) {
+				std::fprintf(file, ", \"hit_ratio\": %.4f", result.hitRatio);
+			}
+			std::fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "  ]\n}\n");
+		std::fclose(file);
+		return true;
+	}
+
+	// WriteJson で書いた JSON から name と real_time を読む
+	bool ReadJson(const std::string& path, std::map<std::string, double>& times) {
+		FILE* file = std::fopen(path.c_str(), "r");
+		if (file == nullptr) {
+			return false;
+		}
+		char line[512];
+		while (std::fgets(line, sizeof(line), file) != nullptr) {
+			const char* name = std::strstr(line, "\"name\": \"");
+			const char* time = std::strstr(line, "\"real_time\": ");
+			if (name == nullptr || time == nullptr) {
+				continue;
+			}
+			name += std::strlen("\"name\": \"");
+			const char* nameEnd = std::strchr(name, '"');
+			if (nameEnd != nullptr) {
+				times[std::string(name, nameEnd)] = std::strtod(time + std::strlen("\"real_time\": "), nullptr);
+			}
+		}
+		std::fclose(file);
+		return true;
+	}
+
+	bool ParseOption(const char* argument, const char* name, std::string& value) {
+		size_t length = std::strlen(name);
+		if (std::strncmp(argument, name, length) != 0 || argument[length] != '=') {
+			return false;
+		}
+		value = argument + length + 1;
+		return true;
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; ++i) {
+			std::string value;
+			if (ParseOption(argv[i], "--filter", options.filter) || ParseOption(argv[i], "--json", options.jsonPath) ||
+				ParseOption(argv[i], "--baseline", options.baselinePath)) {
+				continue;
+			}
+			if (ParseOption(argv[i], "--hit-ratio", value)) {
+				options.hitRatio = std::clamp(std::atof(value.c_str()), 0.0, 1.0);
+			} else if (ParseOption(argv[i], "--seed", value)) {
+				options.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+			} else if (ParseOption(argv[i], "--min-time", value)) {
+				options.minTime = std::atof(value.c_str());
+			} else if (ParseOption(argv[i], "--repetitions", value)) {
+				options.repetitions = std::max(1, std::atoi(value.c_str()));
+			} else if (ParseOption(argv[i], "--threshold", value)) {
+				options.threshold = std::atof(value.c_str());
+			} else {
+				std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		std::fprintf(stderr, "usage: %s [--filter=<name>] [--hit-ratio=0.5] [--seed=12345] [--min-time=0.1] [--repetitions=3] "
+			"[--json=<file>] [--baseline=<file>] [--threshold=0.1]\n", argv[0]);
+		return 2;
+	}
+
+	std::map<std::string, double> baseline;
+	if (!options.baselinePath.empty() && !ReadJson(options.baselinePath, baseline)) {
+		std::fprintf(stderr, "cannot read %s\n", options.baselinePath.c_str());
+		return 2;
+	}
+
+	// 入力はグループごとに別のエンジンで作り、--filter で一部だけ走らせても同じ入力になるようにする
+	std::vector<Benchmark> benchmarks;
+	std::mt19937 collisionEngine(options.seed);
+	std::mt19937 matrixEngine(options.seed + 1);
+	std::mt19937 drawEngine(options.seed + 2);
+	std::mt19937 curveEngine(options.seed + 3);
+	std::mt19937 transformEngine(options.seed + 4);
+	std::mt19937 packetEngine(options.seed + 5);
+	std::mt19937 bvhEngine(options.seed + 6);
+	AddCollisionBenchmarks(benchmarks, collisionEngine, options.hitRatio);
+	AddMatrixBenchmarks(benchmarks, matrixEngine);
+	AddDrawBenchmarks(benchmarks, drawEngine);
+	AddCurveBenchmarks(benchmarks, curveEngine);
+	AddTransformBenchmarks(benchmarks, transformEngine);
+
+	std::printf("kernel: %s  seed: %u  hit ratio: %.2f\n", KernelName(), options.seed, options.hitRatio);
+	std::printf("%-34s %12s %14s %8s%s\n", "benchmark", "ns/op", "iterations", "hit", baseline.empty() ? "" : "   change");
+
+	std::vector<BenchmarkResult> results;
+	size_t regressions = 0;
+	for (const Benchmark& benchmark : benchmarks) {
+		if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+			continue;
+		}
+		BenchmarkResult result = Run(benchmark, options);
+		results.push_back(result);
+
+		char hit[16] = "-";
+		if (result.hitRatio >= 0.0) {
+			std::snprintf(hit, sizeof(hit), "%.2f", result.hitRatio);
+		}
+		std::printf("%-34s %12.2f %14zu %8s", result.name.c_str(), result.nanoseconds, result.iterations, hit);
+		auto found = baseline.find(result.name);
+		if (found != baseline.end() && found->second > 0.0) {
+			double change = result.nanoseconds / found->second - 1.0;
+			bool regressed = change > options.threshold;
+			regressions += regressed ? 1 : 0;
+			std::printf("   %+6.1f%%%s", change * 100.0, regressed ? "  REGRESSION" : "");
+		}
+		std::printf("\n");
+	}
+
+	if (!options.jsonPath.empty() && !WriteJson(options.jsonPath, options, results)) {
+		std::fprintf(stderr, "cannot write %s\n", options.jsonPath.c_str());
+		return 2;
+	}
+
+	std::printf("\n");
+	bool packetsMatch = CheckRayPackets(packetEngine);
+	bool bvhMatches = CheckTriangleBVH(bvhEngine);
+
+	if (regressions > 0) {
+		std::printf("%zu benchmark(s) slower than the baseline by more than %.0f%%\n", regressions, options.threshold * 100.0);
+		return 1;
+	}
+	return packetsMatch && bvhMatches ? 0 : 1;
+}
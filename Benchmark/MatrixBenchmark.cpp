@@ -0,0 +1,272 @@
+// Matrix4x4 の乗算・逆行列・転置を旧実装(3重ループ)と比較するマイクロベンチマーク
+//  速度(ns/op)と、旧実装との最大ULP差を出力する
+#include "../Math/Matrix4x4.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace Legacy {
+	Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2) {
+		Matrix4x4 result;
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				result.m[i][j] = 0;
+				for (int k = 0; k < 4; k++) {
+					result.m[i][j] += m1.m[i][k] * m2.m[k][j];
+				}
+			}
+		}
+		return result;
+	}
+
+	Matrix4x4 Inverse(const Matrix4x4& mat) {
+		Matrix4x4 result;
+		float det = 0;
+
+		for (int i = 0; i < 4; ++i) {
+			float subMat[3][3];
+			for (int sub_i = 1; sub_i < 4; ++sub_i) {
+				int sub_j = 0;
+				for (int sub_k = 0; sub_k < 4; ++sub_k) {
+					if (sub_k == i) continue;
+					subMat[sub_i - 1][sub_j] = mat.m[sub_i][sub_k];
+					++sub_j;
+				}
+			}
+			float subDet =
+				subMat[0][0] * (subMat[1][1] * subMat[2][2] - subMat[1][2] * subMat[2][1])
+				- subMat[0][1] * (subMat[1][0] * subMat[2][2] - subMat[1][2] * subMat[2][0])
+				+ subMat[0][2] * (subMat[1][0] * subMat[2][1] - subMat[1][1] * subMat[2][0]);
+			det += (i % 2 == 0 ? 1 : -1) * mat.m[0][i] * subDet;
+		}
+
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				float subMat[3][3];
+				for (int sub_i = 0, row = 0; sub_i < 4; ++sub_i) {
+					if (sub_i == i) continue;
+					for (int sub_j = 0, col = 0; sub_j < 4; ++sub_j) {
+						if (sub_j == j) continue;
+						subMat[row][col] = mat.m[sub_i][sub_j];
+						++col;
+					}
+					++row;
+				}
+				float subDet =
+					subMat[0][0] * (subMat[1][1] * subMat[2][2] - subMat[1][2] * subMat[2][1])
+					- subMat[0][1] * (subMat[1][0] * subMat[2][2] - subMat[1][2] * subMat[2][0])
+					+ subMat[0][2] * (subMat[1][0] * subMat[2][1] - subMat[1][1] * subMat[2][0]);
+				result.m[j][i] = ((i + j) % 2 == 0 ? 1 : -1) * subDet / det;
+			}
+		}
+		return result;
+	}
+
+	Matrix4x4 Transpose(const Matrix4x4& mat) {
+		Matrix4x4 result;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				result.m[i][j] = mat.m[j][i];
+			}
+		}
+		return result;
+	}
+}
+
+namespace {
+	const int kMatrixCount = 1024;
+	const int kRepeat = 2000;
+
+	// 回転・拡縮・平行移動を持つランダムなアフィン行列
+	Matrix4x4 MakeRandomAffine(std::mt19937& engine) {
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+		std::uniform_real_distribution<float> translate(-10.0f, 10.0f);
+		float x = angle(engine), y = angle(engine), z = angle(engine);
+		Matrix4x4 rx = { 1.0f,0.0f,0.0f,0.0f, 0.0f,std::cos(x),std::sin(x),0.0f, 0.0f,-std::sin(x),std::cos(x),0.0f, 0.0f,0.0f,0.0f,1.0f };
+		Matrix4x4 ry = { std::cos(y),0.0f,-std::sin(y),0.0f, 0.0f,1.0f,0.0f,0.0f, std::sin(y),0.0f,std::cos(y),0.0f, 0.0f,0.0f,0.0f,1.0f };
+		Matrix4x4 rz = { std::cos(z),std::sin(z),0.0f,0.0f, -std::sin(z),std::cos(z),0.0f,0.0f, 0.0f,0.0f,1.0f,0.0f, 0.0f,0.0f,0.0f,1.0f };
+		Matrix4x4 r = Legacy::Multiply(Legacy::Multiply(rx, ry), rz);
+		float s[3] = { scale(engine), scale(engine), scale(engine) };
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				r.m[i][j] *= s[i];
+			}
+		}
+		r.m[3][0] = translate(engine);
+		r.m[3][1] = translate(engine);
+		r.m[3][2] = translate(engine);
+		return r;
+	}
+
+	// 一般的な(射影成分を含む)ランダム行列
+	Matrix4x4 MakeRandomGeneral(std::mt19937& engine) {
+		std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+		Matrix4x4 result;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				result.m[i][j] = value(engine) + (i == j ? 2.0f : 0.0f);
+			}
+		}
+		return result;
+	}
+
+	// 行の最大成分のULPを単位にした差(打ち消しで0付近になる成分を過大評価しないため)
+	int64_t MaxUlp(const Matrix4x4& a, const Matrix4x4& b) {
+		int64_t result = 0;
+		for (int i = 0; i < 4; ++i) {
+			float rowMax = 0.0f;
+			for (int j = 0; j < 4; ++j) {
+				rowMax = std::fmax(rowMax, std::fabs(a.m[i][j]));
+			}
+			float ulp = std::nextafter(rowMax, INFINITY) - rowMax;
+			for (int j = 0; j < 4; ++j) {
+				int64_t d = static_cast<int64_t>(std::ceil(std::fabs(a.m[i][j] - b.m[i][j]) / ulp));
+				result = d > result ? d : result;
+			}
+		}
+		return result;
+	}
+
+	template<typename Func>
+	double Measure(Func func) {
+		auto start = std::chrono::steady_clock::now();
+		for (int repeat = 0; repeat < kRepeat; ++repeat) {
+			func();
+		}
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(kRepeat) * kMatrixCount);
+	}
+
+	volatile float gSink;
+
+	void Report(const char* name, double legacy, double current, int64_t ulp) {
+		std::printf("%-16s legacy %8.2f ns  current %8.2f ns  x%5.2f  max %lld ulp\n",
+			name, legacy, current, legacy / current, static_cast<long long>(ulp));
+	}
+}
+
+int main() {
+#if defined(MT3_SIMD_AVX)
+	std::printf("kernel: AVX\n");
+#elif defined(MT3_SIMD_SSE)
+	std::printf("kernel: SSE\n");
+#elif defined(MT3_SIMD_NEON)
+	std::printf("kernel: NEON\n");
+#else
+	std::printf("kernel: scalar\n");
+#endif
+
+	std::mt19937 engine(12345);
+	std::vector<Matrix4x4> affine(kMatrixCount);
+	std::vector<Matrix4x4> general(kMatrixCount);
+	std::vector<Matrix4x4> results(kMatrixCount);
+	for (int i = 0; i < kMatrixCount; ++i) {
+		affine[i] = MakeRandomAffine(engine);
+		general[i] = MakeRandomGeneral(engine);
+	}
+
+	// 乗算
+	{
+		double legacy = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = Legacy::Multiply(affine[i], general[i]);
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		double current = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = affine[i] * general[i];
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		int64_t ulp = 0;
+		for (int i = 0; i < kMatrixCount; ++i) {
+			int64_t d = MaxUlp(Legacy::Multiply(affine[i], general[i]), affine[i] * general[i]);
+			ulp = d > ulp ? d : ulp;
+		}
+		Report("Multiply", legacy, current, ulp);
+	}
+
+	// 転置
+	{
+		double legacy = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = Legacy::Transpose(general[i]);
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		double current = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = general[i].Transpose();
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		int64_t ulp = 0;
+		for (int i = 0; i < kMatrixCount; ++i) {
+			int64_t d = MaxUlp(Legacy::Transpose(general[i]), general[i].Transpose());
+			ulp = d > ulp ? d : ulp;
+		}
+		Report("Transpose", legacy, current, ulp);
+	}
+
+	// 逆行列(一般)
+	{
+		double legacy = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = Legacy::Inverse(general[i]);
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		double current = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = general[i].Inverse();
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		int64_t ulp = 0;
+		for (int i = 0; i < kMatrixCount; ++i) {
+			int64_t d = MaxUlp(Legacy::Inverse(general[i]), general[i].Inverse());
+			ulp = d > ulp ? d : ulp;
+		}
+		Report("Inverse", legacy, current, ulp);
+	}
+
+	// 逆行列(アフィン)
+	{
+		double legacy = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = Legacy::Inverse(affine[i]);
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		double current = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = affine[i].Inverse();
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		double affineOnly = Measure([&] {
+			for (int i = 0; i < kMatrixCount; ++i) {
+				results[i] = affine[i].InverseAffine();
+			}
+			gSink = results[kMatrixCount - 1].m[0][0];
+			});
+		int64_t ulp = 0;
+		int64_t affineUlp = 0;
+		for (int i = 0; i < kMatrixCount; ++i) {
+			Matrix4x4 reference = Legacy::Inverse(affine[i]);
+			int64_t d = MaxUlp(reference, affine[i].Inverse());
+			ulp = d > ulp ? d : ulp;
+			d = MaxUlp(reference, affine[i].InverseAffine());
+			affineUlp = d > affineUlp ? d : affineUlp;
+		}
+		Report("Inverse(affine)", legacy, current, ulp);
+		Report("InverseAffine", legacy, affineOnly, affineUlp);
+	}
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include "BallSystem.h"
+#include <cassert>
+
+size_t BallSystem::Add(const Ball& ball) {
+	positionX_.push_back(ball.position.x);
+	positionY_.push_back(ball.position.y);
+	positionZ_.push_back(ball.position.z);
+	velocityX_.push_back(ball.velocity.x);
+	velocityY_.push_back(ball.velocity.y);
+	velocityZ_.push_back(ball.velocity.z);
+	accelerationX_.push_back(ball.acceleration.x);
+	accelerationY_.push_back(ball.acceleration.y);
+	accelerationZ_.push_back(ball.acceleration.z);
+	mass_.push_back(ball.mass);
+	radius_.push_back(ball.radius);
+	color_.push_back(ball.color);
+	return mass_.size() - 1;
+}
+
+void BallSystem::Remove(size_t index) {
+	assert(index < Size());
+	size_t last = Size() - 1;
+	if (index != last) {
+		positionX_[index] = positionX_[last];
+		positionY_[index] = positionY_[last];
+		positionZ_[index] = positionZ_[last];
+		velocityX_[index] = velocityX_[last];
+		velocityY_[index] = velocityY_[last];
+		velocityZ_[index] = velocityZ_[last];
+		accelerationX_[index] = accelerationX_[last];
+		accelerationY_[index] = accelerationY_[last];
+		accelerationZ_[index] = accelerationZ_[last];
+		mass_[index] = mass_[last];
+		radius_[index] = radius_[last];
+		color_[index] = color_[last];
+	}
+	positionX_.pop_back();
+	positionY_.pop_back();
+	positionZ_.pop_back();
+	velocityX_.pop_back();
+	velocityY_.pop_back();
+	velocityZ_.pop_back();
+	accelerationX_.pop_back();
+	accelerationY_.pop_back();
+	accelerationZ_.pop_back();
+	mass_.pop_back();
+	radius_.pop_back();
+	color_.pop_back();
+}
+
+void BallSystem::Clear() {
+	positionX_.clear();
+	positionY_.clear();
+	positionZ_.clear();
+	velocityX_.clear();
+	velocityY_.clear();
+	velocityZ_.clear();
+	accelerationX_.clear();
+	accelerationY_.clear();
+	accelerationZ_.clear();
+	mass_.clear();
+	radius_.clear();
+	color_.clear();
+}
+
+void BallSystem::Reserve(size_t capacity) {
+	positionX_.reserve(capacity);
+	positionY_.reserve(capacity);
+	positionZ_.reserve(capacity);
+	velocityX_.reserve(capacity);
+	velocityY_.reserve(capacity);
+	velocityZ_.reserve(capacity);
+	accelerationX_.reserve(capacity);
+	accelerationY_.reserve(capacity);
+	accelerationZ_.reserve(capacity);
+	mass_.reserve(capacity);
+	radius_.reserve(capacity);
+	color_.reserve(capacity);
+}
+
+Ball BallSystem::Get(size_t index) const {
+	Ball ball;
+	ball.position = GetPosition(index);
+	ball.velocity = GetVelocity(index);
+	ball.acceleration = { accelerationX_[index], accelerationY_[index], accelerationZ_[index] };
+	ball.mass = mass_[index];
+	ball.radius = radius_[index];
+	ball.color = color_[index];
+	return ball;
+}
+
+void BallSystem::Set(size_t index, const Ball& ball) {
+	SetPosition(index, ball.position);
+	SetVelocity(index, ball.velocity);
+	accelerationX_[index] = ball.acceleration.x;
+	accelerationY_[index] = ball.acceleration.y;
+	accelerationZ_[index] = ball.acceleration.z;
+	mass_[index] = ball.mass;
+	radius_[index] = ball.radius;
+	color_[index] = ball.color;
+}
+
+void BallSystem::SetPosition(size_t index, const Vector3& position) {
+	positionX_[index] = position.x;
+	positionY_[index] = position.y;
+	positionZ_[index] = position.z;
+}
+
+void BallSystem::SetVelocity(size_t index, const Vector3& velocity) {
+	velocityX_[index] = velocity.x;
+	velocityY_[index] = velocity.y;
+	velocityZ_[index] = velocity.z;
+}
+
+void BallSystem::Integrate(float deltaTime) {
+	Integrate(0, Size(), deltaTime);
+}
+
+namespace {
+	// 1成分分の半陰的オイラー積分
+	void IntegrateComponent(float* position, float* velocity, const float* acceleration, size_t begin, size_t end, float deltaTime) {
+		size_t i = begin;
+#if defined(MT3_SIMD_AVX)
+		__m256 dt = _mm256_set1_ps(deltaTime);
+		for (; i + 8 <= end; i += 8) {
+			__m256 v = _mm256_add_ps(_mm256_loadu_ps(velocity + i), _mm256_mul_ps(_mm256_loadu_ps(acceleration + i), dt));
+			_mm256_storeu_ps(velocity + i, v);
+			_mm256_storeu_ps(position + i, _mm256_add_ps(_mm256_loadu_ps(position + i), _mm256_mul_ps(v, dt)));
+		}
+#elif defined(MT3_SIMD_SSE)
+		__m128 dt = _mm_set1_ps(deltaTime);
+		for (; i + 4 <= end; i += 4) {
+			__m128 v = _mm_add_ps(_mm_loadu_ps(velocity + i), _mm_mul_ps(_mm_loadu_ps(acceleration + i), dt));
+			_mm_storeu_ps(velocity + i, v);
+			_mm_storeu_ps(position + i, _mm_add_ps(_mm_loadu_ps(position + i), _mm_mul_ps(v, dt)));
+		}
+#elif defined(MT3_SIMD_NEON)
+		for (; i + 4 <= end; i += 4) {
+			float32x4_t v = vaddq_f32(vld1q_f32(velocity + i), vmulq_n_f32(vld1q_f32(acceleration + i), deltaTime));
+			vst1q_f32(velocity + i, v);
+			vst1q_f32(position + i, vaddq_f32(vld1q_f32(position + i), vmulq_n_f32(v, deltaTime)));
+		}
+#endif
+		for (; i < end; ++i) {
+			velocity[i] += acceleration[i] * deltaTime;
+			position[i] += velocity[i] * deltaTime;
+		}
+	}
+}
+
+void BallSystem::Integrate(size_t begin, size_t end, float deltaTime) {
+	assert(begin <= end && end <= Size());
+	IntegrateComponent(positionX_.data(), velocityX_.data(), accelerationX_.data(), begin, end, deltaTime);
+	IntegrateComponent(positionY_.data(), velocityY_.data(), accelerationY_.data(), begin, end, deltaTime);
+	IntegrateComponent(positionZ_.data(), velocityZ_.data(), accelerationZ_.data(), begin, end, deltaTime);
+}
+
+void BallSystem::IntegrateVelocity(size_t begin, size_t end, float deltaTime) {
+	assert(begin <= end && end <= Size());
+	for (size_t i = begin; i < end; ++i) {
+		velocityX_[i] += accelerationX_[i] * deltaTime;
+		velocityY_[i] += accelerationY_[i] * deltaTime;
+		velocityZ_[i] += accelerationZ_[i] * deltaTime;
+	}
+}
+
+void BallSystem::IntegratePosition(size_t begin, size_t end, float deltaTime) {
+	assert(begin <= end && end <= Size());
+	for (size_t i = begin; i < end; ++i) {
+		positionX_[i] += velocityX_[i] * deltaTime;
+		positionY_[i] += velocityY_[i] * deltaTime;
+		positionZ_[i] += velocityZ_[i] * deltaTime;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Math.h"
+#include "AlignedAllocator.h"
+
+// Ball をSoA(成分ごとの配列)で保持するコンテナ
+//  積分で触るのは位置・速度・加速度だけなので、質量・半径・色は別配列に分けてキャッシュを汚さない
+//  削除は末尾の要素を空いた位置へ移動して配列を詰めるため、削除後はインデックスが変わる
+class BallSystem {
+public:
+	size_t Add(const Ball& ball);
+	// index の要素を削除し、末尾の要素を index に移動する
+	void Remove(size_t index);
+	void Clear();
+	void Reserve(size_t capacity);
+
+	size_t Size() const { return mass_.size(); }
+	bool Empty() const { return mass_.empty(); }
+
+	Ball Get(size_t index) const;
+	void Set(size_t index, const Ball& ball);
+
+	Vector3 GetPosition(size_t index) const { return { positionX_[index], positionY_[index], positionZ_[index] }; }
+	void SetPosition(size_t index, const Vector3& position);
+	Vector3 GetVelocity(size_t index) const { return { velocityX_[index], velocityY_[index], velocityZ_[index] }; }
+	void SetVelocity(size_t index, const Vector3& velocity);
+	float GetRadius(size_t index) const { return radius_[index]; }
+
+	// 半陰的オイラー法 (v += a * dt, x += v * dt) で全ボールを進める
+	void Integrate(float deltaTime);
+	// [begin, end) の範囲だけ進める
+	void Integrate(size_t begin, size_t end, float deltaTime);
+	// 速度と位置を別々に進める (間で速度を書き換えるソルバー用、2つ続けると Integrate と同じ)
+	void IntegrateVelocity(size_t begin, size_t end, float deltaTime);
+	void IntegratePosition(size_t begin, size_t end, float deltaTime);
+
+	float* PositionX() { return positionX_.data(); }
+	float* PositionY() { return positionY_.data(); }
+	float* PositionZ() { return positionZ_.data(); }
+	float* VelocityX() { return velocityX_.data(); }
+	float* VelocityY() { return velocityY_.data(); }
+	float* VelocityZ() { return velocityZ_.data(); }
+	const float* PositionX() const { return positionX_.data(); }
+	const float* PositionY() const { return positionY_.data(); }
+	const float* PositionZ() const { return positionZ_.data(); }
+	const float* VelocityX() const { return velocityX_.data(); }
+	const float* VelocityY() const { return velocityY_.data(); }
+	const float* VelocityZ() const { return velocityZ_.data(); }
+	const float* Mass() const { return mass_.data(); }
+	const float* Radius() const { return radius_.data(); }
+	const uint32_t* Color() const { return color_.data(); }
+
+private:
+	AlignedVector<float> positionX_;
+	AlignedVector<float> positionY_;
+	AlignedVector<float> positionZ_;
+	AlignedVector<float> velocityX_;
+	AlignedVector<float> velocityY_;
+	AlignedVector<float> velocityZ_;
+	AlignedVector<float> accelerationX_;
+	AlignedVector<float> accelerationY_;
+	AlignedVector<float> accelerationZ_;
+	AlignedVector<float> mass_;
+	AlignedVector<float> radius_;
+	AlignedVector<uint32_t> color_;
+};
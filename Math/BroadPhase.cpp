@@ -0,0 +1,290 @@
+#include "BroadPhase.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+	// 挿入ソートのシフト回数がプロキシ数のこの倍数を超えたら std::sort に切り替える
+	const size_t kMaxShiftsPerProxy = 16;
+	// ソート軸を切り替えるのは分散がこの倍率以上大きい軸が現れたときだけ(毎フレームの全ソートを防ぐ)
+	const double kAxisSwitchRatio = 1.5;
+	// 帯の幅は最大幅のこの倍率にして、物体が少し大きくなっても作り直さずに済むようにする
+	const float kBandSlack = 1.25f;
+	const float kMaxBand = 1.0e9f;
+
+	float Component(const Vector3& v, int axis) {
+		return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+	}
+
+	AABB MakeBounds(const Sphere& sphere) {
+		Vector3 extent = { sphere.radius, sphere.radius, sphere.radius };
+		return { sphere.center - extent, sphere.center + extent };
+	}
+}
+
+uint32_t SweepAndPrune::Allocate(const Proxy& proxy) {
+	uint32_t id;
+	if (!freeIds_.empty()) {
+		// 削除した ID は次の Sort まで order_ に残っているので、生き返らせる前に取り除く (残すと同じ ID が2回並ぶ)
+		if (hasRemoved_) {
+			RemoveDeadFromOrder();
+		}
+		id = freeIds_.back();
+		freeIds_.pop_back();
+		proxies_[id] = proxy;
+	} else {
+		id = static_cast<uint32_t>(proxies_.size());
+		proxies_.push_back(proxy);
+	}
+	order_.push_back(id);
+	return id;
+}
+
+uint32_t SweepAndPrune::Add(const AABB& aabb) {
+	return Allocate({ aabb, Sphere{}, BroadPhaseShape::kAABB, true });
+}
+
+uint32_t SweepAndPrune::Add(const Sphere& sphere) {
+	return Allocate({ MakeBounds(sphere), sphere, BroadPhaseShape::kSphere, true });
+}
+
+void SweepAndPrune::Update(uint32_t id, const AABB& aabb) {
+	assert(proxies_[id].alive && proxies_[id].shape == BroadPhaseShape::kAABB);
+	proxies_[id].bounds = aabb;
+}
+
+void SweepAndPrune::Update(uint32_t id, const Sphere& sphere) {
+	assert(proxies_[id].alive && proxies_[id].shape == BroadPhaseShape::kSphere);
+	proxies_[id].sphere = sphere;
+	proxies_[id].bounds = MakeBounds(sphere);
+}
+
+void SweepAndPrune::Remove(uint32_t id) {
+	assert(proxies_[id].alive);
+	proxies_[id].alive = false;
+	freeIds_.push_back(id);
+	hasRemoved_ = true;
+}
+
+void SweepAndPrune::RemoveDeadFromOrder() {
+	std::erase_if(order_, [this](uint32_t id) { return !proxies_[id].alive; });
+	hasRemoved_ = false;
+}
+
+void SweepAndPrune::SelectAxes() {
+	// 中心の分散と各軸方向の最大幅を求める
+	double sum[3] = {};
+	double sumSquared[3] = {};
+	float maxExtent[3] = {};
+	for (uint32_t id : order_) {
+		const AABB& bounds = proxies_[id].bounds;
+		for (int axis = 0; axis < 3; ++axis) {
+			float min = Component(bounds.min, axis);
+			float max = Component(bounds.max, axis);
+			double center = 0.5 * (static_cast<double>(min) + max);
+			sum[axis] += center;
+			sumSquared[axis] += center * center;
+			maxExtent[axis] = std::max(maxExtent[axis], max - min);
+		}
+	}
+	size_t n = order_.size();
+	double variance[3];
+	for (int axis = 0; axis < 3; ++axis) {
+		double mean = n > 0 ? sum[axis] / static_cast<double>(n) : 0.0;
+		variance[axis] = n > 0 ? sumSquared[axis] / static_cast<double>(n) - mean * mean : 0.0;
+	}
+
+	// 分散が最大の軸をソート軸、残りで分散が大きい方を帯の軸にする
+	int axis = axis_;
+	for (int candidate = 0; candidate < 3; ++candidate) {
+		if (variance[candidate] > variance[axis] * kAxisSwitchRatio) {
+			axis = candidate;
+		}
+	}
+	int bandAxis = bandAxis_ != axis ? bandAxis_ : (axis + 1) % 3;
+	int otherAxis = 3 - axis - bandAxis;
+	if (variance[otherAxis] > variance[bandAxis] * kAxisSwitchRatio) {
+		bandAxis = otherAxis;
+	}
+
+	// 帯の幅は最大幅より少し広く取り、幅が大きく変わったときだけ作り直す
+	float extent = maxExtent[bandAxis];
+	float bandWidth = bandWidth_;
+	if (bandAxis != bandAxis_ || extent > bandWidth || extent < bandWidth * 0.5f) {
+		bandWidth = extent > 0.0f ? extent * kBandSlack : 1.0f;
+	}
+
+	if (axis != axis_ || bandAxis != bandAxis_ || bandWidth != bandWidth_) {
+		needFullSort_ = true;
+	}
+	axis_ = axis;
+	bandAxis_ = bandAxis;
+	bandWidth_ = bandWidth;
+}
+
+void SweepAndPrune::Sort() {
+	if (hasRemoved_) {
+		RemoveDeadFromOrder();
+	}
+	SelectAxes();
+
+	size_t n = order_.size();
+	auto bandOf = [this](uint32_t id) {
+		float band = std::floor(Component(proxies_[id].bounds.min, bandAxis_) / bandWidth_);
+		return static_cast<int32_t>(std::clamp(band, -kMaxBand, kMaxBand));
+		};
+	sortedBand_.resize(n);
+	sortedMin_.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		sortedBand_[i] = bandOf(order_[i]);
+		sortedMin_[i] = Component(proxies_[order_[i]].bounds.min, axis_);
+	}
+
+	// 前フレームの順序はほぼ整列済みなので挿入ソートで並べ直す
+	if (!needFullSort_) {
+		size_t shifts = 0;
+		size_t shiftLimit = n * kMaxShiftsPerProxy;
+		for (size_t i = 1; i < n; ++i) {
+			int32_t band = sortedBand_[i];
+			float key = sortedMin_[i];
+			uint32_t id = order_[i];
+			size_t j = i;
+			while (j > 0 && (sortedBand_[j - 1] > band || (sortedBand_[j - 1] == band && sortedMin_[j - 1] > key))) {
+				sortedBand_[j] = sortedBand_[j - 1];
+				sortedMin_[j] = sortedMin_[j - 1];
+				order_[j] = order_[j - 1];
+				--j;
+			}
+			sortedBand_[j] = band;
+			sortedMin_[j] = key;
+			order_[j] = id;
+			shifts += i - j;
+			if (shifts > shiftLimit) {
+				needFullSort_ = true;
+				break;
+			}
+		}
+	}
+	if (needFullSort_) {
+		struct Key {
+			int32_t band;
+			float min;
+			uint32_t id;
+		};
+		std::vector<Key> keys(n);
+		for (size_t i = 0; i < n; ++i) {
+			keys[i] = { sortedBand_[i], sortedMin_[i], order_[i] };
+		}
+		std::sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) {
+			return a.band != b.band ? a.band < b.band : a.min < b.min;
+			});
+		for (size_t i = 0; i < n; ++i) {
+			sortedBand_[i] = keys[i].band;
+			sortedMin_[i] = keys[i].min;
+			order_[i] = keys[i].id;
+		}
+		needFullSort_ = false;
+	}
+
+	// スイープで読む成分をソート順に詰める
+	int axisC = 3 - axis_ - bandAxis_;
+	sortedMax_.resize(n);
+	sortedMinB_.resize(n);
+	sortedMaxB_.resize(n);
+	sortedMinC_.resize(n);
+	sortedMaxC_.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		const AABB& bounds = proxies_[order_[i]].bounds;
+		sortedMax_[i] = Component(bounds.max, axis_);
+		sortedMinB_[i] = Component(bounds.min, bandAxis_);
+		sortedMaxB_[i] = Component(bounds.max, bandAxis_);
+		sortedMinC_[i] = Component(bounds.min, axisC);
+		sortedMaxC_[i] = Component(bounds.max, axisC);
+	}
+}
+
+void SweepAndPrune::Test(size_t i, size_t j, std::vector<BroadPhasePair>& pairs) const {
+	if (sortedMinB_[j] <= sortedMaxB_[i] && sortedMaxB_[j] >= sortedMinB_[i] &&
+		sortedMinC_[j] <= sortedMaxC_[i] && sortedMaxC_[j] >= sortedMinC_[i]) {
+		uint32_t a = order_[i];
+		uint32_t b = order_[j];
+		pairs.push_back(a < b ? BroadPhasePair{ a, b } : BroadPhasePair{ b, a });
+	}
+}
+
+void SweepAndPrune::SweepSelf(size_t begin, size_t end, std::vector<BroadPhasePair>& pairs) const {
+	for (size_t i = begin; i < end; ++i) {
+		float max = sortedMax_[i];
+		// ソート軸で区間が重なる範囲だけを走査する
+		for (size_t j = i + 1; j < end && sortedMin_[j] <= max; ++j) {
+			Test(i, j, pairs);
+		}
+	}
+}
+
+void SweepAndPrune::SweepCross(size_t beginP, size_t endP, size_t beginQ, size_t endQ, std::vector<BroadPhasePair>& pairs) const {
+	// 2つのソート済み列を最小点の順にたどり、先に始まる側の区間と重なるものを相手の列から探す
+	size_t i = beginP;
+	size_t j = beginQ;
+	while (i < endP && j < endQ) {
+		if (sortedMin_[i] <= sortedMin_[j]) {
+			for (size_t k = j; k < endQ && sortedMin_[k] <= sortedMax_[i]; ++k) {
+				Test(i, k, pairs);
+			}
+			++i;
+		} else {
+			for (size_t k = i; k < endP && sortedMin_[k] <= sortedMax_[j]; ++k) {
+				Test(j, k, pairs);
+			}
+			++j;
+		}
+	}
+}
+
+void SweepAndPrune::FindPairs(std::vector<BroadPhasePair>& pairs) {
+	Sort();
+	pairs.clear();
+
+	// 物体の幅は帯の幅以下なので、重なりうるのは同じ帯と隣の帯だけ
+	size_t n = order_.size();
+	size_t begin = 0;
+	while (begin < n) {
+		size_t end = begin + 1;
+		while (end < n && sortedBand_[end] == sortedBand_[begin]) {
+			++end;
+		}
+		SweepSelf(begin, end, pairs);
+		if (end < n && sortedBand_[end] == sortedBand_[begin] + 1) {
+			size_t next = end + 1;
+			while (next < n && sortedBand_[next] == sortedBand_[end]) {
+				++next;
+			}
+			SweepCross(begin, end, end, next, pairs);
+		}
+		begin = end;
+	}
+}
+
+void SweepAndPrune::FindContacts(std::vector<BroadPhasePair>& contacts) {
+	FindPairs(candidates_);
+	contacts.clear();
+
+	for (const BroadPhasePair& pair : candidates_) {
+		const Proxy& a = proxies_[pair.a];
+		const Proxy& b = proxies_[pair.b];
+		bool hit;
+		if (a.shape == BroadPhaseShape::kSphere && b.shape == BroadPhaseShape::kSphere) {
+			hit = Collision::isCollision(a.sphere, b.sphere);
+		} else if (a.shape == BroadPhaseShape::kAABB && b.shape == BroadPhaseShape::kAABB) {
+			// 境界AABBの重なり判定がそのまま狭域判定になる
+			hit = true;
+		} else if (a.shape == BroadPhaseShape::kAABB) {
+			hit = Collision::isCollision(a.bounds, b.sphere);
+		} else {
+			hit = Collision::isCollision(b.bounds, a.sphere);
+		}
+		if (hit) {
+			contacts.push_back(pair);
+		}
+	}
+}
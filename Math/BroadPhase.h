@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+
+enum class BroadPhaseShape : uint8_t {
+	kAABB,
+	kSphere,
+};
+
+struct BroadPhasePair {
+	uint32_t a; //!< プロキシID (a < b)
+	uint32_t b; //!< プロキシID
+};
+
+// Sphere / AABB の集合に対する Sweep and Prune
+//  分散が最大の軸(ソート軸)で最小点をソートした配列をフレーム間で保持し、毎フレーム挿入ソートで並べ直す
+//  2番目に分散が大きい軸を物体の最大幅で帯に区切り、(帯, 最小点) の順に並べることで
+//  スイープを同じ帯と隣の帯だけに限定する(1軸だけのSAPは一様な3次元配置で O(n^(5/3)) になるため)
+class SweepAndPrune {
+public:
+	uint32_t Add(const AABB& aabb);
+	uint32_t Add(const Sphere& sphere);
+	void Update(uint32_t id, const AABB& aabb);
+	void Update(uint32_t id, const Sphere& sphere);
+	// 削除したIDは以降の Add で再利用される
+	void Remove(uint32_t id);
+
+	size_t Size() const { return proxies_.size() - freeIds_.size(); }
+	BroadPhaseShape GetShape(uint32_t id) const { return proxies_[id].shape; }
+	const AABB& GetBounds(uint32_t id) const { return proxies_[id].bounds; }
+
+	// 境界AABBが重なる候補ペアを列挙する
+	void FindPairs(std::vector<BroadPhasePair>& pairs);
+	// 候補ペアに Collision::isCollision を適用し、実際に衝突しているペアだけを列挙する
+	void FindContacts(std::vector<BroadPhasePair>& contacts);
+
+private:
+	struct Proxy {
+		AABB bounds; //!< 境界AABB
+		Sphere sphere; //!< 球の場合の形状
+		BroadPhaseShape shape; //!< 形状の種類
+		bool alive; //!< 有効なプロキシか
+	};
+
+	uint32_t Allocate(const Proxy& proxy);
+	// 削除済みのプロキシを order_ から取り除く
+	void RemoveDeadFromOrder();
+	void SelectAxes();
+	void Sort();
+	void SweepSelf(size_t begin, size_t end, std::vector<BroadPhasePair>& pairs) const;
+	void SweepCross(size_t beginP, size_t endP, size_t beginQ, size_t endQ, std::vector<BroadPhasePair>& pairs) const;
+	void Test(size_t i, size_t j, std::vector<BroadPhasePair>& pairs) const;
+
+	std::vector<Proxy> proxies_;
+	std::vector<uint32_t> freeIds_;
+	bool hasRemoved_ = false;
+	int axis_ = 0; //!< ソート軸
+	int bandAxis_ = 1; //!< 帯に区切る軸
+	float bandWidth_ = 0.0f; //!< 帯の幅
+	bool needFullSort_ = true;
+
+	// (帯, ソート軸の最小点) 順に並べたプロキシIDと、スイープで読む成分のSoAコピー
+	std::vector<uint32_t> order_;
+	std::vector<int32_t> sortedBand_;
+	std::vector<float> sortedMin_;
+	std::vector<float> sortedMax_;
+	std::vector<float> sortedMinB_;
+	std::vector<float> sortedMaxB_;
+	std::vector<float> sortedMinC_;
+	std::vector<float> sortedMaxC_;
+	std::vector<BroadPhasePair> candidates_;
+};
@@ -0,0 +1,200 @@
+#include "Camera.h"
+#include <cassert>
+
+namespace {
+	bool Equal(const Vector3& a, const Vector3& b) {
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	// MakeAffineMatrix(scale, rotate, translate) の逆行列
+	//  3x3 の部分は拡大 S と回転 R の積 S R なので逆は R^T S^-1 (i 行目は R の i 列目を拡大で割ったもの)
+	//  平行移動は -translate に 3x3 の逆をかけたもの
+	Matrix4x4 InverseScaleRotateTranslate(const Matrix4x4& matrix, const Vector3& scale) {
+		assert(scale.x != 0.0f && scale.y != 0.0f && scale.z != 0.0f);
+		// matrix の j 行目は R の j 行目に scale_j をかけたものなので、scale_j の2乗で割ると R^T S^-1 になる
+		float inverseScaleSquared[3] = { 1.0f / (scale.x * scale.x), 1.0f / (scale.y * scale.y), 1.0f / (scale.z * scale.z) };
+		Matrix4x4 result;
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				result.m[i][j] = matrix.m[j][i] * inverseScaleSquared[j];
+			}
+			result.m[i][3] = 0.0f;
+		}
+		for (int j = 0; j < 3; ++j) {
+			result.m[3][j] = -(matrix.m[3][0] * result.m[0][j] + matrix.m[3][1] * result.m[1][j] + matrix.m[3][2] * result.m[2][j]);
+		}
+		result.m[3][3] = 1.0f;
+		return result;
+	}
+
+	// MakePerspectiveFovMatrix の逆行列
+	//  (x, y, z) は (a x, b y, c z + d, z) になるので、(X, Y, Z, W) を (X / a, Y / b, W, (Z - c W) / d) に戻す
+	Matrix4x4 InversePerspective(const Matrix4x4& matrix) {
+		float a = matrix.m[0][0];
+		float b = matrix.m[1][1];
+		float c = matrix.m[2][2];
+		float d = matrix.m[3][2];
+		assert(a != 0.0f && b != 0.0f && d != 0.0f);
+		return {
+			1.0f / a,0.0f,0.0f,0.0f,
+			0.0f,1.0f / b,0.0f,0.0f,
+			0.0f,0.0f,0.0f,1.0f / d,
+			0.0f,0.0f,1.0f,-c / d
+		};
+	}
+
+	// MakeViewportMatrix の逆行列 (拡大と平行移動だけ)
+	Matrix4x4 InverseViewport(const Matrix4x4& matrix) {
+		float scaleX = 1.0f / matrix.m[0][0];
+		float scaleY = 1.0f / matrix.m[1][1];
+		float scaleZ = 1.0f / matrix.m[2][2];
+		return {
+			scaleX,0.0f,0.0f,0.0f,
+			0.0f,scaleY,0.0f,0.0f,
+			0.0f,0.0f,scaleZ,0.0f,
+			-matrix.m[3][0] * scaleX,-matrix.m[3][1] * scaleY,-matrix.m[3][2] * scaleZ,1.0f
+		};
+	}
+}
+
+Camera::Camera()
+	: scale_{ 1.0f,1.0f,1.0f }, rotate_{ 0.0f,0.0f,0.0f }, translate_{ 0.0f,0.0f,0.0f },
+	fovY_(0.45f), aspectRatio_(1280.0f / 720.0f), nearClip_(0.1f), farClip_(100.0f),
+	viewportLeft_(0.0f), viewportTop_(0.0f), viewportWidth_(1280.0f), viewportHeight_(720.0f), minDepth_(0.0f), maxDepth_(1.0f),
+	cached_(0) {
+}
+
+void Camera::SetScale(const Vector3& scale) {
+	if (!Equal(scale_, scale)) {
+		scale_ = scale;
+		cached_ &= ~kTransformDependents;
+	}
+}
+
+void Camera::SetRotate(const Vector3& rotate) {
+	if (!Equal(rotate_, rotate)) {
+		rotate_ = rotate;
+		cached_ &= ~kTransformDependents;
+	}
+}
+
+void Camera::SetTranslate(const Vector3& translate) {
+	if (!Equal(translate_, translate)) {
+		translate_ = translate;
+		cached_ &= ~kTransformDependents;
+	}
+}
+
+void Camera::SetPerspective(float fovY, float aspectRatio, float nearClip, float farClip) {
+	assert(fovY > 0.0f && aspectRatio > 0.0f && nearClip > 0.0f && farClip > nearClip);
+	if (fovY_ != fovY || aspectRatio_ != aspectRatio || nearClip_ != nearClip || farClip_ != farClip) {
+		fovY_ = fovY;
+		aspectRatio_ = aspectRatio;
+		nearClip_ = nearClip;
+		farClip_ = farClip;
+		cached_ &= ~kProjectionDependents;
+	}
+}
+
+void Camera::SetViewport(float left, float top, float width, float height, float minDepth, float maxDepth) {
+	assert(width > 0.0f && height > 0.0f && maxDepth > minDepth);
+	if (viewportLeft_ != left || viewportTop_ != top || viewportWidth_ != width || viewportHeight_ != height ||
+		minDepth_ != minDepth || maxDepth_ != maxDepth) {
+		viewportLeft_ = left;
+		viewportTop_ = top;
+		viewportWidth_ = width;
+		viewportHeight_ = height;
+		minDepth_ = minDepth;
+		maxDepth_ = maxDepth;
+		cached_ &= ~kViewportDependents;
+	}
+}
+
+const Matrix4x4& Camera::GetWorldMatrix() const {
+	UpdateView();
+	return worldMatrix_;
+}
+
+const Matrix4x4& Camera::GetViewMatrix() const {
+	UpdateView();
+	return viewMatrix_;
+}
+
+const Matrix4x4& Camera::GetProjectionMatrix() const {
+	UpdateProjection();
+	return projectionMatrix_;
+}
+
+const Matrix4x4& Camera::GetViewportMatrix() const {
+	UpdateViewport();
+	return viewportMatrix_;
+}
+
+const Matrix4x4& Camera::GetViewProjectionMatrix() const {
+	UpdateViewProjection();
+	return viewProjectionMatrix_;
+}
+
+const Matrix4x4& Camera::GetViewProjectionViewportMatrix() const {
+	if ((cached_ & kViewProjectionViewportCached) == 0) {
+		UpdateViewProjection();
+		UpdateViewport();
+		viewProjectionViewportMatrix_ = viewProjectionMatrix_ * viewportMatrix_;
+		cached_ |= kViewProjectionViewportCached;
+	}
+	return viewProjectionViewportMatrix_;
+}
+
+const Matrix4x4& Camera::GetInverseViewProjectionViewportMatrix() const {
+	if ((cached_ & kInverseViewProjectionViewportCached) == 0) {
+		UpdateView();
+		UpdateProjection();
+		UpdateViewport();
+		// (V P Vp)^-1 = Vp^-1 P^-1 V^-1 で、V^-1 はワールド行列そのもの
+		inverseViewProjectionViewportMatrix_ = inverseViewportMatrix_ * inverseProjectionMatrix_ * worldMatrix_;
+		cached_ |= kInverseViewProjectionViewportCached;
+	}
+	return inverseViewProjectionViewportMatrix_;
+}
+
+const Frustum& Camera::GetFrustum() const {
+	if ((cached_ & kFrustumCached) == 0) {
+		UpdateViewProjection();
+		frustum_ = MakeFrustum(viewProjectionMatrix_);
+		cached_ |= kFrustumCached;
+	}
+	return frustum_;
+}
+
+void Camera::UpdateView() const {
+	if ((cached_ & kViewCached) == 0) {
+		worldMatrix_ = MakeAffineMatrix(scale_, rotate_, translate_);
+		viewMatrix_ = InverseScaleRotateTranslate(worldMatrix_, scale_);
+		cached_ |= kViewCached;
+	}
+}
+
+void Camera::UpdateProjection() const {
+	if ((cached_ & kProjectionCached) == 0) {
+		projectionMatrix_ = MakePerspectiveFovMatrix(fovY_, aspectRatio_, nearClip_, farClip_);
+		inverseProjectionMatrix_ = InversePerspective(projectionMatrix_);
+		cached_ |= kProjectionCached;
+	}
+}
+
+void Camera::UpdateViewport() const {
+	if ((cached_ & kViewportCached) == 0) {
+		viewportMatrix_ = MakeViewportMatrix(viewportLeft_, viewportTop_, viewportWidth_, viewportHeight_, minDepth_, maxDepth_);
+		inverseViewportMatrix_ = InverseViewport(viewportMatrix_);
+		cached_ |= kViewportCached;
+	}
+}
+
+void Camera::UpdateViewProjection() const {
+	if ((cached_ & kViewProjectionCached) == 0) {
+		UpdateView();
+		UpdateProjection();
+		viewProjectionMatrix_ = viewMatrix_ * projectionMatrix_;
+		cached_ |= kViewProjectionCached;
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include "Math.h"
+#include "Frustum.h"
+
+// 拡大・回転・平行移動と透視投影・ビューポートのパラメータを持つカメラ
+//  行列は使う値が変わった後に最初に取得したときだけ作り直し、次に変わるまで同じものの参照を返す
+//  (取得しない行列は作らないので、ビュープロジェクション行列だけ使うなら逆行列や視錐台の分はかからない)
+//  (取得で作り直すので、値を変えた後に複数のスレッドから同時に取得しないこと)
+class Camera {
+public:
+	Camera();
+
+	// 値が変わったときだけ行列を作り直す
+	void SetScale(const Vector3& scale);
+	void SetRotate(const Vector3& rotate);
+	void SetTranslate(const Vector3& translate);
+	// MakePerspectiveFovMatrix と同じ引数
+	void SetPerspective(float fovY, float aspectRatio, float nearClip, float farClip);
+	// MakeViewportMatrix と同じ引数
+	void SetViewport(float left, float top, float width, float height, float minDepth = 0.0f, float maxDepth = 1.0f);
+
+	const Vector3& GetScale() const { return scale_; }
+	const Vector3& GetRotate() const { return rotate_; }
+	const Vector3& GetTranslate() const { return translate_; }
+
+	// カメラのワールド行列 (MakeAffineMatrix(scale, rotate, translate))
+	const Matrix4x4& GetWorldMatrix() const;
+	// ワールド行列の逆行列。拡大・回転・平行移動だけなので一般の逆行列を使わずに求める
+	const Matrix4x4& GetViewMatrix() const;
+	const Matrix4x4& GetProjectionMatrix() const;
+	const Matrix4x4& GetViewportMatrix() const;
+	const Matrix4x4& GetViewProjectionMatrix() const;
+	// ワールド座標からスクリーン座標への行列
+	const Matrix4x4& GetViewProjectionViewportMatrix() const;
+	// スクリーン座標 (x, y, 深度) からワールド座標への行列 (マウスで指した位置のレイなどに使う)
+	const Matrix4x4& GetInverseViewProjectionViewportMatrix() const;
+	// ビュープロジェクション行列の視錐台 (カリング用)
+	const Frustum& GetFrustum() const;
+
+private:
+	// 作ってある行列
+	enum CacheFlag : uint32_t {
+		kViewCached = 1 << 0, //!< ワールド行列とビュー行列
+		kProjectionCached = 1 << 1, //!< プロジェクション行列とその逆行列
+		kViewportCached = 1 << 2, //!< ビューポート行列とその逆行列
+		kViewProjectionCached = 1 << 3,
+		kViewProjectionViewportCached = 1 << 4,
+		kInverseViewProjectionViewportCached = 1 << 5,
+		kFrustumCached = 1 << 6,
+	};
+	// それぞれの値が変わったときに作り直す行列
+	static const uint32_t kTransformDependents =
+		kViewCached | kViewProjectionCached | kViewProjectionViewportCached | kInverseViewProjectionViewportCached | kFrustumCached;
+	static const uint32_t kProjectionDependents =
+		kProjectionCached | kViewProjectionCached | kViewProjectionViewportCached | kInverseViewProjectionViewportCached | kFrustumCached;
+	static const uint32_t kViewportDependents = kViewportCached | kViewProjectionViewportCached | kInverseViewProjectionViewportCached;
+
+	void UpdateView() const;
+	void UpdateProjection() const;
+	void UpdateViewport() const;
+	void UpdateViewProjection() const;
+
+	Vector3 scale_;
+	Vector3 rotate_;
+	Vector3 translate_;
+	float fovY_;
+	float aspectRatio_;
+	float nearClip_;
+	float farClip_;
+	float viewportLeft_;
+	float viewportTop_;
+	float viewportWidth_;
+	float viewportHeight_;
+	float minDepth_;
+	float maxDepth_;
+
+	mutable uint32_t cached_; //!< CacheFlag の組み合わせ
+	mutable Matrix4x4 worldMatrix_;
+	mutable Matrix4x4 viewMatrix_;
+	mutable Matrix4x4 projectionMatrix_;
+	mutable Matrix4x4 inverseProjectionMatrix_;
+	mutable Matrix4x4 viewportMatrix_;
+	mutable Matrix4x4 inverseViewportMatrix_;
+	mutable Matrix4x4 viewProjectionMatrix_;
+	mutable Matrix4x4 viewProjectionViewportMatrix_;
+	mutable Matrix4x4 inverseViewProjectionViewportMatrix_;
+	mutable Frustum frustum_;
+};
@@ -0,0 +1,337 @@
+#include "ContactSolver.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "Profiler.h"
+
+namespace {
+	const size_t kChunkSize = 1024;
+
+	void ParallelFor(JobSystem* jobSystem, size_t count, const JobSystem::RangeFunction& function) {
+		if (jobSystem == nullptr) {
+			function(0, count);
+			return;
+		}
+		jobSystem->ParallelFor(count, kChunkSize, function);
+	}
+
+	uint64_t ContactKey(const Contact& contact) {
+		return (static_cast<uint64_t>(contact.a) << 32) | contact.b;
+	}
+
+	bool IsStatic(uint32_t b) {
+		return (b & (ContactSolver::kPlaneBit | ContactSolver::kAABBBit)) != 0;
+	}
+
+	Contact MakeContact(uint32_t a, uint32_t b, const Vector3& normal, const Vector3& point, float separation) {
+		Contact contact{};
+		contact.a = a;
+		contact.b = b;
+		contact.normal = normal;
+		contact.point = point;
+		contact.depth = -separation;
+		contact.normalImpulse = 0.0f;
+		contact.tangentImpulse = { 0.0f, 0.0f, 0.0f };
+		return contact;
+	}
+
+	// AABB 上で center に最も近い点と、そこから球へ向かう法線・距離を求める
+	//  中心が箱の中にあるときは最も近い面から外へ押し出す向きにする
+	void ClosestFeature(const AABB& aabb, const Vector3& center, Vector3& point, Vector3& normal, float& distance) {
+		point = {
+			std::clamp(center.x, aabb.min.x, aabb.max.x),
+			std::clamp(center.y, aabb.min.y, aabb.max.y),
+			std::clamp(center.z, aabb.min.z, aabb.max.z),
+		};
+		Vector3 diff = center - point;
+		float lengthSquared = diff.LengthSquared();
+		if (lengthSquared > 0.0f) {
+			distance = std::sqrt(lengthSquared);
+			normal = diff * (1.0f / distance);
+			return;
+		}
+
+		float faces[6] = {
+			center.x - aabb.min.x, aabb.max.x - center.x,
+			center.y - aabb.min.y, aabb.max.y - center.y,
+			center.z - aabb.min.z, aabb.max.z - center.z,
+		};
+		int face = 0;
+		for (int i = 1; i < 6; ++i) {
+			if (faces[i] < faces[face]) {
+				face = i;
+			}
+		}
+		float sign = (face & 1) ? 1.0f : -1.0f;
+		normal = { 0.0f, 0.0f, 0.0f };
+		switch (face / 2) {
+		case 0: normal.x = sign; point.x = (face & 1) ? aabb.max.x : aabb.min.x; break;
+		case 1: normal.y = sign; point.y = (face & 1) ? aabb.max.y : aabb.min.y; break;
+		default: normal.z = sign; point.z = (face & 1) ? aabb.max.z : aabb.min.z; break;
+		}
+		distance = -faces[face];
+	}
+}
+
+uint32_t ContactSolver::AddPlane(const Plane& plane) {
+	planes_.push_back(plane);
+	return kPlaneBit | static_cast<uint32_t>(planes_.size() - 1);
+}
+
+uint32_t ContactSolver::AddAABB(const AABB& aabb) {
+	aabbs_.push_back(aabb);
+	return kAABBBit | static_cast<uint32_t>(aabbs_.size() - 1);
+}
+
+void ContactSolver::ClearStatics() {
+	planes_.clear();
+	aabbs_.clear();
+	contacts_.clear();
+}
+
+void ContactSolver::Step(BallSystem& balls, float deltaTime, JobSystem* jobSystem) {
+	MT3_PROFILE_ZONE("ContactSolver::Step");
+	assert(deltaTime > 0.0f);
+	size_t count = balls.Size();
+
+	ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+		balls.IntegrateVelocity(begin, end, deltaTime);
+		});
+
+	contacts_.swap(previousContacts_);
+	FindContacts(balls, deltaTime, jobSystem);
+	Prepare(balls);
+	if (settings_.warmStarting) {
+		WarmStart(balls, previousContacts_);
+	}
+
+	float inverseDeltaTime = 1.0f / deltaTime;
+	for (uint32_t iteration = 0; iteration < settings_.iterations; ++iteration) {
+		Solve(balls, inverseDeltaTime, true);
+	}
+
+	ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+		balls.IntegratePosition(begin, end, deltaTime);
+		});
+
+	// 押し出しで付いた速度は位置に反映したので、押し出しなしで解き直して速度から取り除く
+	for (uint32_t iteration = 0; iteration < settings_.relaxIterations; ++iteration) {
+		Solve(balls, inverseDeltaTime, false);
+	}
+	if (settings_.restitution > 0.0f) {
+		ApplyRestitution(balls);
+	}
+}
+
+void ContactSolver::FindContacts(const BallSystem& balls, float deltaTime, JobSystem* jobSystem) {
+	MT3_PROFILE_ZONE("ContactSolver::FindContacts");
+	contacts_.clear();
+	size_t count = balls.Size();
+
+	// ボール同士: 1ステップで動く距離だけ半径を広げた球で候補を探す
+	bounds_.resize(count);
+	ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			float margin = balls.GetVelocity(i).Length() * deltaTime + settings_.speculativeDistance * 0.5f;
+			bounds_[i] = { balls.GetPosition(i), balls.GetRadius(i) + margin };
+		}
+		});
+	grid_.Build(bounds_, jobSystem);
+	grid_.FindPairs(pairs_, jobSystem);
+
+	for (const BroadPhasePair& pair : pairs_) {
+		Vector3 positionA = balls.GetPosition(pair.a);
+		Vector3 positionB = balls.GetPosition(pair.b);
+		float radiusA = balls.GetRadius(pair.a);
+		float radiusB = balls.GetRadius(pair.b);
+		Vector3 diff = positionA - positionB;
+		float lengthSquared = diff.LengthSquared();
+		float distance = std::sqrt(lengthSquared);
+		// 中心が一致したときは向きが決まらないので上へ押し出す
+		Vector3 normal = lengthSquared > 0.0f ? diff * (1.0f / distance) : Vector3(0.0f, 1.0f, 0.0f);
+		float separation = distance - radiusA - radiusB;
+		Vector3 point = positionA - normal * (radiusA + separation * 0.5f);
+		contacts_.push_back(MakeContact(pair.a, pair.b, normal, point, separation));
+	}
+
+	// 静的な形状: チャンクごとに集めてチャンク順に連結する
+	if (!planes_.empty() || !aabbs_.empty()) {
+		if (jobSystem == nullptr) {
+			FindStaticContacts(balls, deltaTime, 0, count, contacts_);
+		} else {
+			size_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+			std::vector<std::vector<Contact>> chunkContacts(chunkCount);
+			jobSystem->ParallelFor(count, kChunkSize, [&](size_t begin, size_t end) {
+				FindStaticContacts(balls, deltaTime, begin, end, chunkContacts[begin / kChunkSize]);
+				});
+			for (const std::vector<Contact>& chunk : chunkContacts) {
+				contacts_.insert(contacts_.end(), chunk.begin(), chunk.end());
+			}
+		}
+	}
+
+	// キー順に並べておくと、前のステップとの突き合わせが1回の走査で済み、解く順番もスレッド数に依存しない
+	std::sort(contacts_.begin(), contacts_.end(), [](const Contact& lhs, const Contact& rhs) {
+		return ContactKey(lhs) < ContactKey(rhs);
+		});
+
+	// 判定した組の数 (候補のボール同士と、ボールと静的な形状の全ての組) と、実際に接している数
+	MT3_PROFILE_COUNTER("Collision tests", pairs_.size() + count * (planes_.size() + aabbs_.size()));
+	MT3_PROFILE_COUNTER("Collision hits", std::count_if(contacts_.begin(), contacts_.end(), [](const Contact& contact) { return contact.depth >= 0.0f; }));
+}
+
+void ContactSolver::FindStaticContacts(const BallSystem& balls, float deltaTime, size_t begin, size_t end, std::vector<Contact>& contacts) const {
+	for (size_t i = begin; i < end; ++i) {
+		Vector3 position = balls.GetPosition(i);
+		float radius = balls.GetRadius(i);
+		float margin = balls.GetVelocity(i).Length() * deltaTime + settings_.speculativeDistance;
+		uint32_t a = static_cast<uint32_t>(i);
+
+		// 平面は法線の裏側を中身とする半空間として扱う
+		for (size_t p = 0; p < planes_.size(); ++p) {
+			const Plane& plane = planes_[p];
+			float distance = plane.SignedDistance(position);
+			float separation = distance - radius;
+			if (separation < margin) {
+				Vector3 point = position - plane.normal * distance;
+				contacts.push_back(MakeContact(a, kPlaneBit | static_cast<uint32_t>(p), plane.normal, point, separation));
+			}
+		}
+
+		for (size_t box = 0; box < aabbs_.size(); ++box) {
+			Vector3 point;
+			Vector3 normal;
+			float distance;
+			ClosestFeature(aabbs_[box], position, point, normal, distance);
+			float separation = distance - radius;
+			if (separation < margin) {
+				contacts.push_back(MakeContact(a, kAABBBit | static_cast<uint32_t>(box), normal, point, separation));
+			}
+		}
+	}
+}
+
+void ContactSolver::Prepare(const BallSystem& balls) {
+	size_t count = balls.Size();
+	const float* mass = balls.Mass();
+	inverseMass_.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		inverseMass_[i] = mass[i] > 0.0f ? 1.0f / mass[i] : 0.0f;
+	}
+
+	constraints_.resize(contacts_.size());
+	for (size_t c = 0; c < contacts_.size(); ++c) {
+		const Contact& contact = contacts_[c];
+		ContactConstraint& constraint = constraints_[c];
+		bool isStatic = IsStatic(contact.b);
+		constraint.inverseMassA = inverseMass_[contact.a];
+		constraint.inverseMassB = isStatic ? 0.0f : inverseMass_[contact.b];
+		float inverseMassSum = constraint.inverseMassA + constraint.inverseMassB;
+		constraint.normalMass = inverseMassSum > 0.0f ? 1.0f / inverseMassSum : 0.0f;
+
+		Vector3 relativeVelocity = balls.GetVelocity(contact.a);
+		Vector3 relativePosition = balls.GetPosition(contact.a);
+		if (!isStatic) {
+			relativeVelocity -= balls.GetVelocity(contact.b);
+			relativePosition -= balls.GetPosition(contact.b);
+		}
+		constraint.relativeVelocity = relativeVelocity.Dot(contact.normal);
+		constraint.adjustedSeparation = -contact.depth - relativePosition.Dot(contact.normal);
+		constraint.maxNormalImpulse = 0.0f;
+	}
+}
+
+void ContactSolver::WarmStart(BallSystem& balls, const std::vector<Contact>& previous) {
+	// どちらもキー順なので並べて突き合わせる
+	size_t p = 0;
+	for (size_t c = 0; c < contacts_.size(); ++c) {
+		Contact& contact = contacts_[c];
+		uint64_t key = ContactKey(contact);
+		while (p < previous.size() && ContactKey(previous[p]) < key) {
+			++p;
+		}
+		if (p == previous.size() || ContactKey(previous[p]) != key) {
+			continue;
+		}
+		contact.normalImpulse = previous[p].normalImpulse;
+		// 法線が変わった分の摩擦は接平面へ落とす
+		Vector3 tangentImpulse = previous[p].tangentImpulse;
+		contact.tangentImpulse = tangentImpulse - contact.normal * tangentImpulse.Dot(contact.normal);
+		ApplyImpulse(balls, contact, constraints_[c], contact.normal * contact.normalImpulse + contact.tangentImpulse);
+	}
+}
+
+float ContactSolver::Separation(const BallSystem& balls, const Contact& contact, const ContactConstraint& constraint) const {
+	Vector3 relativePosition = balls.GetPosition(contact.a);
+	if (!IsStatic(contact.b)) {
+		relativePosition -= balls.GetPosition(contact.b);
+	}
+	return constraint.adjustedSeparation + relativePosition.Dot(contact.normal);
+}
+
+void ContactSolver::ApplyImpulse(BallSystem& balls, const Contact& contact, const ContactConstraint& constraint, const Vector3& impulse) {
+	balls.SetVelocity(contact.a, balls.GetVelocity(contact.a) + impulse * constraint.inverseMassA);
+	if (!IsStatic(contact.b)) {
+		balls.SetVelocity(contact.b, balls.GetVelocity(contact.b) - impulse * constraint.inverseMassB);
+	}
+}
+
+void ContactSolver::Solve(BallSystem& balls, float inverseDeltaTime, bool useBias) {
+	for (size_t c = 0; c < contacts_.size(); ++c) {
+		Contact& contact = contacts_[c];
+		ContactConstraint& constraint = constraints_[c];
+
+		// 離れている間は、次のステップまでに接触面に届く速さまでは近づいてよい
+		float separation = Separation(balls, contact, constraint);
+		float bias = 0.0f;
+		if (separation > 0.0f) {
+			bias = separation * inverseDeltaTime;
+		} else if (useBias) {
+			bias = std::max(settings_.baumgarte * inverseDeltaTime * std::min(0.0f, separation + settings_.linearSlop), -settings_.maxPushoutVelocity);
+		}
+
+		Vector3 relativeVelocity = balls.GetVelocity(contact.a);
+		if (!IsStatic(contact.b)) {
+			relativeVelocity -= balls.GetVelocity(contact.b);
+		}
+		float normalVelocity = relativeVelocity.Dot(contact.normal);
+		float newImpulse = std::max(contact.normalImpulse - constraint.normalMass * (normalVelocity + bias), 0.0f);
+		float impulse = newImpulse - contact.normalImpulse;
+		contact.normalImpulse = newImpulse;
+		constraint.maxNormalImpulse = std::max(constraint.maxNormalImpulse, newImpulse);
+		relativeVelocity += contact.normal * (impulse * (constraint.inverseMassA + constraint.inverseMassB));
+		ApplyImpulse(balls, contact, constraint, contact.normal * impulse);
+
+		// 摩擦は接平面内の相対速度を打ち消す向きに、法線方向の力積×摩擦係数まで掛ける
+		Vector3 tangentVelocity = relativeVelocity - contact.normal * relativeVelocity.Dot(contact.normal);
+		Vector3 newTangentImpulse = contact.tangentImpulse - tangentVelocity * constraint.normalMass;
+		float maxFriction = settings_.friction * contact.normalImpulse;
+		float lengthSquared = newTangentImpulse.LengthSquared();
+		if (lengthSquared > maxFriction * maxFriction) {
+			newTangentImpulse = lengthSquared > 0.0f ? newTangentImpulse * (maxFriction / std::sqrt(lengthSquared)) : Vector3(0.0f, 0.0f, 0.0f);
+		}
+		Vector3 tangentImpulse = newTangentImpulse - contact.tangentImpulse;
+		contact.tangentImpulse = newTangentImpulse;
+		ApplyImpulse(balls, contact, constraint, tangentImpulse);
+	}
+}
+
+void ContactSolver::ApplyRestitution(BallSystem& balls) {
+	// 実際に力積が掛かった接触だけ、解く前の接近速度に反発係数を掛けた速さで離れさせる
+	for (size_t c = 0; c < contacts_.size(); ++c) {
+		Contact& contact = contacts_[c];
+		const ContactConstraint& constraint = constraints_[c];
+		if (constraint.relativeVelocity > -settings_.restitutionThreshold || constraint.maxNormalImpulse == 0.0f) {
+			continue;
+		}
+		Vector3 relativeVelocity = balls.GetVelocity(contact.a);
+		if (!IsStatic(contact.b)) {
+			relativeVelocity -= balls.GetVelocity(contact.b);
+		}
+		float normalVelocity = relativeVelocity.Dot(contact.normal);
+		float newImpulse = std::max(contact.normalImpulse - constraint.normalMass * (normalVelocity + settings_.restitution * constraint.relativeVelocity), 0.0f);
+		float impulse = newImpulse - contact.normalImpulse;
+		contact.normalImpulse = newImpulse;
+		ApplyImpulse(balls, contact, constraint, contact.normal * impulse);
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+#include "BallSystem.h"
+#include "BroadPhase.h"
+#include "JobSystem.h"
+#include "SpatialHashGrid.h"
+
+struct Contact {
+	uint32_t a; //!< ボールのインデックス
+	uint32_t b; //!< 相手のボールのインデックス (静的な形状なら ContactSolver::kPlaneBit / kAABBBit | 番号)
+	Vector3 normal; //!< 相手からボール a へ向かう単位法線
+	Vector3 point; //!< 接触点
+	float depth; //!< めり込み量 (負なら離れている予測接触)
+	float normalImpulse; //!< 法線方向に加えた力積の合計
+	Vector3 tangentImpulse; //!< 摩擦として加えた力積の合計
+};
+
+struct ContactSolverSettings {
+	uint32_t iterations = 8; //!< 速度の反復回数
+	uint32_t relaxIterations = 2; //!< 位置を進めた後、押し出しの速度を取り除く反復回数
+	float restitution = 0.0f; //!< 反発係数
+	float friction = 0.5f; //!< 摩擦係数
+	float restitutionThreshold = 1.0f; //!< これより遅く衝突したときは反発させない (積み重ねを静止させるため)
+	float baumgarte = 0.2f; //!< 1ステップで押し出すめり込みの割合
+	float linearSlop = 0.005f; //!< 押し出さずに許すめり込み
+	float maxPushoutVelocity = 4.0f; //!< 押し出しの速度の上限
+	float speculativeDistance = 0.02f; //!< 離れていてもこの距離までは接触として扱う
+	bool warmStarting = true; //!< 前のステップの力積から始める
+};
+
+// ボール同士・ボールと静的な平面/AABB の接触を逐次インパルス法で解く
+//  ボール同士の候補は SpatialHashGrid で探し、1ステップで動く距離だけ広げて予測接触にする(すり抜けを防ぐ)
+//  速いボールも予測接触で止まるので、Collision::SweepSphere による連続衝突判定は使わない (SweepSphere は単発の問い合わせ用)
+//  接触はキー順に並べて前のステップの接触と突き合わせ、力積を引き継ぐ(ウォームスタート)
+//  反復はガウス・ザイデル法なので1反復のコストは接触数に比例し、結果はスレッド数に依存しない
+//  ボールは回転しないので摩擦は並進速度だけに掛かる。質量が0以下のボールは接触で押されない
+//  ボールを Remove するとインデックスが変わるので、その次のステップは引き継ぎが正しく働かない
+class ContactSolver {
+public:
+	static const uint32_t kPlaneBit = 0x80000000u;
+	static const uint32_t kAABBBit = 0x40000000u;
+
+	explicit ContactSolver(const ContactSolverSettings& settings = {}) : settings_(settings) {}
+
+	void SetSettings(const ContactSolverSettings& settings) { settings_ = settings; }
+	const ContactSolverSettings& Settings() const { return settings_; }
+
+	uint32_t AddPlane(const Plane& plane);
+	uint32_t AddAABB(const AABB& aabb);
+	void ClearStatics();
+	// 前のステップの接触を捨てる (ボールを入れ替えたとき用)
+	void ResetCache() { contacts_.clear(); }
+
+	// 加速度で速度を進め、接触を解いてから位置を進める
+	void Step(BallSystem& balls, float deltaTime, JobSystem* jobSystem = nullptr);
+
+	// 直前の Step で解いた接触 (キー順)
+	const std::vector<Contact>& Contacts() const { return contacts_; }
+
+private:
+	// 解くときだけ使う値
+	struct ContactConstraint {
+		float inverseMassA;
+		float inverseMassB;
+		float normalMass;
+		float relativeVelocity; //!< 解く前の法線方向の相対速度
+		float adjustedSeparation; //!< 現在の位置から距離を求めるための補正値
+		float maxNormalImpulse;
+	};
+
+	void FindContacts(const BallSystem& balls, float deltaTime, JobSystem* jobSystem);
+	void FindStaticContacts(const BallSystem& balls, float deltaTime, size_t begin, size_t end, std::vector<Contact>& contacts) const;
+	void WarmStart(BallSystem& balls, const std::vector<Contact>& previous);
+	void Prepare(const BallSystem& balls);
+	void Solve(BallSystem& balls, float inverseDeltaTime, bool useBias);
+	void ApplyRestitution(BallSystem& balls);
+	void ApplyImpulse(BallSystem& balls, const Contact& contact, const ContactConstraint& constraint, const Vector3& impulse);
+	float Separation(const BallSystem& balls, const Contact& contact, const ContactConstraint& constraint) const;
+
+	ContactSolverSettings settings_;
+	std::vector<Plane> planes_;
+	std::vector<AABB> aabbs_;
+
+	SpatialHashGrid grid_;
+	std::vector<Sphere> bounds_;
+	std::vector<BroadPhasePair> pairs_;
+	std::vector<Contact> contacts_;
+	std::vector<Contact> previousContacts_;
+	std::vector<ContactConstraint> constraints_;
+	std::vector<float> inverseMass_;
+};
@@ -0,0 +1,323 @@
+#include "ContinuousCollision.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// 長さがこれ以下の法線は向きが決まらないとみなす
+	const float kNormalEpsilon = 1.0e-12f;
+
+	// origin + motion * t が中心 center・半径 radius の球面に最初に触れる t を求める
+	bool SweepPoint(const Vector3& origin, const Vector3& motion, const Vector3& center, float radius, float& t) {
+		Vector3 m = origin - center;
+		float b = m.Dot(motion);
+		float c = m.Dot(m) - radius * radius;
+		if (c <= 0.0f) {
+			t = 0.0f;
+			return true;
+		}
+		if (b >= 0.0f) {
+			return false;
+		}
+		float a = motion.Dot(motion);
+		float discriminant = b * b - a * c;
+		if (discriminant < 0.0f) {
+			return false;
+		}
+		t = (-b - std::sqrt(discriminant)) / a;
+		return t <= 1.0f;
+	}
+
+	// 線分 pq を中心にしたカプセルに対して同様に求める
+	bool SweepPointCapsule(const Vector3& origin, const Vector3& motion, const Vector3& p, const Vector3& q, float radius, float& t) {
+		bool found = false;
+		t = INFINITY;
+
+		// 円柱の側面
+		Vector3 d = q - p;
+		Vector3 m = origin - p;
+		float md = m.Dot(d);
+		float nd = motion.Dot(d);
+		float dd = d.Dot(d);
+		float a = dd * motion.Dot(motion) - nd * nd;
+		if (a > 0.0f) {
+			float b = dd * m.Dot(motion) - nd * md;
+			float c = dd * (m.Dot(m) - radius * radius) - md * md;
+			float discriminant = b * b - a * c;
+			if (discriminant >= 0.0f) {
+				float side = (-b - std::sqrt(discriminant)) / a;
+				float s = md + side * nd;
+				if (side >= 0.0f && side <= 1.0f && s >= 0.0f && s <= dd) {
+					t = side;
+					found = true;
+				}
+			}
+		}
+
+		// 両端の球
+		float end;
+		if (SweepPoint(origin, motion, p, radius, end) && end < t) {
+			t = end;
+			found = true;
+		}
+		if (SweepPoint(origin, motion, q, radius, end) && end < t) {
+			t = end;
+			found = true;
+		}
+		return found;
+	}
+
+	// スラブ法で origin + motion * t が箱に入る最初の t を求める
+	bool SweepPointBox(const Vector3& origin, const Vector3& motion, const Vector3& min, const Vector3& max, float& t) {
+		float tMin = 0.0f;
+		float tMax = 1.0f;
+		const float o[3] = { origin.x, origin.y, origin.z };
+		const float d[3] = { motion.x, motion.y, motion.z };
+		const float lo[3] = { min.x, min.y, min.z };
+		const float hi[3] = { max.x, max.y, max.z };
+		for (int axis = 0; axis < 3; ++axis) {
+			if (d[axis] == 0.0f) {
+				if (o[axis] < lo[axis] || o[axis] > hi[axis]) {
+					return false;
+				}
+				continue;
+			}
+			float inv = 1.0f / d[axis];
+			float t1 = (lo[axis] - o[axis]) * inv;
+			float t2 = (hi[axis] - o[axis]) * inv;
+			tMin = std::max(tMin, std::min(t1, t2));
+			tMax = std::min(tMax, std::max(t1, t2));
+			if (tMin > tMax) {
+				return false;
+			}
+		}
+		t = tMin;
+		return true;
+	}
+
+	Vector3 ClosestPoint(const Vector3& point, const AABB& aabb) {
+		return {
+			std::clamp(point.x, aabb.min.x, aabb.max.x),
+			std::clamp(point.y, aabb.min.y, aabb.max.y),
+			std::clamp(point.z, aabb.min.z, aabb.max.z)
+		};
+	}
+
+	// 三角形上の最近接点 (頂点・辺・面のボロノイ領域で場合分け)
+	Vector3 ClosestPoint(const Vector3& point, const Triangle& triangle) {
+		const Vector3& a = triangle.vertices[0];
+		const Vector3& b = triangle.vertices[1];
+		const Vector3& c = triangle.vertices[2];
+		Vector3 ab = b - a;
+		Vector3 ac = c - a;
+		Vector3 ap = point - a;
+		float d1 = ab.Dot(ap);
+		float d2 = ac.Dot(ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) {
+			return a;
+		}
+		Vector3 bp = point - b;
+		float d3 = ab.Dot(bp);
+		float d4 = ac.Dot(bp);
+		if (d3 >= 0.0f && d4 <= d3) {
+			return b;
+		}
+		float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+			return a + ab * (d1 / (d1 - d3));
+		}
+		Vector3 cp = point - c;
+		float d5 = ab.Dot(cp);
+		float d6 = ac.Dot(cp);
+		if (d6 >= 0.0f && d5 <= d6) {
+			return c;
+		}
+		float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+			return a + ac * (d2 / (d2 - d6));
+		}
+		float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		}
+		float denom = 1.0f / (va + vb + vc);
+		return a + ab * (vb * denom) + ac * (vc * denom);
+	}
+
+	// 中心と最近接点から法線を求める (中心が表面上にあるときは fallback を使う)
+	Vector3 ContactNormal(const Vector3& center, const Vector3& point, const Vector3& fallback) {
+		Vector3 normal = center - point;
+		float lengthSquared = normal.LengthSquared();
+		if (lengthSquared <= kNormalEpsilon) {
+			return fallback;
+		}
+		return normal / std::sqrt(lengthSquared);
+	}
+
+	// 中心が箱の内側にあるときは最も浅い面の法線を使う
+	Vector3 InsideNormal(const Vector3& center, const AABB& aabb) {
+		float distances[6] = {
+			center.x - aabb.min.x, aabb.max.x - center.x,
+			center.y - aabb.min.y, aabb.max.y - center.y,
+			center.z - aabb.min.z, aabb.max.z - center.z
+		};
+		const Vector3 normals[6] = {
+			{ -1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f },
+			{ 0.0f, -1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+			{ 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f, 1.0f }
+		};
+		int best = static_cast<int>(std::min_element(distances, distances + 6) - distances);
+		return normals[best];
+	}
+}
+
+bool Collision::SweepSphere(const Sphere& sphere, const Vector3& motion, const Plane& plane, TimeOfImpact& hit) {
+	float distance = plane.SignedDistance(sphere.center);
+	float side = distance >= 0.0f ? 1.0f : -1.0f;
+	float approach = side * plane.normal.Dot(motion);
+	if (approach >= 0.0f) {
+		return false;
+	}
+
+	float time = (side * distance - sphere.radius) / -approach;
+	if (time > 1.0f) {
+		return false;
+	}
+	hit.time = std::max(time, 0.0f);
+	hit.normal = plane.normal * side;
+	Vector3 center = sphere.center + motion * hit.time;
+	hit.point = center - plane.normal * plane.SignedDistance(center);
+	return true;
+}
+
+bool Collision::SweepSphere(const Sphere& sphere, const Vector3& motion, const AABB& aabb, TimeOfImpact& hit) {
+	// 重なっている場合
+	Vector3 closest = ClosestPoint(sphere.center, aabb);
+	Vector3 offset = sphere.center - closest;
+	if (offset.LengthSquared() <= sphere.radius * sphere.radius) {
+		Vector3 normal = ContactNormal(sphere.center, closest, InsideNormal(sphere.center, aabb));
+		if (normal.Dot(motion) >= 0.0f) {
+			return false;
+		}
+		hit = { 0.0f, closest, normal };
+		return true;
+	}
+
+	// 箱を半径だけ膨らませた形状 = 各軸方向にだけ膨らませた3つの箱 + 12本の辺のカプセル
+	float time = INFINITY;
+	float t;
+	Vector3 extents[3] = {
+		{ sphere.radius, 0.0f, 0.0f },
+		{ 0.0f, sphere.radius, 0.0f },
+		{ 0.0f, 0.0f, sphere.radius }
+	};
+	for (const Vector3& extent : extents) {
+		if (SweepPointBox(sphere.center, motion, aabb.min - extent, aabb.max + extent, t)) {
+			time = std::min(time, t);
+		}
+	}
+	Vector3 corners[8];
+	for (int i = 0; i < 8; ++i) {
+		corners[i] = {
+			(i & 1) ? aabb.max.x : aabb.min.x,
+			(i & 2) ? aabb.max.y : aabb.min.y,
+			(i & 4) ? aabb.max.z : aabb.min.z
+		};
+	}
+	for (int i = 0; i < 8; ++i) {
+		for (int bit = 1; bit < 8; bit <<= 1) {
+			if ((i & bit) == 0 && SweepPointCapsule(sphere.center, motion, corners[i], corners[i | bit], sphere.radius, t)) {
+				time = std::min(time, t);
+			}
+		}
+	}
+	if (time > 1.0f) {
+		return false;
+	}
+
+	Vector3 center = sphere.center + motion * time;
+	hit.time = time;
+	hit.point = ClosestPoint(center, aabb);
+	hit.normal = ContactNormal(center, hit.point, -motion.Normalize());
+	return true;
+}
+
+bool Collision::SweepSphere(const Sphere& sphere, const Vector3& motion, const Triangle& triangle, TimeOfImpact& hit) {
+	const Vector3& v0 = triangle.vertices[0];
+	const Vector3& v1 = triangle.vertices[1];
+	const Vector3& v2 = triangle.vertices[2];
+	Vector3 windingNormal = (v1 - v0).Cross(v2 - v0);
+	Vector3 faceNormal = windingNormal.Normalize();
+	float distance = faceNormal.Dot(sphere.center - v0);
+	// 両面なので球のいる側を表とする
+	if (distance < 0.0f) {
+		faceNormal = -faceNormal;
+		distance = -distance;
+	}
+
+	// 重なっている場合
+	Vector3 closest = ClosestPoint(sphere.center, triangle);
+	if ((sphere.center - closest).LengthSquared() <= sphere.radius * sphere.radius) {
+		Vector3 normal = ContactNormal(sphere.center, closest, faceNormal);
+		if (normal.Dot(motion) >= 0.0f) {
+			return false;
+		}
+		hit = { 0.0f, closest, normal };
+		return true;
+	}
+
+	float time = INFINITY;
+
+	// 面の内側で接触する場合
+	float approach = faceNormal.Dot(motion);
+	if (approach < 0.0f) {
+		float t = (distance - sphere.radius) / -approach;
+		if (t >= 0.0f && t <= 1.0f) {
+			Vector3 point = sphere.center + motion * t - faceNormal * sphere.radius;
+			if ((v1 - v0).Cross(point - v0).Dot(windingNormal) >= 0.0f &&
+				(v2 - v1).Cross(point - v1).Dot(windingNormal) >= 0.0f &&
+				(v0 - v2).Cross(point - v2).Dot(windingNormal) >= 0.0f) {
+				time = t;
+			}
+		}
+	}
+
+	// 辺・頂点で接触する場合
+	if (time == INFINITY) {
+		float t;
+		for (int i = 0; i < 3; ++i) {
+			if (SweepPointCapsule(sphere.center, motion, triangle.vertices[i], triangle.vertices[(i + 1) % 3], sphere.radius, t)) {
+				time = std::min(time, t);
+			}
+		}
+	}
+	if (time > 1.0f) {
+		return false;
+	}
+
+	Vector3 center = sphere.center + motion * time;
+	hit.time = time;
+	hit.point = ClosestPoint(center, triangle);
+	hit.normal = ContactNormal(center, hit.point, faceNormal);
+	return true;
+}
+
+bool Collision::SweepSphere(const Sphere& a, const Vector3& motionA, const Sphere& b, const Vector3& motionB, TimeOfImpact& hit) {
+	// b に対する a の相対運動で、点と半径の和の球の問題にする
+	Vector3 motion = motionA - motionB;
+	float radius = a.radius + b.radius;
+	Vector3 offset = a.center - b.center;
+	if (offset.LengthSquared() <= radius * radius && offset.Dot(motion) >= 0.0f) {
+		return false;
+	}
+	float time;
+	if (!SweepPoint(a.center, motion, b.center, radius, time)) {
+		return false;
+	}
+
+	Vector3 centerA = a.center + motionA * time;
+	Vector3 centerB = b.center + motionB * time;
+	hit.time = time;
+	hit.normal = ContactNormal(centerA, centerB, -motion.Normalize());
+	hit.point = centerB + hit.normal * b.radius;
+	return true;
+}
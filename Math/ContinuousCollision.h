@@ -0,0 +1,20 @@
+#pragma once
+#include "Math.h"
+
+struct TimeOfImpact {
+	float time; //!< 衝突時刻 (移動量に対する割合 0〜1)
+	Vector3 point; //!< 衝突時刻での接触点
+	Vector3 normal; //!< 接触点での法線 (相手から球へ向かう向き)
+};
+
+// 連続衝突判定 (CCD)
+//  球が motion だけ移動する間に最初に接触する時刻を求める
+//  開始時点で既に重なっていて、さらに近づく向きに動いている場合は time = 0 を返す
+//  離れる向きに動いているときは衝突なしとする(押し戻した直後に再び当たらないように)
+namespace Collision {
+	bool SweepSphere(const Sphere& sphere, const Vector3& motion, const Plane& plane, TimeOfImpact& hit);
+	bool SweepSphere(const Sphere& sphere, const Vector3& motion, const AABB& aabb, TimeOfImpact& hit);
+	bool SweepSphere(const Sphere& sphere, const Vector3& motion, const Triangle& triangle, TimeOfImpact& hit);
+	// 両方の球が動く場合 (接触点と法線は球 a 側から見たもの)
+	bool SweepSphere(const Sphere& a, const Vector3& motionA, const Sphere& b, const Vector3& motionB, TimeOfImpact& hit);
+}
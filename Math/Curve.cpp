@@ -0,0 +1,393 @@
+#include "Curve.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "Frustum.h"
+#include "SimdFloat.h"
+
+namespace {
+	const size_t kChunkSize = 4096;
+	// 配列を揃える要素数 (AVXの幅)
+	const size_t kPadding = 8;
+	// FlattenBezier で半分に分ける回数の上限 (1区間 1024 本まで)
+	const int kMaxFlattenDepth = 10;
+
+#if defined(MT3_SIMD_AVX)
+	using FloatN = Simd::Float8;
+	const size_t kLanes = 8;
+#else
+	using FloatN = Simd::Float4;
+	const size_t kLanes = 4;
+#endif
+
+	size_t PaddedSize(size_t count) {
+		return (count + kPadding - 1) / kPadding * kPadding;
+	}
+
+	void ParallelFor(JobSystem* jobSystem, size_t count, const JobSystem::RangeFunction& function) {
+		if (jobSystem == nullptr) {
+			function(0, count);
+			return;
+		}
+		jobSystem->ParallelFor(count, kChunkSize, function);
+	}
+
+	// 点と線分の距離の2乗
+	float DistanceSquaredToSegment(const Vector3& point, const Vector3& start, const Vector3& end) {
+		Vector3 diff = end - start;
+		float lengthSquared = diff.LengthSquared();
+		float t = lengthSquared > 0.0f ? std::clamp((point - start).Dot(diff) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+		return (start + diff * t - point).LengthSquared();
+	}
+
+	// 変換先で制御点が両端を結ぶ線分から tolerance 以内にあるか
+	//  w が 0 以下の点があると凸包で判定できないので、全て 0 以下 (全体がカメラの後ろ) のとき以外は false
+	bool IsFlat(const Vector3* controlPoints, size_t count, const Matrix4x4& matrix, float toleranceSquared) {
+		Vector3 projected[kMaxBezierPoints];
+		size_t behind = 0;
+		for (size_t i = 0; i < count; ++i) {
+			ClipPoint clip = TransformToClip(controlPoints[i], matrix);
+			if (clip.w <= 0.0f) {
+				behind++;
+				continue;
+			}
+			projected[i] = Vector3(clip.x, clip.y, clip.z) / clip.w;
+		}
+		if (behind != 0) {
+			return behind == count;
+		}
+		for (size_t i = 1; i + 1 < count; ++i) {
+			if (DistanceSquaredToSegment(projected[i], projected[0], projected[count - 1]) > toleranceSquared) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Flatten(const Vector3* controlPoints, size_t count, const Matrix4x4& matrix, float toleranceSquared, int depth, std::vector<Vector3>& points) {
+		if (depth == kMaxFlattenDepth || IsFlat(controlPoints, count, matrix, toleranceSquared)) {
+			points.push_back(controlPoints[count - 1]);
+			return;
+		}
+		Vector3 left[kMaxBezierPoints];
+		Vector3 right[kMaxBezierPoints];
+		SplitBezier(controlPoints, count, 0.5f, left, right);
+		Flatten(left, count, matrix, toleranceSquared, depth + 1, points);
+		Flatten(right, count, matrix, toleranceSquared, depth + 1, points);
+	}
+
+	// パラメータを区間の番号と区間の中の t に分ける (範囲の外は両端に収める)
+	void Locate(float parameter, size_t segmentCount, size_t& index, float& t) {
+		assert(segmentCount > 0);
+		float clamped = std::clamp(parameter, 0.0f, static_cast<float>(segmentCount));
+		index = std::min(static_cast<size_t>(clamped), segmentCount - 1);
+		t = clamped - static_cast<float>(index);
+	}
+}
+
+Vector3 EvaluateBezier(const Vector3* controlPoints, size_t count, float t) {
+	assert(count >= 2 && count <= kMaxBezierPoints);
+	Vector3 points[kMaxBezierPoints];
+	for (size_t i = 0; i < count; ++i) {
+		points[i] = controlPoints[i];
+	}
+	for (size_t level = count - 1; level > 0; --level) {
+		for (size_t i = 0; i < level; ++i) {
+			points[i] = Lerp(points[i], points[i + 1], t);
+		}
+	}
+	return points[0];
+}
+
+Vector3 EvaluateBezierTangent(const Vector3* controlPoints, size_t count, float t) {
+	assert(count >= 2 && count <= kMaxBezierPoints);
+	// 微分は隣り合う制御点の差を制御点にした1つ低い次数のベジエ曲線の (count - 1) 倍
+	Vector3 differences[kMaxBezierPoints];
+	for (size_t i = 0; i + 1 < count; ++i) {
+		differences[i] = controlPoints[i + 1] - controlPoints[i];
+	}
+	if (count == 2) {
+		return differences[0];
+	}
+	return EvaluateBezier(differences, count - 1, t) * static_cast<float>(count - 1);
+}
+
+void SplitBezier(const Vector3* controlPoints, size_t count, float t, Vector3* left, Vector3* right) {
+	assert(count >= 2 && count <= kMaxBezierPoints);
+	// right の上で de Casteljau を進めると、各段の先頭が左半分の制御点になり、
+	// 各段の末尾はそれ以降書き換えられずに右半分の制御点として残る
+	for (size_t i = 0; i < count; ++i) {
+		right[i] = controlPoints[i];
+	}
+	left[0] = right[0];
+	for (size_t level = 1; level < count; ++level) {
+		for (size_t i = 0; i < count - level; ++i) {
+			right[i] = Lerp(right[i], right[i + 1], t);
+		}
+		left[level] = right[0];
+	}
+}
+
+void FlattenBezier(const Vector3* controlPoints, size_t count, const Matrix4x4& matrix, float tolerance, std::vector<Vector3>& points) {
+	assert(count >= 2 && count <= kMaxBezierPoints);
+	assert(tolerance > 0.0f);
+	Flatten(controlPoints, count, matrix, tolerance * tolerance, 0, points);
+}
+
+CubicBezier ElevateQuadraticBezier(const Vector3& controlPoint0, const Vector3& controlPoint1, const Vector3& controlPoint2) {
+	const float kTwoThirds = 2.0f / 3.0f;
+	return { {
+		controlPoint0,
+		controlPoint0 + (controlPoint1 - controlPoint0) * kTwoThirds,
+		controlPoint2 + (controlPoint1 - controlPoint2) * kTwoThirds,
+		controlPoint2,
+	} };
+}
+
+Vector3 Evaluate(const CubicBezier& bezier, float t) {
+	float u = 1.0f - t;
+	const Vector3* p = bezier.points;
+	return p[0] * (u * u * u) + p[1] * (3.0f * u * u * t) + p[2] * (3.0f * u * t * t) + p[3] * (t * t * t);
+}
+
+Vector3 EvaluateTangent(const CubicBezier& bezier, float t) {
+	float u = 1.0f - t;
+	const Vector3* p = bezier.points;
+	return (p[1] - p[0]) * (3.0f * u * u) + (p[2] - p[1]) * (6.0f * u * t) + (p[3] - p[2]) * (3.0f * t * t);
+}
+
+void SampleUniform(const CubicBezier& bezier, uint32_t subdivision, Vector3* points) {
+	assert(subdivision >= 1);
+	const Vector3* p = bezier.points;
+	// べき基底 a t^3 + b t^2 + c t + p0 の差分を足していく
+	Vector3 a = p[3] - p[0] + (p[1] - p[2]) * 3.0f;
+	Vector3 b = (p[0] - p[1] * 2.0f + p[2]) * 3.0f;
+	Vector3 c = (p[1] - p[0]) * 3.0f;
+	float h = 1.0f / static_cast<float>(subdivision);
+	float h2 = h * h;
+	float h3 = h2 * h;
+	Vector3 delta1 = a * h3 + b * h2 + c * h;
+	Vector3 delta2 = a * (6.0f * h3) + b * (2.0f * h2);
+	Vector3 delta3 = a * (6.0f * h3);
+
+	Vector3 point = p[0];
+	points[0] = point;
+	for (uint32_t i = 1; i < subdivision; ++i) {
+		point += delta1;
+		delta1 += delta2;
+		delta2 += delta3;
+		points[i] = point;
+	}
+	points[subdivision] = p[3];
+}
+
+size_t CubicBezierBatch::Add(const CubicBezier& bezier) {
+	size_t index = count_;
+	Resize(count_ + 1);
+	Set(index, bezier);
+	return index;
+}
+
+void CubicBezierBatch::Clear() {
+	count_ = 0;
+	for (AlignedVector<float>& array : coordinates_) {
+		array.clear();
+	}
+}
+
+void CubicBezierBatch::Reserve(size_t capacity) {
+	for (AlignedVector<float>& array : coordinates_) {
+		array.reserve(PaddedSize(capacity));
+	}
+}
+
+void CubicBezierBatch::Resize(size_t count) {
+	count_ = count;
+	for (AlignedVector<float>& array : coordinates_) {
+		array.resize(PaddedSize(count), 0.0f);
+	}
+}
+
+CubicBezier CubicBezierBatch::Get(size_t index) const {
+	assert(index < count_);
+	CubicBezier bezier;
+	for (size_t k = 0; k < 4; ++k) {
+		bezier.points[k] = { coordinates_[k * 3][index], coordinates_[k * 3 + 1][index], coordinates_[k * 3 + 2][index] };
+	}
+	return bezier;
+}
+
+void CubicBezierBatch::Set(size_t index, const CubicBezier& bezier) {
+	assert(index < count_);
+	for (size_t k = 0; k < 4; ++k) {
+		coordinates_[k * 3][index] = bezier.points[k].x;
+		coordinates_[k * 3 + 1][index] = bezier.points[k].y;
+		coordinates_[k * 3 + 2][index] = bezier.points[k].z;
+	}
+}
+
+void CubicBezierBatch::Evaluate(const float* parameters, Vector3* positions, Vector3* tangents, JobSystem* jobSystem) const {
+	ParallelFor(jobSystem, PaddedSize(count_), [&](size_t begin, size_t end) {
+		// ベルンシュタイン基底の重みを求めてから軸ごとに足し合わせる
+		alignas(32) float lanesT[kLanes];
+		alignas(32) float outputs[6][kLanes];
+		FloatN one = FloatN::Set(1.0f);
+		FloatN three = FloatN::Set(3.0f);
+		FloatN six = FloatN::Set(6.0f);
+
+		for (size_t i = begin; i < end && i < count_; i += kLanes) {
+			size_t lanes = std::min(kLanes, count_ - i);
+			FloatN t;
+			if (lanes == kLanes) {
+				t = FloatN::LoadUnaligned(&parameters[i]);
+			} else {
+				// 余りのレーンは 0 で埋める (結果は使わない)
+				for (size_t lane = 0; lane < kLanes; ++lane) {
+					lanesT[lane] = lane < lanes ? parameters[i + lane] : 0.0f;
+				}
+				t = FloatN::Load(lanesT);
+			}
+			FloatN u = one - t;
+			FloatN b0 = u * u * u;
+			FloatN b1 = three * u * u * t;
+			FloatN b2 = three * u * t * t;
+			FloatN b3 = t * t * t;
+			FloatN d0 = three * u * u;
+			FloatN d1 = six * u * t;
+			FloatN d2 = three * t * t;
+			for (size_t axis = 0; axis < 3; ++axis) {
+				FloatN p0 = FloatN::Load(&coordinates_[axis][i]);
+				FloatN p1 = FloatN::Load(&coordinates_[3 + axis][i]);
+				FloatN p2 = FloatN::Load(&coordinates_[6 + axis][i]);
+				FloatN p3 = FloatN::Load(&coordinates_[9 + axis][i]);
+				(b0 * p0 + b1 * p1 + b2 * p2 + b3 * p3).Store(outputs[axis]);
+				(d0 * (p1 - p0) + d1 * (p2 - p1) + d2 * (p3 - p2)).Store(outputs[3 + axis]);
+			}
+
+			for (size_t lane = 0; lane < lanes; ++lane) {
+				positions[i + lane] = { outputs[0][lane], outputs[1][lane], outputs[2][lane] };
+			}
+			if (tangents != nullptr) {
+				for (size_t lane = 0; lane < lanes; ++lane) {
+					tangents[i + lane] = { outputs[3][lane], outputs[4][lane], outputs[5][lane] };
+				}
+			}
+		}
+		});
+}
+
+size_t Curve::SegmentCount() const {
+	size_t count = controlPoints.size();
+	switch (type) {
+	case CurveType::kQuadraticBezier:
+		return count >= 3 ? (count - 1) / 2 : 0;
+	case CurveType::kCubicBezier:
+		return count >= 4 ? (count - 1) / 3 : 0;
+	case CurveType::kCatmullRom:
+	case CurveType::kBSpline:
+		return count >= 4 ? count - 3 : 0;
+	}
+	return 0;
+}
+
+CubicBezier Curve::Segment(size_t index) const {
+	assert(index < SegmentCount());
+	const float kOneThird = 1.0f / 3.0f;
+	const float kTwoThirds = 2.0f / 3.0f;
+	const float kOneSixth = 1.0f / 6.0f;
+	const Vector3* p = nullptr;
+	switch (type) {
+	case CurveType::kQuadraticBezier:
+		p = &controlPoints[index * 2];
+		return ElevateQuadraticBezier(p[0], p[1], p[2]);
+	case CurveType::kCubicBezier:
+		p = &controlPoints[index * 3];
+		return { { p[0], p[1], p[2], p[3] } };
+	case CurveType::kCatmullRom:
+		// p1 から p2 までで、端の接線は (p2 - p0) / 2 と (p3 - p1) / 2
+		p = &controlPoints[index];
+		return { { p[1], p[1] + (p[2] - p[0]) * kOneSixth, p[2] - (p[3] - p[1]) * kOneSixth, p[2] } };
+	case CurveType::kBSpline:
+		p = &controlPoints[index];
+		return { {
+			(p[0] + p[1] * 4.0f + p[2]) * kOneSixth,
+			p[1] * kTwoThirds + p[2] * kOneThird,
+			p[1] * kOneThird + p[2] * kTwoThirds,
+			(p[1] + p[2] * 4.0f + p[3]) * kOneSixth,
+		} };
+	}
+	return {};
+}
+
+Vector3 Curve::Evaluate(float parameter) const {
+	size_t index;
+	float t;
+	Locate(parameter, SegmentCount(), index, t);
+	return ::Evaluate(Segment(index), t);
+}
+
+Vector3 Curve::Tangent(float parameter) const {
+	size_t index;
+	float t;
+	Locate(parameter, SegmentCount(), index, t);
+	return EvaluateTangent(Segment(index), t);
+}
+
+void Curve::Sample(uint32_t subdivision, std::vector<Vector3>& points) const {
+	size_t segmentCount = SegmentCount();
+	assert(segmentCount > 0 && subdivision >= 1);
+	points.resize(segmentCount * subdivision + 1);
+	// 区間の終点は次の区間の始点と同じなので上書きしてよい
+	for (size_t segment = 0; segment < segmentCount; ++segment) {
+		SampleUniform(Segment(segment), subdivision, &points[segment * subdivision]);
+	}
+}
+
+void Curve::Flatten(const Matrix4x4& matrix, float tolerance, std::vector<Vector3>& points) const {
+	size_t segmentCount = SegmentCount();
+	assert(segmentCount > 0);
+	points.clear();
+	points.push_back(Segment(0).points[0]);
+	for (size_t segment = 0; segment < segmentCount; ++segment) {
+		FlattenBezier(Segment(segment).points, 4, matrix, tolerance, points);
+	}
+}
+
+void ArcLengthTable::Build(const Curve& curve, uint32_t samplesPerSegment) {
+	assert(samplesPerSegment >= 1);
+	samplesPerSegment_ = samplesPerSegment;
+	distances_.clear();
+	if (curve.SegmentCount() == 0) {
+		return;
+	}
+	std::vector<Vector3> points;
+	curve.Sample(samplesPerSegment, points);
+	distances_.resize(points.size());
+	distances_[0] = 0.0f;
+	for (size_t k = 1; k < points.size(); ++k) {
+		distances_[k] = distances_[k - 1] + (points[k] - points[k - 1]).Length();
+	}
+}
+
+float ArcLengthTable::ParameterAt(float distance) const {
+	if (distances_.size() < 2) {
+		return 0.0f;
+	}
+	float clamped = std::clamp(distance, 0.0f, Length());
+	// clamped を超える最初のサンプルとその1つ前の間にある
+	size_t upper = static_cast<size_t>(std::upper_bound(distances_.begin(), distances_.end(), clamped) - distances_.begin());
+	size_t k = std::min(upper, distances_.size() - 1) - 1;
+	float span = distances_[k + 1] - distances_[k];
+	float fraction = span > 0.0f ? std::clamp((clamped - distances_[k]) / span, 0.0f, 1.0f) : 0.0f;
+	return (static_cast<float>(k) + fraction) / static_cast<float>(samplesPerSegment_);
+}
+
+float ArcLengthTable::DistanceAt(float parameter) const {
+	if (distances_.size() < 2) {
+		return 0.0f;
+	}
+	float sample = std::clamp(parameter * static_cast<float>(samplesPerSegment_), 0.0f, static_cast<float>(distances_.size() - 1));
+	size_t k = std::min(static_cast<size_t>(sample), distances_.size() - 2);
+	float fraction = sample - static_cast<float>(k);
+	return distances_[k] + (distances_[k + 1] - distances_[k]) * fraction;
+}
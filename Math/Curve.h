@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+#include "AlignedAllocator.h"
+#include "JobSystem.h"
+
+// 任意次数のベジエ曲線 (制御点 count 個で count - 1 次、count は 2 以上 kMaxBezierPoints 以下)
+const size_t kMaxBezierPoints = 16;
+
+// de Casteljau のアルゴリズムで点と接線 (t での微分) を求める
+Vector3 EvaluateBezier(const Vector3* controlPoints, size_t count, float t);
+Vector3 EvaluateBezierTangent(const Vector3* controlPoints, size_t count, float t);
+// t の位置で2つのベジエ曲線に分ける (left, right はそれぞれ count 個)
+void SplitBezier(const Vector3* controlPoints, size_t count, float t, Vector3* left, Vector3* right);
+// 折れ線と曲線のずれが tolerance 以下になるまで半分に分け、終点側の点を順に points に追加する (始点は追加しない)
+//  ずれは matrix で変換して w で割った先で測る (ビュープロジェクション * ビューポート行列ならピクセル、単位行列ならワールドの長さ)
+//  変換先で曲線は制御点の凸包に収まるので、制御点と両端を結ぶ線分の距離で判定する
+void FlattenBezier(const Vector3* controlPoints, size_t count, const Matrix4x4& matrix, float tolerance, std::vector<Vector3>& points);
+
+// 3次ベジエ曲線の1区間 (Curve の区間は全てこの形にしてから扱う)
+struct CubicBezier {
+	Vector3 points[4]; //!< 制御点
+};
+
+// 2次ベジエ曲線を同じ形の3次ベジエ曲線にする
+CubicBezier ElevateQuadraticBezier(const Vector3& controlPoint0, const Vector3& controlPoint1, const Vector3& controlPoint2);
+
+Vector3 Evaluate(const CubicBezier& bezier, float t);
+Vector3 EvaluateTangent(const CubicBezier& bezier, float t);
+// subdivision 等分した subdivision + 1 個の点を前進差分で求める (終点はぴったり制御点にする)
+void SampleUniform(const CubicBezier& bezier, uint32_t subdivision, Vector3* points);
+
+// 多数の3次ベジエ曲線を SoA で保持し、点と接線を SIMD でまとめて求める (曲線に沿って動く大量のエージェント用)
+class CubicBezierBatch {
+public:
+	size_t Add(const CubicBezier& bezier);
+	void Clear();
+	void Reserve(size_t capacity);
+	size_t Size() const { return count_; }
+
+	CubicBezier Get(size_t index) const;
+	void Set(size_t index, const CubicBezier& bezier);
+
+	// positions[i] と tangents[i] は i 番目の曲線の parameters[i] での値 (tangents は nullptr でもよい。jobSystem があれば並列)
+	void Evaluate(const float* parameters, Vector3* positions, Vector3* tangents, JobSystem* jobSystem = nullptr) const;
+
+private:
+	void Resize(size_t count);
+
+	size_t count_ = 0;
+	// 制御点 k の x, y, z を coordinates_[k * 3], [k * 3 + 1], [k * 3 + 2] に並べる (SIMDの幅の倍数まで 0 で埋めてある)
+	AlignedVector<float> coordinates_[12];
+};
+
+enum class CurveType {
+	kQuadraticBezier, //!< 2次ベジエ曲線をつないだもの (制御点 2n + 1 個で n 区間)
+	kCubicBezier, //!< 3次ベジエ曲線をつないだもの (制御点 3n + 1 個で n 区間)
+	kCatmullRom, //!< 一様 Catmull-Rom スプライン (制御点 n + 3 個で n 区間。両端以外の制御点を通る)
+	kBSpline, //!< 一様3次 B スプライン (制御点 n + 3 個で n 区間。制御点は通らない)
+};
+
+// 制御点の並びで表す区分的な曲線
+//  パラメータは 0 ～ SegmentCount() で、整数部が区間、小数部が区間の中の t
+struct Curve {
+	CurveType type; //!< 種類
+	std::vector<Vector3> controlPoints; //!< 制御点
+
+	size_t SegmentCount() const;
+	// index 番目の区間を3次ベジエ曲線にしたもの
+	CubicBezier Segment(size_t index) const;
+
+	Vector3 Evaluate(float parameter) const;
+	Vector3 Tangent(float parameter) const;
+	// 区間ごとに subdivision 等分した SegmentCount() * subdivision + 1 個の点
+	void Sample(uint32_t subdivision, std::vector<Vector3>& points) const;
+	// 始点と、FlattenBezier と同じ基準でずれが tolerance 以下になる折れ線の点
+	void Flatten(const Matrix4x4& matrix, float tolerance, std::vector<Vector3>& points) const;
+};
+
+// 始点からの弧長を曲線のパラメータに直す表 (一定の速さで曲線に沿って動かすとき用)
+//  区間ごとに samplesPerSegment 等分した折れ線の長さを累積し、その間は線形に補間する
+class ArcLengthTable {
+public:
+	ArcLengthTable() = default;
+	explicit ArcLengthTable(const Curve& curve, uint32_t samplesPerSegment = 32) { Build(curve, samplesPerSegment); }
+
+	void Build(const Curve& curve, uint32_t samplesPerSegment = 32);
+
+	float Length() const { return distances_.empty() ? 0.0f : distances_.back(); }
+	// 始点から distance 進んだ点のパラメータ (0 ～ Length() の外は両端に収める)
+	float ParameterAt(float distance) const;
+	// parameter の点までの弧長
+	float DistanceAt(float parameter) const;
+
+private:
+	std::vector<float> distances_; //!< k 番目のサンプル (パラメータ k / samplesPerSegment_) までの長さ
+	uint32_t samplesPerSegment_ = 0;
+};
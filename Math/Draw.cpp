@@ -0,0 +1,467 @@
+#include "Draw.h"
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "Frustum.h"
+#include "WireframeCache.h"
+#include "Profiler.h"
+
+namespace {
+	LineBatch* currentBatch = nullptr;
+
+	LodSettings lodSettings;
+	bool lodEnabled = false;
+	std::atomic<uint64_t> lodLines = 0;
+	std::atomic<uint64_t> lodSavedLines = 0;
+
+	// 分割数 subdivision の球の線分の数 (WireframeCache の並びと同じ)
+	size_t SphereLineCount(uint32_t subdivision) {
+		return static_cast<size_t>(subdivision + 1) * (subdivision + 1) * 2;
+	}
+
+	// LOD で選んだ分割数で描いた線分の数と、上限の分割数で描いた場合の数を記録する
+	void RecordLod(size_t lines, size_t maxLines) {
+		lodLines.fetch_add(lines, std::memory_order_relaxed);
+		lodSavedLines.fetch_add(maxLines - lines, std::memory_order_relaxed);
+		MT3_PROFILE_COUNTER("Lines saved by LOD", maxLines - lines);
+	}
+
+	enum class Visibility {
+		kCulled, //!< 視錐台の外 (何も描かない)
+		kVisible, //!< 全体が近クリップ面より奥 (そのまま変換してよい)
+		kClipped, //!< 近クリップ面をまたぐ (線分ごとに切ってから変換する)
+	};
+
+	// 直前に使ったビュープロジェクション行列の視錐台 (同じ行列で続けて描くので使い回す)
+	const Frustum& GetFrustum(const Matrix4x4& viewProjectionMatrix) {
+		thread_local Matrix4x4 cachedMatrix;
+		thread_local Frustum cachedFrustum;
+		thread_local bool cached = false;
+		if (!cached || std::memcmp(&cachedMatrix, &viewProjectionMatrix, sizeof(Matrix4x4)) != 0) {
+			cachedMatrix = viewProjectionMatrix;
+			cachedFrustum = MakeFrustum(viewProjectionMatrix);
+			cached = true;
+		}
+		return cachedFrustum;
+	}
+
+	// bounds は描く線分を全て含む球か AABB
+	template<typename Bounds>
+	Visibility Classify(const Bounds& bounds, const Matrix4x4& viewProjectionMatrix) {
+		const Frustum& frustum = GetFrustum(viewProjectionMatrix);
+		if (!Collision::isCollision(frustum, bounds)) {
+			MT3_PROFILE_COUNTER("Draw culled", 1);
+			return Visibility::kCulled;
+		}
+		if (CrossesNearPlane(frustum, bounds)) {
+			MT3_PROFILE_COUNTER("Draw clipped", 1);
+			return Visibility::kClipped;
+		}
+		return Visibility::kVisible;
+	}
+
+	AABB MakeBounds(const Vector3* points, size_t count) {
+		AABB bounds = { points[0], points[0] };
+		for (size_t i = 1; i < count; ++i) {
+			bounds.min = { std::fmin(bounds.min.x, points[i].x), std::fmin(bounds.min.y, points[i].y), std::fmin(bounds.min.z, points[i].z) };
+			bounds.max = { std::fmax(bounds.max.x, points[i].x), std::fmax(bounds.max.y, points[i].y), std::fmax(bounds.max.z, points[i].z) };
+		}
+		return bounds;
+	}
+
+	// ワールド座標の線分を同次座標で近クリップ面に切ってからスクリーン座標にして追加する
+	void AddClippedLine(LineBatch& batch, const Vector3& start, const Vector3& end, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
+		ClipPoint clipStart = TransformToClip(start, viewProjectionMatrix);
+		ClipPoint clipEnd = TransformToClip(end, viewProjectionMatrix);
+		if (!ClipToNearPlane(clipStart, clipEnd)) {
+			return;
+		}
+		Vector3 screenStart = Transform(Vector3(clipStart.x, clipStart.y, clipStart.z) / clipStart.w, viewportMatrix);
+		Vector3 screenEnd = Transform(Vector3(clipEnd.x, clipEnd.y, clipEnd.z) / clipEnd.w, viewportMatrix);
+		batch.Add(
+			static_cast<int>(screenStart.x),
+			static_cast<int>(screenStart.y),
+			static_cast<int>(screenEnd.x),
+			static_cast<int>(screenEnd.y),
+			color
+		);
+	}
+}
+
+void Draw::SetLineBatch(LineBatch* batch) {
+	currentBatch = batch;
+}
+
+LineBatch* Draw::GetLineBatch() {
+	return currentBatch;
+}
+
+void Draw::SetLodSettings(const LodSettings& settings) {
+	assert(settings.maxScreenError > 0.0f);
+	assert(settings.minSphereSubdivision >= 3 && settings.minSphereSubdivision <= settings.maxSphereSubdivision);
+	assert(settings.minBezierSubdivision >= 1 && settings.minBezierSubdivision <= settings.maxBezierSubdivision);
+	lodSettings = settings;
+	lodEnabled = true;
+}
+
+void Draw::DisableLod() {
+	lodEnabled = false;
+}
+
+LodStats Draw::GetLodStats() {
+	return { lodLines.load(std::memory_order_relaxed), lodSavedLines.load(std::memory_order_relaxed) };
+}
+
+void Draw::ResetLodStats() {
+	lodLines.store(0, std::memory_order_relaxed);
+	lodSavedLines.store(0, std::memory_order_relaxed);
+}
+
+void Draw::DrawGrid(const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix) {
+	MT3_PROFILE_ZONE("Draw::DrawGrid");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr) {
+		return;
+	}
+	const float kGridHalfWidth = 2.0f;
+	const uint32_t kSubdivision = 10;
+	const float kGridEvery = (kGridHalfWidth * 2.0f) / static_cast<float>(kSubdivision);
+	const float kGridHalfLength = kGridEvery * 0.5f * static_cast<int>(kSubdivision);
+	const uint32_t kLineCount = (kSubdivision + 1) * 2;
+
+	AABB bounds = { { -kGridHalfLength, 0.0f, -kGridHalfLength }, { kGridHalfLength, 0.0f, kGridHalfLength } };
+	Visibility visibility = Classify(bounds, viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+
+	// 始点と終点を交互に並べて一括で変換する
+	Vector3 points[kLineCount * 2];
+	for (uint32_t index = 0; index <= kSubdivision; ++index) {
+		float offset = kGridEvery * static_cast<float>(index) - kGridHalfWidth;
+		points[index * 2] = { offset,0.0f,kGridHalfLength };
+		points[index * 2 + 1] = { offset,0.0f,-kGridHalfLength };
+		points[(kSubdivision + 1 + index) * 2] = { kGridHalfLength,0.0f,offset };
+		points[(kSubdivision + 1 + index) * 2 + 1] = { -kGridHalfLength,0.0f,offset };
+	}
+	auto lineColor = [&](uint32_t line) { return line % (kSubdivision + 1) == kSubdivision / 2 ? 0x222222ffu : 0xaaaaaaffu; };
+	if (visibility == Visibility::kClipped) {
+		for (uint32_t line = 0; line < kLineCount; ++line) {
+			AddClippedLine(*batch, points[line * 2], points[line * 2 + 1], viewProjectionMatrix, viewportMatrix, lineColor(line));
+		}
+		return;
+	}
+	TransformPoints(points, points, kLineCount * 2, viewProjectionMatrix * viewportMatrix);
+
+	for (uint32_t line = 0; line < kLineCount; ++line) {
+		const Vector3& start = points[line * 2];
+		const Vector3& end = points[line * 2 + 1];
+		batch->Add(
+			static_cast<int>(start.x),
+			static_cast<int>(start.y),
+			static_cast<int>(end.x),
+			static_cast<int>(end.y),
+			lineColor(line)
+		);
+	}
+}
+
+void Draw::DrawSphere(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState) {
+	DrawSphere<FastMath::Exact>(sphere, viewProjectionMatrix, viewportMatrix, color, lodState);
+}
+
+template<typename Precision>
+void Draw::DrawSphere(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState) {
+	MT3_PROFILE_ZONE("Draw::DrawSphere");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr) {
+		return;
+	}
+	Visibility visibility = Classify(sphere, viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+	// 近クリップ面をまたぐときは画面上の大きさが決まらないので上限の分割数で描く
+	uint32_t subdivision = lodSettings.maxSphereSubdivision;
+	if (lodEnabled && visibility == Visibility::kVisible) {
+		float required = RequiredSphereSubdivision(ProjectedSphereRadius(sphere, viewProjectionMatrix, viewportMatrix), lodSettings.maxScreenError);
+		subdivision = SelectSubdivision(required, lodSettings.minSphereSubdivision, lodSettings.maxSphereSubdivision, lodSettings.hysteresis, lodState);
+	}
+	if (lodEnabled) {
+		RecordLod(SphereLineCount(subdivision), SphereLineCount(lodSettings.maxSphereSubdivision));
+	}
+	const WireframeMesh& mesh = GetUnitSphereWireframe(subdivision);
+
+	// 単位球を拡大・移動してから一括で変換する
+	thread_local std::vector<Vector3> vertices;
+	vertices.resize(mesh.vertices.size());
+	for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+		vertices[i] = mesh.vertices[i] * sphere.radius + sphere.center;
+	}
+	if (visibility == Visibility::kClipped) {
+		for (size_t i = 0; i < mesh.indices.size(); i += 2) {
+			AddClippedLine(*batch, vertices[mesh.indices[i]], vertices[mesh.indices[i + 1]], viewProjectionMatrix, viewportMatrix, color);
+		}
+		return;
+	}
+	TransformPoints<Precision>(vertices.data(), vertices.data(), vertices.size(), viewProjectionMatrix * viewportMatrix);
+
+	for (size_t i = 0; i < mesh.indices.size(); i += 2) {
+		const Vector3& start = vertices[mesh.indices[i]];
+		const Vector3& end = vertices[mesh.indices[i + 1]];
+		batch->Add(
+			static_cast<int>(start.x),
+			static_cast<int>(start.y),
+			static_cast<int>(end.x),
+			static_cast<int>(end.y),
+			color
+		);
+	}
+}
+
+template void Draw::DrawSphere<FastMath::Exact>(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState);
+template void Draw::DrawSphere<FastMath::Precise>(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState);
+template void Draw::DrawSphere<FastMath::Fast>(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState);
+
+void Draw::DrawPlane(const Plane& plane, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
+	MT3_PROFILE_ZONE("Draw::DrawPlane");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr) {
+		return;
+	}
+	Vector3 center = plane.normal * plane.distance;
+	Vector3 perpendiculars[4];
+	perpendiculars[0] = plane.normal.Perpendicular().Normalize();
+	perpendiculars[1] = { -perpendiculars[0].x,-perpendiculars[0].y,-perpendiculars[0].z };
+	perpendiculars[2] = plane.normal.Cross(perpendiculars[0]);
+	perpendiculars[3] = { -perpendiculars[2].x,-perpendiculars[2].y,-perpendiculars[2].z };
+
+	Vector3 points[4];
+	for (int32_t index = 0; index < 4; ++index) {
+		Vector3 extend = perpendiculars[index] * 2.0f;
+		points[index] = center + extend;
+	}
+	Visibility visibility = Classify(MakeBounds(points, 4), viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+
+	const int32_t kEdges[4][2] = { { 0,2 },{ 1,3 },{ 2,1 },{ 3,0 } };
+	if (visibility == Visibility::kClipped) {
+		for (const auto& edge : kEdges) {
+			AddClippedLine(*batch, points[edge[0]], points[edge[1]], viewProjectionMatrix, viewportMatrix, color);
+		}
+		return;
+	}
+	TransformPoints(points, points, 4, viewProjectionMatrix * viewportMatrix);
+
+	for (const auto& edge : kEdges) {
+		batch->Add(
+			static_cast<int>(points[edge[0]].x),
+			static_cast<int>(points[edge[0]].y),
+			static_cast<int>(points[edge[1]].x),
+			static_cast<int>(points[edge[1]].y),
+			color
+		);
+	}
+}
+
+void Draw::DrawSegment(const Segment& segment, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
+	MT3_PROFILE_ZONE("Draw::DrawSegment");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr) {
+		return;
+	}
+	Vector3 points[2] = { segment.origin, segment.origin + segment.diff };
+	Visibility visibility = Classify(MakeBounds(points, 2), viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+	if (visibility == Visibility::kClipped) {
+		AddClippedLine(*batch, points[0], points[1], viewProjectionMatrix, viewportMatrix, color);
+		return;
+	}
+	TransformPoints(points, points, 2, viewProjectionMatrix * viewportMatrix);
+	batch->Add(
+		static_cast<int>(points[0].x),
+		static_cast<int>(points[0].y),
+		static_cast<int>(points[1].x),
+		static_cast<int>(points[1].y),
+		color
+	);
+}
+
+void Draw::DrawTriangle(const Triangle& triangle, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
+	MT3_PROFILE_ZONE("Draw::DrawTriangle");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr) {
+		return;
+	}
+	Visibility visibility = Classify(MakeBounds(triangle.vertices, 3), viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+	if (visibility == Visibility::kClipped) {
+		for (int32_t i = 0; i < 3; ++i) {
+			AddClippedLine(*batch, triangle.vertices[i], triangle.vertices[(i + 1) % 3], viewProjectionMatrix, viewportMatrix, color);
+		}
+		return;
+	}
+	Vector3 points[3];
+	TransformPoints(triangle.vertices, points, 3, viewProjectionMatrix * viewportMatrix);
+	const Vector3& a = points[0];
+	const Vector3& b = points[1];
+	const Vector3& c = points[2];
+
+	batch->Add(
+		static_cast<int>(a.x),
+		static_cast<int>(a.y),
+		static_cast<int>(b.x),
+		static_cast<int>(b.y),
+		color
+	);
+	batch->Add(
+		static_cast<int>(b.x),
+		static_cast<int>(b.y),
+		static_cast<int>(c.x),
+		static_cast<int>(c.y),
+		color
+	);
+	batch->Add(
+		static_cast<int>(c.x),
+		static_cast<int>(c.y),
+		static_cast<int>(a.x),
+		static_cast<int>(a.y),
+		color
+	);
+}
+
+void Draw::DrawAABB(const AABB& aabb, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
+	MT3_PROFILE_ZONE("Draw::DrawAABB");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr) {
+		return;
+	}
+	Visibility visibility = Classify(aabb, viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+	Vector3 vertices[8] = {
+		{ aabb.min.x, aabb.min.y, aabb.min.z },
+		{ aabb.min.x, aabb.min.y, aabb.max.z },
+		{ aabb.max.x, aabb.min.y, aabb.max.z },
+		{ aabb.max.x, aabb.min.y, aabb.min.z },
+		{ aabb.min.x, aabb.max.y, aabb.min.z },
+		{ aabb.min.x, aabb.max.y, aabb.max.z },
+		{ aabb.max.x, aabb.max.y, aabb.max.z },
+		{ aabb.max.x, aabb.max.y, aabb.min.z }
+	};
+
+	// 下面、上面、側面の順に辺の頂点番号を並べる
+	const int32_t kEdges[12][2] = {
+		{ 0,1 },{ 1,2 },{ 2,3 },{ 3,0 },
+		{ 4,5 },{ 5,6 },{ 6,7 },{ 7,4 },
+		{ 0,4 },{ 1,5 },{ 2,6 },{ 3,7 }
+	};
+	if (visibility == Visibility::kClipped) {
+		for (const auto& edge : kEdges) {
+			AddClippedLine(*batch, vertices[edge[0]], vertices[edge[1]], viewProjectionMatrix, viewportMatrix, color);
+		}
+		return;
+	}
+	TransformPoints(vertices, vertices, 8, viewProjectionMatrix * viewportMatrix);
+	for (int32_t i = 0; i < 12; ++i) {
+		const Vector3& start = vertices[kEdges[i][0]];
+		const Vector3& end = vertices[kEdges[i][1]];
+		batch->Add(
+			static_cast<int>(start.x),
+			static_cast<int>(start.y),
+			static_cast<int>(end.x),
+			static_cast<int>(end.y),
+			color
+		);
+	}
+}
+
+void Draw::DrawBezier(const Vector3& controlPoint0, const Vector3& contorlPoint1, const Vector3& contorlPoint2, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState) {
+	MT3_PROFILE_ZONE("Draw::DrawBezier");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr) {
+		return;
+	}
+	// 曲線は制御点の凸包に収まる
+	Vector3 controlPoints[3] = { controlPoint0, contorlPoint1, contorlPoint2 };
+	Visibility visibility = Classify(MakeBounds(controlPoints, 3), viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+	uint32_t subdivision = lodSettings.maxBezierSubdivision;
+	if (lodEnabled && visibility == Visibility::kVisible) {
+		float deviation = ProjectedBezierDeviation(controlPoint0, contorlPoint1, contorlPoint2, viewProjectionMatrix, viewportMatrix);
+		float required = RequiredBezierSubdivision(deviation, lodSettings.maxScreenError);
+		subdivision = SelectSubdivision(required, lodSettings.minBezierSubdivision, lodSettings.maxBezierSubdivision, lodSettings.hysteresis, lodState);
+	}
+	if (lodEnabled) {
+		RecordLod(subdivision, lodSettings.maxBezierSubdivision);
+	}
+	thread_local std::vector<Vector3> points;
+	points.resize(subdivision + 1);
+	SampleUniform(ElevateQuadraticBezier(controlPoint0, contorlPoint1, contorlPoint2), subdivision, points.data());
+	if (visibility == Visibility::kClipped) {
+		for (uint32_t i = 0; i < subdivision; ++i) {
+			AddClippedLine(*batch, points[i], points[i + 1], viewProjectionMatrix, viewportMatrix, color);
+		}
+		return;
+	}
+	TransformPoints(points.data(), points.data(), points.size(), viewProjectionMatrix * viewportMatrix);
+
+	for (uint32_t i = 0; i < subdivision; ++i) {
+		batch->Add(
+			static_cast<int>(points[i].x),
+			static_cast<int>(points[i].y),
+			static_cast<int>(points[i + 1].x),
+			static_cast<int>(points[i + 1].y),
+			color
+		);
+	}
+}
+
+void Draw::DrawCurve(const Curve& curve, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
+	MT3_PROFILE_ZONE("Draw::DrawCurve");
+	LineBatch* batch = GetLineBatch();
+	if (batch == nullptr || curve.SegmentCount() == 0) {
+		return;
+	}
+	// 曲線は区間ごとの3次ベジエ曲線の制御点の凸包に収まる
+	thread_local std::vector<Vector3> points;
+	points.clear();
+	for (size_t segment = 0; segment < curve.SegmentCount(); ++segment) {
+		CubicBezier bezier = curve.Segment(segment);
+		points.insert(points.end(), bezier.points, bezier.points + 4);
+	}
+	Visibility visibility = Classify(MakeBounds(points.data(), points.size()), viewProjectionMatrix);
+	if (visibility == Visibility::kCulled) {
+		return;
+	}
+	Matrix4x4 viewProjectionViewport = viewProjectionMatrix * viewportMatrix;
+	curve.Flatten(viewProjectionViewport, lodSettings.maxScreenError, points);
+	if (visibility == Visibility::kClipped) {
+		for (size_t i = 0; i + 1 < points.size(); ++i) {
+			AddClippedLine(*batch, points[i], points[i + 1], viewProjectionMatrix, viewportMatrix, color);
+		}
+		return;
+	}
+	TransformPoints(points.data(), points.data(), points.size(), viewProjectionViewport);
+
+	for (size_t i = 0; i + 1 < points.size(); ++i) {
+		batch->Add(
+			static_cast<int>(points[i].x),
+			static_cast<int>(points[i].y),
+			static_cast<int>(points[i + 1].x),
+			static_cast<int>(points[i + 1].y),
+			color
+		);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include "Math.h"
+#include "LineBatch.h"
+#include "Lod.h"
+#include "Curve.h"
+
+namespace Draw {
+	// 線分を追加するバッチを設定する (nullptr なら何も描画しない)
+	//  描画先へは LineBatch::Flush でまとめて流す
+	void SetLineBatch(LineBatch* batch);
+	LineBatch* GetLineBatch();
+
+	// DrawSphere / DrawBezier の分割数を画面上の大きさから選ぶ (設定するまでは常に上限の分割数で描く)
+	//  lodState を渡したものはヒステリシスがかかり、フレームごとに分割数が行き来しない
+	void SetLodSettings(const LodSettings& settings);
+	void DisableLod();
+	// ResetLodStats からの合計
+	LodStats GetLodStats();
+	void ResetLodStats();
+
+	void DrawGrid(const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix);
+	void DrawSphere(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState = nullptr);
+	// 頂点の変換を Precision の精度で行う (FastMath::Exact / Precise / Fast)
+	template<typename Precision>
+	void DrawSphere(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState = nullptr);
+	void DrawPlane(const Plane& plane, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
+	void DrawSegment(const Segment& segment, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
+	void DrawTriangle(const Triangle& triangle, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
+	void DrawAABB(const AABB& aabb, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
+	void DrawBezier(const Vector3& controlPoint0, const Vector3& contorlPoint1, const Vector3& contorlPoint2, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color, LodState* lodState = nullptr);
+	// 画面上で曲線とのずれが LodSettings::maxScreenError ピクセル以下になる折れ線で描く (LOD を設定していなくても使う)
+	void DrawCurve(const Curve& curve, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
+}
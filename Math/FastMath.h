@@ -0,0 +1,168 @@
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include "SimdFloat.h"
+
+// 精度を選べる平方根・逆数・三角関数
+//  呼び出し側はテンプレート引数で精度を選ぶ (Vector3::Length<FastMath::Fast>() など)
+//  Exact   : 標準ライブラリ・割り算と同じ結果
+//  Precise : 相対誤差 1e-6 程度 (推定値 + ニュートン法1回、sin / cos は7次の多項式)
+//  Fast    : 相対誤差 1e-3 程度 (推定値のみ、sin / cos は4〜5次の多項式)
+//  Rsqrt / Reciprocal の Precise / Fast は x > 0 (0 では NaN になる)。Sqrt は 0 も扱える
+//  スカラー版とSIMD版 (Simd::Float4 / Float8) がある
+namespace FastMath {
+	struct Exact {};
+	struct Precise {};
+	struct Fast {};
+
+	template<typename Precision>
+	constexpr bool kIsExact = std::is_same_v<Precision, Exact>;
+
+	// 1 / √x
+	template<typename Precision>
+	float Rsqrt(float x) {
+		if constexpr (kIsExact<Precision>) {
+			return 1.0f / std::sqrt(x);
+		} else {
+#if defined(MT3_SIMD_SSE)
+			float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#elif defined(MT3_SIMD_NEON)
+			float y = vrsqrtes_f32(x);
+			y *= vrsqrtss_f32(x * y, y);
+#else
+			// 指数部を半分にするビット演算で初期値を作り、ニュートン法2回で推定値の精度にする
+			float y = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1));
+			y *= 1.5f - 0.5f * x * y * y;
+			y *= 1.5f - 0.5f * x * y * y;
+#endif
+			if constexpr (std::is_same_v<Precision, Precise>) {
+				y *= 1.5f - 0.5f * x * y * y;
+			}
+			return y;
+		}
+	}
+
+	// 1 / x
+	template<typename Precision>
+	float Reciprocal(float x) {
+		if constexpr (kIsExact<Precision>) {
+			return 1.0f / x;
+		} else {
+#if defined(MT3_SIMD_SSE)
+			float y = _mm_cvtss_f32(_mm_rcp_ss(_mm_set_ss(x)));
+#elif defined(MT3_SIMD_NEON)
+			float y = vrecpes_f32(x);
+			y *= vrecpss_f32(x, y);
+#else
+			float y = 1.0f / x;
+#endif
+			if constexpr (std::is_same_v<Precision, Precise>) {
+				y *= 2.0f - x * y;
+			}
+			return y;
+		}
+	}
+
+	// √x (x * 1/√x で求める)
+	template<typename Precision>
+	float Sqrt(float x) {
+		if constexpr (kIsExact<Precision>) {
+			return std::sqrt(x);
+		} else {
+			return x > 0.0f ? x * Rsqrt<Precision>(x) : 0.0f;
+		}
+	}
+
+	// sin と cos をまとめて求める (範囲の縮約は Simd::SinCos と同じ)
+	template<typename Precision>
+	void SinCos(float x, float& sinResult, float& cosResult) {
+		if constexpr (kIsExact<Precision>) {
+			sinResult = std::sin(x);
+			cosResult = std::cos(x);
+		} else {
+			const float kMagic = 12582912.0f;
+			float q = (x * 0.636619772f + kMagic) - kMagic;
+			float r = x - q * 1.5703125f - q * 4.83751297e-4f - q * 7.54978995e-8f;
+			float r2 = r * r;
+			float sinR;
+			float cosR;
+			if constexpr (std::is_same_v<Precision, Precise>) {
+				sinR = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+				cosR = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568e-2f + r2 * (-1.388731625e-3f + r2 * 2.443315711e-5f));
+			} else {
+				sinR = r + r * r2 * (-1.6666667e-1f + r2 * 8.3333333e-3f);
+				cosR = 1.0f - 0.5f * r2 + r2 * r2 * 4.1666667e-2f;
+			}
+			uint32_t quadrant = static_cast<uint32_t>(static_cast<int32_t>(q)) & 3u;
+			float sinValue = (quadrant & 1u) ? cosR : sinR;
+			float cosValue = (quadrant & 1u) ? sinR : cosR;
+			sinResult = (quadrant & 2u) ? -sinValue : sinValue;
+			cosResult = (quadrant == 1u || quadrant == 2u) ? -cosValue : cosValue;
+		}
+	}
+
+	// SIMD版 (V は Simd::Float4 / Simd::Float8)
+	template<typename Precision, typename V>
+	V Rsqrt(V x) {
+		if constexpr (kIsExact<Precision>) {
+			return V::Set(1.0f) / Sqrt(x);
+		} else {
+			V y = RsqrtEstimate(x);
+			if constexpr (std::is_same_v<Precision, Precise>) {
+				y = y * (V::Set(1.5f) - V::Set(0.5f) * x * y * y);
+			}
+			return y;
+		}
+	}
+
+	template<typename Precision, typename V>
+	V Reciprocal(V x) {
+		if constexpr (kIsExact<Precision>) {
+			return V::Set(1.0f) / x;
+		} else {
+			V y = ReciprocalEstimate(x);
+			if constexpr (std::is_same_v<Precision, Precise>) {
+				y = y * (V::Set(2.0f) - x * y);
+			}
+			return y;
+		}
+	}
+
+	template<typename Precision, typename V>
+	V Sqrt(V x) {
+		if constexpr (kIsExact<Precision>) {
+			return Sqrt(x);
+		} else {
+			V zero = V::Set(0.0f);
+			return Select(Less(zero, x), x * Rsqrt<Precision>(x), zero);
+		}
+	}
+
+	template<typename Precision, typename V>
+	void SinCos(V x, V& sinResult, V& cosResult) {
+		if constexpr (kIsExact<Precision>) {
+			alignas(32) float values[8];
+			alignas(32) float sinValues[8];
+			alignas(32) float cosValues[8];
+			x.Store(values);
+			for (size_t lane = 0; lane < sizeof(V) / sizeof(float); ++lane) {
+				sinValues[lane] = std::sin(values[lane]);
+				cosValues[lane] = std::cos(values[lane]);
+			}
+			sinResult = V::Load(sinValues);
+			cosResult = V::Load(cosValues);
+		} else if constexpr (std::is_same_v<Precision, Precise>) {
+			Simd::SinCos(x, sinResult, cosResult);
+		} else {
+			V r;
+			V quadrant;
+			Simd::SinCosReduce(x, r, quadrant);
+			V r2 = r * r;
+			V sinR = r + r * r2 * (V::Set(-1.6666667e-1f) + r2 * V::Set(8.3333333e-3f));
+			V cosR = V::Set(1.0f) - V::Set(0.5f) * r2 + r2 * r2 * V::Set(4.1666667e-2f);
+			Simd::SinCosSelect(sinR, cosR, quadrant, sinResult, cosResult);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+FixedTimestep::FixedTimestep(float stepTime, uint32_t maxStepsPerFrame)
+	: stepTime_(stepTime), maxStepsPerFrame_(maxStepsPerFrame) {
+	assert(stepTime > 0.0f);
+	assert(maxStepsPerFrame > 0);
+}
+
+void FixedTimestep::SetStepTime(float stepTime) {
+	assert(stepTime > 0.0f);
+	// 補間係数が変わらないよう、貯めた時間は新しい刻み幅で換算し直す
+	accumulator_ = static_cast<double>(stepTime) * Alpha();
+	stepTime_ = stepTime;
+}
+
+void FixedTimestep::SetMaxStepsPerFrame(uint32_t maxStepsPerFrame) {
+	assert(maxStepsPerFrame > 0);
+	maxStepsPerFrame_ = maxStepsPerFrame;
+}
+
+uint32_t FixedTimestep::Advance(float frameTime, const StepFunction& step) {
+	accumulator_ += std::clamp(frameTime, 0.0f, maxFrameTime_);
+
+	uint32_t steps = 0;
+	while (accumulator_ >= stepTime_ && steps < maxStepsPerFrame_) {
+		step(stepTime_);
+		accumulator_ -= stepTime_;
+		simulationTime_ += stepTime_;
+		++stepCount_;
+		++steps;
+	}
+
+	// 上限に達しても残っている分は捨て、刻み幅未満の端数だけ補間用に残す
+	if (accumulator_ >= stepTime_) {
+		double remainder = std::fmod(accumulator_, static_cast<double>(stepTime_));
+		droppedTime_ += accumulator_ - remainder;
+		accumulator_ = remainder;
+	}
+	return steps;
+}
+
+void FixedTimestep::RunSteps(uint64_t count, const StepFunction& step) {
+	for (uint64_t i = 0; i < count; ++i) {
+		step(stepTime_);
+	}
+	// 足し合わせると誤差が溜まるので掛け算で進める
+	simulationTime_ += static_cast<double>(stepTime_) * static_cast<double>(count);
+	stepCount_ += count;
+}
+
+uint64_t FixedTimestep::RunFor(double seconds, const StepFunction& step) {
+	// 刻み幅はfloatなので、ちょうど割り切れる時間が1ステップ足りなくならないよう少し余裕を持たせる
+	uint64_t count = static_cast<uint64_t>(std::floor(seconds / stepTime_ + 1e-3));
+	RunSteps(count, step);
+	return count;
+}
+
+void FixedTimestep::Reset() {
+	accumulator_ = 0.0;
+	simulationTime_ = 0.0;
+	droppedTime_ = 0.0;
+	stepCount_ = 0;
+}
+
+void BallSnapshot::Capture(const BallSystem& balls) {
+	size_t count = balls.Size();
+	positionX_.assign(balls.PositionX(), balls.PositionX() + count);
+	positionY_.assign(balls.PositionY(), balls.PositionY() + count);
+	positionZ_.assign(balls.PositionZ(), balls.PositionZ() + count);
+}
+
+Vector3 BallSnapshot::Interpolate(const BallSystem& balls, size_t index, float alpha) const {
+	Vector3 current = balls.GetPosition(index);
+	if (index >= Size()) {
+		return current;
+	}
+	Vector3 previous = { positionX_[index], positionY_[index], positionZ_[index] };
+	return previous + (current - previous) * alpha;
+}
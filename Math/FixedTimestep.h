@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "Math.h"
+#include "AlignedAllocator.h"
+#include "BallSystem.h"
+
+// 描画のフレーム時間から固定の刻み幅でシミュレーションを進める
+//  経過時間を貯めておき、刻み幅に達した分だけステップを実行する(余りは次のフレームへ持ち越す)
+//  1フレームのステップ数には上限があり、処理が追いつかないときは超えた分の時間を捨てる
+//  (遅れを取り戻そうとしてさらに遅れる悪循環を防ぐ)
+class FixedTimestep {
+public:
+	using StepFunction = std::function<void(float)>;
+
+	explicit FixedTimestep(float stepTime = 1.0f / 240.0f, uint32_t maxStepsPerFrame = 8);
+
+	void SetStepTime(float stepTime);
+	float StepTime() const { return stepTime_; }
+	void SetMaxStepsPerFrame(uint32_t maxStepsPerFrame);
+	uint32_t MaxStepsPerFrame() const { return maxStepsPerFrame_; }
+	// 1フレームの経過時間の上限 (ブレークポイントなどで止まった後に大きく飛ばないように)
+	void SetMaxFrameTime(float maxFrameTime) { maxFrameTime_ = maxFrameTime; }
+
+	// frameTime 秒を貯めて、刻み幅ごとに step(StepTime()) を呼ぶ。戻り値は実行したステップ数
+	uint32_t Advance(float frameTime, const StepFunction& step);
+	// ヘッドレス用: 実時間と関係なく count ステップをそのまま実行する
+	void RunSteps(uint64_t count, const StepFunction& step);
+	// ヘッドレス用: シミュレーション時間で seconds 秒分を実行する。戻り値は実行したステップ数
+	uint64_t RunFor(double seconds, const StepFunction& step);
+	// 貯めた時間と統計を捨てる
+	void Reset();
+
+	// 直前のステップの状態と現在の状態の間の補間係数 (0〜1)
+	float Alpha() const { return static_cast<float>(accumulator_ / stepTime_); }
+	double SimulationTime() const { return simulationTime_; }
+	uint64_t StepCount() const { return stepCount_; }
+	// ステップ数の上限で捨てた時間の合計
+	double DroppedTime() const { return droppedTime_; }
+
+private:
+	float stepTime_;
+	uint32_t maxStepsPerFrame_;
+	float maxFrameTime_ = 0.25f;
+	double accumulator_ = 0.0;
+	double simulationTime_ = 0.0;
+	double droppedTime_ = 0.0;
+	uint64_t stepCount_ = 0;
+};
+
+// 補間描画のために1ステップ前のボールの位置を保持する
+//  ステップの直前に Capture し、描画時に Alpha() で現在の位置との間を補間する
+class BallSnapshot {
+public:
+	void Capture(const BallSystem& balls);
+	size_t Size() const { return positionX_.size(); }
+
+	// index のボールの描画位置 (前回の Capture 後に追加されたボールは現在の位置)
+	Vector3 Interpolate(const BallSystem& balls, size_t index, float alpha) const;
+
+private:
+	AlignedVector<float> positionX_;
+	AlignedVector<float> positionY_;
+	AlignedVector<float> positionZ_;
+};
@@ -0,0 +1,181 @@
+#include "Frustum.h"
+#include <cmath>
+#include "SimdFloat.h"
+
+namespace {
+#if defined(MT3_SIMD_AVX)
+	using FloatN = Simd::Float8;
+	const size_t kLanes = 8;
+#else
+	using FloatN = Simd::Float4;
+	const size_t kLanes = 4;
+#endif
+
+	// a・x + b・y + c・z + d >= 0 を内側とする面を単位法線の Plane にする
+	Plane MakePlane(float a, float b, float c, float d) {
+		float length = std::sqrt(a * a + b * b + c * c);
+		return { { a / length, b / length, c / length }, -d / length };
+	}
+
+	// AABB の中心と半分の大きさ
+	void CenterExtent(const AABB& aabb, Vector3& center, Vector3& extent) {
+		center = (aabb.min + aabb.max) * 0.5f;
+		extent = (aabb.max - aabb.min) * 0.5f;
+	}
+
+	// AABB を面の法線へ投影したときの半径
+	float ProjectedRadius(const Plane& plane, const Vector3& extent) {
+		return std::abs(plane.normal.x) * extent.x + std::abs(plane.normal.y) * extent.y + std::abs(plane.normal.z) * extent.z;
+	}
+
+	// kLanes 個ずつ中心・半径・AABB の半分の大きさを並べて全ての面と比べる
+	//  gather(index, values) で values に x, y, z, 半径, 半分の大きさ x, y, z を取り出す (球は大きさ0、AABB は半径0)
+	template<typename Gather>
+	size_t Cull(const Frustum& frustum, size_t count, uint32_t* visibleIndices, const Gather& gather) {
+		size_t visibleCount = 0;
+		alignas(32) float lanesValues[7][kLanes];
+		float values[7];
+
+		for (size_t begin = 0; begin < count; begin += kLanes) {
+			size_t lanes = count - begin < kLanes ? count - begin : kLanes;
+			for (size_t lane = 0; lane < kLanes; ++lane) {
+				// 余りのレーンは最後の要素で埋める (結果は使わない)
+				gather(begin + (lane < lanes ? lane : lanes - 1), values);
+				for (size_t i = 0; i < 7; ++i) {
+					lanesValues[i][lane] = values[i];
+				}
+			}
+			FloatN cx = FloatN::Load(lanesValues[0]);
+			FloatN cy = FloatN::Load(lanesValues[1]);
+			FloatN cz = FloatN::Load(lanesValues[2]);
+			FloatN sphereRadius = FloatN::Load(lanesValues[3]);
+			FloatN extentX = FloatN::Load(lanesValues[4]);
+			FloatN extentY = FloatN::Load(lanesValues[5]);
+			FloatN extentZ = FloatN::Load(lanesValues[6]);
+			FloatN zero = FloatN::Set(0.0f);
+			FloatN outside = Less(zero, zero);
+
+			for (const Plane& plane : frustum.planes) {
+				FloatN distance = FloatN::Set(plane.normal.x) * cx + FloatN::Set(plane.normal.y) * cy + FloatN::Set(plane.normal.z) * cz -
+					FloatN::Set(plane.distance);
+				FloatN radius = sphereRadius + FloatN::Set(std::abs(plane.normal.x)) * extentX + FloatN::Set(std::abs(plane.normal.y)) * extentY +
+					FloatN::Set(std::abs(plane.normal.z)) * extentZ;
+				outside = Or(outside, Less(distance + radius, zero));
+			}
+
+			uint32_t outsideMask = MoveMask(outside);
+			for (size_t lane = 0; lane < lanes; ++lane) {
+				if ((outsideMask & (1u << lane)) == 0) {
+					visibleIndices[visibleCount++] = static_cast<uint32_t>(begin + lane);
+				}
+			}
+		}
+		return visibleCount;
+	}
+}
+
+Frustum MakeFrustum(const Matrix4x4& viewProjectionMatrix) {
+	// 行ベクトルなのでクリップ座標の各成分は行列の列との内積になる
+	const Matrix4x4& m = viewProjectionMatrix;
+	Frustum frustum;
+	frustum.planes[Frustum::kLeft] = MakePlane(m.m[0][3] + m.m[0][0], m.m[1][3] + m.m[1][0], m.m[2][3] + m.m[2][0], m.m[3][3] + m.m[3][0]);
+	frustum.planes[Frustum::kRight] = MakePlane(m.m[0][3] - m.m[0][0], m.m[1][3] - m.m[1][0], m.m[2][3] - m.m[2][0], m.m[3][3] - m.m[3][0]);
+	frustum.planes[Frustum::kBottom] = MakePlane(m.m[0][3] + m.m[0][1], m.m[1][3] + m.m[1][1], m.m[2][3] + m.m[2][1], m.m[3][3] + m.m[3][1]);
+	frustum.planes[Frustum::kTop] = MakePlane(m.m[0][3] - m.m[0][1], m.m[1][3] - m.m[1][1], m.m[2][3] - m.m[2][1], m.m[3][3] - m.m[3][1]);
+	frustum.planes[Frustum::kNear] = MakePlane(m.m[0][2], m.m[1][2], m.m[2][2], m.m[3][2]);
+	frustum.planes[Frustum::kFar] = MakePlane(m.m[0][3] - m.m[0][2], m.m[1][3] - m.m[1][2], m.m[2][3] - m.m[2][2], m.m[3][3] - m.m[3][2]);
+	return frustum;
+}
+
+size_t CullSpheres(const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visibleIndices) {
+	return Cull(frustum, count, visibleIndices, [spheres](size_t index, float* values) {
+		const Sphere& sphere = spheres[index];
+		values[0] = sphere.center.x;
+		values[1] = sphere.center.y;
+		values[2] = sphere.center.z;
+		values[3] = sphere.radius;
+		values[4] = 0.0f;
+		values[5] = 0.0f;
+		values[6] = 0.0f;
+		});
+}
+
+size_t CullAABBs(const Frustum& frustum, const AABB* aabbs, size_t count, uint32_t* visibleIndices) {
+	return Cull(frustum, count, visibleIndices, [aabbs](size_t index, float* values) {
+		Vector3 center;
+		Vector3 extent;
+		CenterExtent(aabbs[index], center, extent);
+		values[0] = center.x;
+		values[1] = center.y;
+		values[2] = center.z;
+		values[3] = 0.0f;
+		values[4] = extent.x;
+		values[5] = extent.y;
+		values[6] = extent.z;
+		});
+}
+
+bool CrossesNearPlane(const Frustum& frustum, const Sphere& sphere) {
+	return frustum.planes[Frustum::kNear].SignedDistance(sphere.center) < sphere.radius;
+}
+
+bool CrossesNearPlane(const Frustum& frustum, const AABB& aabb) {
+	Vector3 center;
+	Vector3 extent;
+	CenterExtent(aabb, center, extent);
+	const Plane& plane = frustum.planes[Frustum::kNear];
+	return plane.SignedDistance(center) < ProjectedRadius(plane, extent);
+}
+
+ClipPoint TransformToClip(const Vector3& point, const Matrix4x4& matrix) {
+	return {
+		point.x * matrix.m[0][0] + point.y * matrix.m[1][0] + point.z * matrix.m[2][0] + matrix.m[3][0],
+		point.x * matrix.m[0][1] + point.y * matrix.m[1][1] + point.z * matrix.m[2][1] + matrix.m[3][1],
+		point.x * matrix.m[0][2] + point.y * matrix.m[1][2] + point.z * matrix.m[2][2] + matrix.m[3][2],
+		point.x * matrix.m[0][3] + point.y * matrix.m[1][3] + point.z * matrix.m[2][3] + matrix.m[3][3],
+	};
+}
+
+bool ClipToNearPlane(ClipPoint& start, ClipPoint& end) {
+	// z = 0 ちょうどでは透視投影の w も0になるので、わずかに奥で切る
+	const float kEpsilon = 1e-6f;
+	float startDistance = start.z - kEpsilon * start.w;
+	float endDistance = end.z - kEpsilon * end.w;
+	if (startDistance < 0.0f && endDistance < 0.0f) {
+		return false;
+	}
+	if (startDistance >= 0.0f && endDistance >= 0.0f) {
+		return true;
+	}
+
+	float t = startDistance / (startDistance - endDistance);
+	ClipPoint clipped = {
+		start.x + (end.x - start.x) * t,
+		start.y + (end.y - start.y) * t,
+		start.z + (end.z - start.z) * t,
+		start.w + (end.w - start.w) * t,
+	};
+	(startDistance < 0.0f ? start : end) = clipped;
+	return true;
+}
+
+bool Collision::isCollision(const Frustum& frustum, const Sphere& sphere) {
+	for (const Plane& plane : frustum.planes) {
+		if (plane.SignedDistance(sphere.center) < -sphere.radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Collision::isCollision(const Frustum& frustum, const AABB& aabb) {
+	Vector3 center;
+	Vector3 extent;
+	CenterExtent(aabb, center, extent);
+	for (const Plane& plane : frustum.planes) {
+		if (plane.SignedDistance(center) < -ProjectedRadius(plane, extent)) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Math.h"
+
+// ビュープロジェクション行列から取り出した視錐台 (カリング用)
+//  平面の法線は内向きで、内側は plane.SignedDistance(点) >= 0
+//  クリップ空間は MakePerspectiveFovMatrix / MakeOrthographicMatrix と同じ 0 <= z <= w
+struct Frustum {
+	enum PlaneIndex {
+		kLeft,
+		kRight,
+		kBottom,
+		kTop,
+		kNear,
+		kFar,
+		kPlaneCount,
+	};
+
+	Plane planes[kPlaneCount]; //!< 視錐台の面 (単位法線)
+};
+
+Frustum MakeFrustum(const Matrix4x4& viewProjectionMatrix);
+
+// 視錐台の外側と判定されなかったものの番号を visibleIndices に書き、その数を返す
+//  判定は Collision::isCollision(const Frustum&, ...) と同じ
+size_t CullSpheres(const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visibleIndices);
+size_t CullAABBs(const Frustum& frustum, const AABB* aabbs, size_t count, uint32_t* visibleIndices);
+
+// 近クリップ面の手前 (カメラ側) にはみ出しているか
+bool CrossesNearPlane(const Frustum& frustum, const Sphere& sphere);
+bool CrossesNearPlane(const Frustum& frustum, const AABB& aabb);
+
+// クリップ空間 (同次座標) の点
+struct ClipPoint {
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+ClipPoint TransformToClip(const Vector3& point, const Matrix4x4& matrix);
+// 線分を近クリップ面 (z = 0) の奥側に切り詰める。全体が手前側なら false
+//  切った後の点は w > 0 なので透視除算できる
+bool ClipToNearPlane(ClipPoint& start, ClipPoint& end);
+
+namespace Collision {
+	// 視錐台と交わるか (各面について完全に外側かだけを見るので、角の近くでは外側でも true になることがある)
+	bool isCollision(const Frustum& frustum, const Sphere& sphere);
+	bool isCollision(const Frustum& frustum, const AABB& aabb);
+}
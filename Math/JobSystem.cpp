@@ -0,0 +1,132 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+	// ワーカースレッドなら自分のキューのインデックス、それ以外は -1
+	//  インデックスは tOwner の JobSystem のものなので、別の JobSystem の ParallelFor では使わない
+	thread_local int32_t tWorkerIndex = -1;
+	thread_local const JobSystem* tOwner = nullptr;
+}
+
+uint32_t JobSystem::DefaultWorkerCount() {
+	// 呼び出し元のスレッドもジョブを実行するので1つ減らす
+	uint32_t hardware = std::thread::hardware_concurrency();
+	return hardware > 1 ? hardware - 1 : 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount) {
+	for (uint32_t i = 0; i < workerCount + 1; ++i) {
+		queues_.push_back(std::make_unique<WorkQueue>());
+	}
+	workers_.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		workers_.emplace_back(&JobSystem::WorkerMain, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex_);
+		running_ = false;
+	}
+	wakeUp_.notify_all();
+	for (std::thread& worker : workers_) {
+		worker.join();
+	}
+}
+
+void JobSystem::ParallelFor(size_t count, size_t chunkSize, const RangeFunction& function) {
+	if (count == 0) {
+		return;
+	}
+	assert(chunkSize > 0);
+
+	size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+	if (workers_.empty() || chunkCount == 1) {
+		for (size_t begin = 0; begin < count; begin += chunkSize) {
+			function(begin, std::min(begin + chunkSize, count));
+		}
+		return;
+	}
+
+	// チャンクを全キューに順番に配り、偏りはスティーリングで均す
+	std::atomic<size_t> remaining = chunkCount;
+	size_t queueCount = queues_.size();
+	size_t self = tOwner == this && tWorkerIndex >= 0 ? static_cast<size_t>(tWorkerIndex) : queueCount - 1;
+	queuedJobs_ += chunkCount;
+	for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+		size_t begin = chunk * chunkSize;
+		WorkQueue& queue = *queues_[(self + chunk) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back({ &function, begin, std::min(begin + chunkSize, count), &remaining });
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex_);
+	}
+	wakeUp_.notify_all();
+
+	// 待っている間も自分でジョブを実行する
+	while (remaining.load(std::memory_order_acquire) > 0) {
+		if (!TryRunJob(static_cast<uint32_t>(self))) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WorkerMain(uint32_t index) {
+	tWorkerIndex = static_cast<int32_t>(index);
+	tOwner = this;
+	while (true) {
+		if (TryRunJob(index)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex_);
+		wakeUp_.wait(lock, [this] { return !running_ || queuedJobs_.load() > 0; });
+		if (!running_) {
+			return;
+		}
+	}
+}
+
+bool JobSystem::TryRunJob(uint32_t index) {
+	Job job;
+	if (PopLocal(index, job) || Steal(index, job)) {
+		Run(job);
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::PopLocal(uint32_t index, Job& job) {
+	WorkQueue& queue = *queues_[index];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty()) {
+		return false;
+	}
+	job = queue.jobs.back();
+	queue.jobs.pop_back();
+	--queuedJobs_;
+	return true;
+}
+
+bool JobSystem::Steal(uint32_t thief, Job& job) {
+	size_t queueCount = queues_.size();
+	for (size_t offset = 1; offset < queueCount; ++offset) {
+		WorkQueue& queue = *queues_[(thief + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty()) {
+			continue;
+		}
+		job = queue.jobs.front();
+		queue.jobs.pop_front();
+		--queuedJobs_;
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::Run(const Job& job) {
+	(*job.function)(job.begin, job.end);
+	job.remaining->fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ワーカーごとの両端キューとワークスティーリングによる小さなジョブシステム
+//  各ワーカーは自分のキューの末尾から取り出し、空なら他のワーカーのキューの先頭から盗む
+//  ParallelFor の分割はチャンクサイズだけで決まるので、各チャンクが自分の範囲だけを書き換えるなら
+//  スレッド数に関係なく同じ結果になる
+class JobSystem {
+public:
+	using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+	// workerCount が0なら全てのジョブを呼び出し元のスレッドで実行する
+	explicit JobSystem(uint32_t workerCount = DefaultWorkerCount());
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// [0, count) を chunkSize ごとに分割して並列に実行し、全て終わるまで待つ
+	//  呼び出し元のスレッドも待っている間はジョブを実行する
+	void ParallelFor(size_t count, size_t chunkSize, const RangeFunction& function);
+
+	uint32_t WorkerCount() const { return static_cast<uint32_t>(workers_.size()); }
+
+	static uint32_t DefaultWorkerCount();
+
+private:
+	struct Job {
+		const RangeFunction* function; //!< 実行する関数 (ParallelFor の呼び出し元が所有)
+		size_t begin; //!< 範囲の先頭
+		size_t end; //!< 範囲の終端
+		std::atomic<size_t>* remaining; //!< 未完了のジョブ数
+	};
+
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void WorkerMain(uint32_t index);
+	bool TryRunJob(uint32_t index);
+	bool PopLocal(uint32_t index, Job& job);
+	bool Steal(uint32_t thief, Job& job);
+	void Run(const Job& job);
+
+	std::vector<std::thread> workers_;
+	// ワーカー分に加えて末尾に呼び出し元スレッド用のキューを持つ
+	std::vector<std::unique_ptr<WorkQueue>> queues_;
+	std::atomic<size_t> queuedJobs_ = 0;
+	std::atomic<bool> running_ = true;
+	std::mutex sleepMutex_;
+	std::condition_variable wakeUp_;
+};
@@ -0,0 +1,36 @@
+#include "LineBatch.h"
+#include <algorithm>
+#include "Profiler.h"
+
+void LineBatch::SetCullRect(int left, int top, int right, int bottom) {
+	cullEnabled_ = true;
+	cullLeft_ = left;
+	cullTop_ = top;
+	cullRight_ = right;
+	cullBottom_ = bottom;
+}
+
+void LineBatch::Flush(LineSink& sink) {
+	MT3_PROFILE_ZONE("LineBatch::Flush");
+	stats_ = { lines_.size(), 0, 0 };
+
+	if (cullEnabled_) {
+		// 線分は両端の凸包に収まるので、両端が同じ辺の外側なら矩形と交わらない
+		auto end = std::remove_if(lines_.begin(), lines_.end(), [this](const LineCommand& line) {
+			return (line.x1 < cullLeft_ && line.x2 < cullLeft_) ||
+				(line.x1 > cullRight_ && line.x2 > cullRight_) ||
+				(line.y1 < cullTop_ && line.y2 < cullTop_) ||
+				(line.y1 > cullBottom_ && line.y2 > cullBottom_);
+			});
+		stats_.culled = static_cast<size_t>(lines_.end() - end);
+		lines_.erase(end, lines_.end());
+	}
+
+	sink.DrawLines(lines_.data(), lines_.size());
+	stats_.emitted = lines_.size();
+	lines_.clear();
+
+	MT3_PROFILE_COUNTER("Lines submitted", stats_.submitted);
+	MT3_PROFILE_COUNTER("Lines culled", stats_.culled);
+	MT3_PROFILE_COUNTER("Lines emitted", stats_.emitted);
+}
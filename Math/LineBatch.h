@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct LineCommand {
+	int32_t x1; //!< 始点のスクリーン座標X
+	int32_t y1; //!< 始点のスクリーン座標Y
+	int32_t x2; //!< 終点のスクリーン座標X
+	int32_t y2; //!< 終点のスクリーン座標Y
+	uint32_t color; //!< 色 (RGBA)
+};
+
+// LineBatch の描画先
+class LineSink {
+public:
+	virtual ~LineSink() = default;
+	virtual void DrawLine(int x1, int y1, int x2, int y2, uint32_t color) = 0;
+	// まとめて受け取れる描画先は上書きする
+	virtual void DrawLines(const LineCommand* lines, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			DrawLine(lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2, lines[i].color);
+		}
+	}
+};
+
+// 何も描画しない描画先 (描画なしで計測するとき用)
+class NullLineSink : public LineSink {
+public:
+	void DrawLine(int, int, int, int, uint32_t) override {}
+	void DrawLines(const LineCommand*, size_t) override {}
+};
+
+// 受け取った線分をそのまま保持する描画先 (出力の検証用)
+class LineRecorder : public LineSink {
+public:
+	void DrawLine(int x1, int y1, int x2, int y2, uint32_t color) override {
+		lines_.push_back({ x1, y1, x2, y2, color });
+	}
+	void DrawLines(const LineCommand* lines, size_t count) override {
+		lines_.insert(lines_.end(), lines, lines + count);
+	}
+
+	const std::vector<LineCommand>& Lines() const { return lines_; }
+	void Clear() { lines_.clear(); }
+
+private:
+	std::vector<LineCommand> lines_;
+};
+
+struct LineBatchStats {
+	size_t submitted; //!< 追加された線分の数
+	size_t culled; //!< 画面外で捨てた線分の数
+	size_t emitted; //!< 描画先に渡した線分の数
+};
+
+// 線分の描画コマンドを連続した配列に溜め、フレームの最後にまとめて描画先へ流す
+class LineBatch {
+public:
+	void Add(int x1, int y1, int x2, int y2, uint32_t color) {
+		lines_.push_back({ x1, y1, x2, y2, color });
+	}
+	void Reserve(size_t capacity) { lines_.reserve(capacity); }
+	void Clear() { lines_.clear(); }
+
+	size_t Size() const { return lines_.size(); }
+	const LineCommand* Data() const { return lines_.data(); }
+
+	// 両端が矩形の同じ辺の外側にある線分を Flush で捨てる
+	void SetCullRect(int left, int top, int right, int bottom);
+	void DisableCulling() { cullEnabled_ = false; }
+
+	// 溜まった線分を描画先に流して空にする
+	void Flush(LineSink& sink);
+
+	// 直前の Flush の統計
+	const LineBatchStats& LastStats() const { return stats_; }
+
+private:
+	std::vector<LineCommand> lines_;
+	LineBatchStats stats_ = {};
+	bool cullEnabled_ = false;
+	int cullLeft_ = 0;
+	int cullTop_ = 0;
+	int cullRight_ = 0;
+	int cullBottom_ = 0;
+};
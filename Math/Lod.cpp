@@ -0,0 +1,84 @@
+#include "Lod.h"
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include "Frustum.h"
+
+namespace {
+	const float kInfinity = std::numeric_limits<float>::infinity();
+
+	// 行列の列 column の xyz の長さ (ワールドの長さ1がその成分をどれだけ動かすか)
+	float ColumnScale(const Matrix4x4& matrix, int column) {
+		return std::sqrt(matrix.m[0][column] * matrix.m[0][column] + matrix.m[1][column] * matrix.m[1][column] + matrix.m[2][column] * matrix.m[2][column]);
+	}
+
+	// 同次座標の点をスクリーン座標にする
+	Vector3 ToScreen(const ClipPoint& point, const Matrix4x4& viewportMatrix) {
+		return Transform(Vector3(point.x, point.y, point.z) / point.w, viewportMatrix);
+	}
+}
+
+float ProjectedSphereRadius(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix) {
+	ClipPoint center = TransformToClip(sphere.center, viewProjectionMatrix);
+	// 球の中で一番手前の点の w で割って、少し大きめに見積もる
+	float nearestW = center.w - sphere.radius * ColumnScale(viewProjectionMatrix, 3);
+	if (nearestW <= 0.0f) {
+		return kInfinity;
+	}
+	float radiusX = sphere.radius * ColumnScale(viewProjectionMatrix, 0) * std::abs(viewportMatrix.m[0][0]);
+	float radiusY = sphere.radius * ColumnScale(viewProjectionMatrix, 1) * std::abs(viewportMatrix.m[1][1]);
+	return std::fmax(radiusX, radiusY) / nearestW;
+}
+
+float ProjectedBezierDeviation(const Vector3& controlPoint0, const Vector3& controlPoint1, const Vector3& controlPoint2,
+	const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix) {
+	Vector3 middle = controlPoint0 * 0.25f + controlPoint1 * 0.5f + controlPoint2 * 0.25f;
+	ClipPoint start = TransformToClip(controlPoint0, viewProjectionMatrix);
+	ClipPoint end = TransformToClip(controlPoint2, viewProjectionMatrix);
+	ClipPoint center = TransformToClip(middle, viewProjectionMatrix);
+	if (start.w <= 0.0f || end.w <= 0.0f || center.w <= 0.0f) {
+		return kInfinity;
+	}
+	Vector3 screenStart = ToScreen(start, viewportMatrix);
+	Vector3 screenEnd = ToScreen(end, viewportMatrix);
+	Vector3 screenCenter = ToScreen(center, viewportMatrix);
+	float dx = screenCenter.x - (screenStart.x + screenEnd.x) * 0.5f;
+	float dy = screenCenter.y - (screenStart.y + screenEnd.y) * 0.5f;
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+float RequiredSphereSubdivision(float projectedRadius, float maxScreenError) {
+	assert(maxScreenError > 0.0f);
+	if (projectedRadius <= maxScreenError) {
+		return 0.0f;
+	}
+	// 円を n 分割した弦の真ん中は円から r(1 - cos(π / n)) 離れる
+	return std::numbers::pi_v<float> / std::acos(1.0f - maxScreenError / projectedRadius);
+}
+
+float RequiredBezierSubdivision(float deviation, float maxScreenError) {
+	assert(maxScreenError > 0.0f);
+	// 2次ベジエ曲線を n 等分したときのずれは1本のときの 1 / n^2
+	return std::sqrt(deviation / maxScreenError);
+}
+
+uint32_t SelectSubdivision(float required, uint32_t minSubdivision, uint32_t maxSubdivision, float hysteresis, LodState* state) {
+	assert(minSubdivision <= maxSubdivision && hysteresis >= 0.0f);
+	float wanted = required;
+	if (state != nullptr) {
+		float current = static_cast<float>(state->subdivision);
+		float margin = 1.0f + hysteresis;
+		if (state->subdivision != 0 && required <= current && required * margin * margin >= current) {
+			return state->subdivision;
+		}
+		wanted = required * margin;
+	}
+	// 無限大は上限に収めてから整数にする
+	float clamped = std::fmin(std::ceil(wanted), static_cast<float>(maxSubdivision));
+	uint32_t subdivision = clamped > static_cast<float>(minSubdivision) ? static_cast<uint32_t>(clamped) : minSubdivision;
+	if (state != nullptr) {
+		state->subdivision = subdivision;
+	}
+	return subdivision;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include "Math.h"
+
+// 画面上の大きさから曲線を線分に分ける数を選ぶ (Level of Detail)
+//  分割数は線分と本来の曲線のずれが maxScreenError ピクセル以下になる最小の数にする
+struct LodSettings {
+	float maxScreenError = 0.5f; //!< 線分と曲線のずれの許容量 (ピクセル)
+	float hysteresis = 0.15f; //!< 分割数を選び直すときの余裕 (割合)。境目で分割数が行き来しないようにする
+	uint32_t minSphereSubdivision = 4; //!< 球の分割数の下限 (3以上)
+	uint32_t maxSphereSubdivision = 16; //!< 球の分割数の上限 (LOD を使わないときの分割数)
+	uint32_t minBezierSubdivision = 1; //!< ベジエ曲線の分割数の下限
+	uint32_t maxBezierSubdivision = 100; //!< ベジエ曲線の分割数の上限 (LOD を使わないときの分割数)
+};
+
+// 描くものごとに持つ、前のフレームで選んだ分割数 (ヒステリシス用)
+struct LodState {
+	uint32_t subdivision = 0; //!< 前に選んだ分割数 (0 ならまだ選んでいない)
+};
+
+// LOD で減らした線分の数
+struct LodStats {
+	uint64_t lines; //!< LOD で選んだ分割数で追加した線分の数
+	uint64_t savedLines; //!< 上限の分割数で描いた場合と比べて減った線分の数
+};
+
+// 球の画面上の半径 (ピクセル)。カメラの後ろにかかるときは無限大
+float ProjectedSphereRadius(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix);
+// 2次ベジエ曲線の中点が、両端を結んだ線分から画面上で離れている距離 (ピクセル)。カメラの後ろにかかるときは無限大
+float ProjectedBezierDeviation(const Vector3& controlPoint0, const Vector3& controlPoint1, const Vector3& controlPoint2,
+	const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix);
+
+// ずれを maxScreenError 以下にするのに必要な分割数 (小数のまま)
+//  球は半径 projectedRadius の円を経度方向に分けた多角形、ベジエ曲線は1本の線分でのずれ deviation から求める
+float RequiredSphereSubdivision(float projectedRadius, float maxScreenError);
+float RequiredBezierSubdivision(float deviation, float maxScreenError);
+
+// 必要な分割数 required から実際に使う分割数を選ぶ
+//  state があれば、足りないときは hysteresis だけ多めに増やし、(1 + hysteresis)^2 倍より余るまでは減らさない
+uint32_t SelectSubdivision(float required, uint32_t minSubdivision, uint32_t maxSubdivision, float hysteresis, LodState* state);
@@ -1,7 +1,6 @@
 #define NOMINMAX
 #include "Math.h"
 #include <cmath>
-#include <Novice.h>
 #include <numbers>
 #include <algorithm>
 
@@ -84,6 +83,85 @@ Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix) {
 	return result;
 }
 
+void TransformPoints(const Vector3* in, Vector3* out, size_t n, const Matrix4x4& matrix) {
+	TransformPoints<FastMath::Exact>(in, out, n, matrix);
+}
+
+template<typename Precision>
+void TransformPoints(const Vector3* in, Vector3* out, size_t n, const Matrix4x4& matrix) {
+	size_t i = 0;
+#if defined(MT3_SIMD_SSE)
+	// 4頂点ずつSoAに並べ替えて変換する
+	__m128 m00 = _mm_set1_ps(matrix.m[0][0]), m01 = _mm_set1_ps(matrix.m[0][1]), m02 = _mm_set1_ps(matrix.m[0][2]), m03 = _mm_set1_ps(matrix.m[0][3]);
+	__m128 m10 = _mm_set1_ps(matrix.m[1][0]), m11 = _mm_set1_ps(matrix.m[1][1]), m12 = _mm_set1_ps(matrix.m[1][2]), m13 = _mm_set1_ps(matrix.m[1][3]);
+	__m128 m20 = _mm_set1_ps(matrix.m[2][0]), m21 = _mm_set1_ps(matrix.m[2][1]), m22 = _mm_set1_ps(matrix.m[2][2]), m23 = _mm_set1_ps(matrix.m[2][3]);
+	__m128 m30 = _mm_set1_ps(matrix.m[3][0]), m31 = _mm_set1_ps(matrix.m[3][1]), m32 = _mm_set1_ps(matrix.m[3][2]), m33 = _mm_set1_ps(matrix.m[3][3]);
+	for (; i + 4 <= n; i += 4) {
+		const float* src = &in[i].x;
+		__m128 p0 = _mm_loadu_ps(src);
+		__m128 p1 = _mm_loadu_ps(src + 4);
+		__m128 p2 = _mm_loadu_ps(src + 8);
+
+		// (x0 y0 z0 x1)(y1 z1 x2 y2)(z2 x3 y3 z3) -> (x0 x1 x2 x3)(y0 y1 y2 y3)(z0 z1 z2 z3)
+		__m128 s0 = _mm_shuffle_ps(p0, p1, MT3_SHUFFLE_MASK(0, 3, 0, 1));
+		__m128 s1 = _mm_shuffle_ps(p1, p2, MT3_SHUFFLE_MASK(2, 3, 1, 2));
+		__m128 s2 = _mm_shuffle_ps(p0, p1, MT3_SHUFFLE_MASK(1, 2, 0, 1));
+		__m128 x = _mm_shuffle_ps(s0, s1, MT3_SHUFFLE_MASK(0, 1, 0, 2));
+		__m128 y = _mm_shuffle_ps(s2, s1, MT3_SHUFFLE_MASK(0, 2, 1, 3));
+		__m128 z = _mm_shuffle_ps(s2, p2, MT3_SHUFFLE_MASK(1, 3, 0, 3));
+
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20)), m30);
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21)), m31);
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22)), m32);
+		__m128 rw = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m03), _mm_mul_ps(y, m13)), _mm_mul_ps(z, m23)), m33);
+		__m128 invW = FastMath::Reciprocal<Precision>(Simd::Float4{ rw }).v;
+		rx = _mm_mul_ps(rx, invW);
+		ry = _mm_mul_ps(ry, invW);
+		rz = _mm_mul_ps(rz, invW);
+
+		// SoA -> AoS
+		__m128 xy01 = _mm_unpacklo_ps(rx, ry);
+		__m128 xy23 = _mm_unpackhi_ps(rx, ry);
+		__m128 zx01 = _mm_shuffle_ps(rz, rx, MT3_SHUFFLE_MASK(0, 0, 1, 1));
+		__m128 yz11 = _mm_shuffle_ps(ry, rz, MT3_SHUFFLE_MASK(1, 1, 1, 1));
+		__m128 zx23 = _mm_shuffle_ps(rz, rx, MT3_SHUFFLE_MASK(2, 2, 3, 3));
+		__m128 yz33 = _mm_shuffle_ps(ry, rz, MT3_SHUFFLE_MASK(3, 3, 3, 3));
+		float* dst = &out[i].x;
+		_mm_storeu_ps(dst, _mm_shuffle_ps(xy01, zx01, MT3_SHUFFLE_MASK(0, 1, 0, 2)));
+		_mm_storeu_ps(dst + 4, _mm_shuffle_ps(yz11, xy23, MT3_SHUFFLE_MASK(0, 2, 0, 1)));
+		_mm_storeu_ps(dst + 8, _mm_shuffle_ps(zx23, yz33, MT3_SHUFFLE_MASK(0, 2, 0, 2)));
+	}
+#elif defined(MT3_SIMD_NEON)
+	for (; i + 4 <= n; i += 4) {
+		// vld3q でそのままSoAに分解できる
+		float32x4x3_t p = vld3q_f32(&in[i].x);
+		float32x4_t rx = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(p.val[0], matrix.m[0][0]), vmulq_n_f32(p.val[1], matrix.m[1][0])), vmulq_n_f32(p.val[2], matrix.m[2][0])), vdupq_n_f32(matrix.m[3][0]));
+		float32x4_t ry = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(p.val[0], matrix.m[0][1]), vmulq_n_f32(p.val[1], matrix.m[1][1])), vmulq_n_f32(p.val[2], matrix.m[2][1])), vdupq_n_f32(matrix.m[3][1]));
+		float32x4_t rz = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(p.val[0], matrix.m[0][2]), vmulq_n_f32(p.val[1], matrix.m[1][2])), vmulq_n_f32(p.val[2], matrix.m[2][2])), vdupq_n_f32(matrix.m[3][2]));
+		float32x4_t rw = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(p.val[0], matrix.m[0][3]), vmulq_n_f32(p.val[1], matrix.m[1][3])), vmulq_n_f32(p.val[2], matrix.m[2][3])), vdupq_n_f32(matrix.m[3][3]));
+		float32x4_t invW = FastMath::Reciprocal<Precision>(Simd::Float4{ rw }).v;
+		float32x4x3_t r;
+		r.val[0] = vmulq_f32(rx, invW);
+		r.val[1] = vmulq_f32(ry, invW);
+		r.val[2] = vmulq_f32(rz, invW);
+		vst3q_f32(&out[i].x, r);
+	}
+#endif
+	for (; i < n; ++i) {
+		const Vector3& v = in[i];
+		float x = v.x * matrix.m[0][0] + v.y * matrix.m[1][0] + v.z * matrix.m[2][0] + matrix.m[3][0];
+		float y = v.x * matrix.m[0][1] + v.y * matrix.m[1][1] + v.z * matrix.m[2][1] + matrix.m[3][1];
+		float z = v.x * matrix.m[0][2] + v.y * matrix.m[1][2] + v.z * matrix.m[2][2] + matrix.m[3][2];
+		float w = v.x * matrix.m[0][3] + v.y * matrix.m[1][3] + v.z * matrix.m[2][3] + matrix.m[3][3];
+		float invW = FastMath::Reciprocal<Precision>(w);
+		out[i] = { x * invW, y * invW, z * invW };
+	}
+}
+
+template void TransformPoints<FastMath::Exact>(const Vector3* in, Vector3* out, size_t n, const Matrix4x4& matrix);
+template void TransformPoints<FastMath::Precise>(const Vector3* in, Vector3* out, size_t n, const Matrix4x4& matrix);
+template void TransformPoints<FastMath::Fast>(const Vector3* in, Vector3* out, size_t n, const Matrix4x4& matrix);
+
 Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip) {
 	Matrix4x4 result = {
 		1.0f / aspectRatio * (std::cos(fovY * 0.5f) / std::sin(fovY * 0.5f)),0.0f,0.0f,0.0f,
@@ -130,337 +208,6 @@ Vector3 Reflect(const Vector3& input, const Vector3& normal) {
 	return result;
 }
 
-void Draw::DrawGrid(const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix) {
-	const float kGridHalfWidth = 2.0f;
-	const uint32_t kSubdivision = 10;
-	const float kGridEvery = (kGridHalfWidth * 2.0f) / static_cast<float>(kSubdivision);
-	for (uint32_t xIndex = 0; xIndex <= kSubdivision; ++xIndex) {
-		Vector3 start = { kGridEvery * static_cast<float>(xIndex) - kGridHalfWidth,0.0f,kGridEvery * 0.5f * static_cast<int>(kSubdivision) };
-		Vector3 end = { kGridEvery * static_cast<float>(xIndex) - kGridHalfWidth,0.0f,-kGridEvery * 0.5f * static_cast<int>(kSubdivision) };
-		Vector3 startScreenPos = Transform(start, viewProjectionMatrix);
-		Vector3 endScreenPos = Transform(end, viewProjectionMatrix);
-		startScreenPos = Transform(startScreenPos, viewportMatrix);
-		endScreenPos = Transform(endScreenPos, viewportMatrix);
-		if (xIndex == kSubdivision / 2) {
-			Novice::DrawLine(
-				static_cast<int>(startScreenPos.x),
-				static_cast<int>(startScreenPos.y),
-				static_cast<int>(endScreenPos.x),
-				static_cast<int>(endScreenPos.y),
-				0x222222ff
-			);
-		} else {
-			Novice::DrawLine(
-				static_cast<int>(startScreenPos.x),
-				static_cast<int>(startScreenPos.y),
-				static_cast<int>(endScreenPos.x),
-				static_cast<int>(endScreenPos.y),
-				0xaaaaaaff
-			);
-		}
-	}
-
-	for (uint32_t zIndex = 0; zIndex <= kSubdivision; ++zIndex) {
-		Vector3 start = { kGridEvery * 0.5f * static_cast<int>(kSubdivision),0.0f,kGridEvery * static_cast<float>(zIndex) - kGridHalfWidth };
-		Vector3 end = { -kGridEvery * 0.5f * static_cast<int>(kSubdivision),0.0f,kGridEvery * static_cast<float>(zIndex) - kGridHalfWidth };
-		Vector3 startScreenPos = Transform(start, viewProjectionMatrix);
-		Vector3 endScreenPos = Transform(end, viewProjectionMatrix);
-		startScreenPos = Transform(startScreenPos, viewportMatrix);
-		endScreenPos = Transform(endScreenPos, viewportMatrix);
-		if (zIndex == kSubdivision / 2) {
-			Novice::DrawLine(
-				static_cast<int>(startScreenPos.x),
-				static_cast<int>(startScreenPos.y),
-				static_cast<int>(endScreenPos.x),
-				static_cast<int>(endScreenPos.y),
-				0x222222ff
-			);
-		} else {
-			Novice::DrawLine(
-				static_cast<int>(startScreenPos.x),
-				static_cast<int>(startScreenPos.y),
-				static_cast<int>(endScreenPos.x),
-				static_cast<int>(endScreenPos.y),
-				0xaaaaaaff
-			);
-		}
-	}
-}
-
-void Draw::DrawSphere(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
-	const float kPi = std::numbers::pi_v<float>;
-	const uint32_t kSubdivision = 16;
-	const float kLonEvery = 2.0f * kPi / static_cast<float>(kSubdivision);
-	const float kLatEvery = kPi / static_cast<float>(kSubdivision);
-
-	for (uint32_t latIndex = 0; latIndex <= kSubdivision; ++latIndex) {
-		float lat = -kPi * 0.5f + kLatEvery * static_cast<float>(latIndex);
-		for (uint32_t lonIndex = 0; lonIndex <= kSubdivision; ++lonIndex) {
-			float lon = static_cast<float>(lonIndex) * kLonEvery;
-
-			Vector3 a, b, c;
-			// a, b, cをscreen座標系まで変換
-			a.x = std::cos(lat) * std::cos(lon) * sphere.radius + sphere.center.x;
-			a.y = std::sin(lat) * sphere.radius + sphere.center.y;
-			a.z = std::cos(lat) * std::sin(lon) * sphere.radius + sphere.center.z;
-
-			b.x = std::cos(lat + kLatEvery) * std::cos(lon) * sphere.radius + sphere.center.x;
-			b.y = std::sin(lat + kLatEvery) * sphere.radius + sphere.center.y;
-			b.z = std::cos(lat + kLatEvery) * std::sin(lon) * sphere.radius + sphere.center.z;
-
-			c.x = std::cos(lat) * std::cos(lon + kLonEvery) * sphere.radius + sphere.center.x;
-			c.y = std::sin(lat) * sphere.radius + sphere.center.y;
-			c.z = std::cos(lat) * std::sin(lon + kLonEvery) * sphere.radius + sphere.center.z;
-
-			a = Transform(a, viewProjectionMatrix);
-			b = Transform(b, viewProjectionMatrix);
-			c = Transform(c, viewProjectionMatrix);
-
-			a = Transform(a, viewportMatrix);
-			b = Transform(b, viewportMatrix);
-			c = Transform(c, viewportMatrix);
-
-			// abの線分を描画
-			Novice::DrawLine(
-				static_cast<int>(a.x),
-				static_cast<int>(a.y),
-				static_cast<int>(b.x),
-				static_cast<int>(b.y),
-				color
-			);
-
-			// bcの線分を描画
-			Novice::DrawLine(
-				static_cast<int>(a.x),
-				static_cast<int>(a.y),
-				static_cast<int>(c.x),
-				static_cast<int>(c.y),
-				color
-			);
-		}
-	}
-}
-
-void Draw::DrawPlane(const Plane& plane, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
-	Vector3 center = plane.normal * plane.distance;
-	Vector3 perpendiculars[4];
-	perpendiculars[0] = plane.normal.Perpendicular().Normalize();
-	perpendiculars[1] = { -perpendiculars[0].x,-perpendiculars[0].y,-perpendiculars[0].z };
-	perpendiculars[2] = plane.normal.Cross(perpendiculars[0]);
-	perpendiculars[3] = { -perpendiculars[2].x,-perpendiculars[2].y,-perpendiculars[2].z };
-
-	Vector3 points[4];
-	for (int32_t index = 0; index < 4; ++index) {
-		Vector3 extend = perpendiculars[index] * 2.0f;
-		Vector3 point = center + extend;
-		points[index] = Transform(Transform(point, viewProjectionMatrix), viewportMatrix);
-	}
-
-	Novice::DrawLine(
-		static_cast<int>(points[0].x),
-		static_cast<int>(points[0].y),
-		static_cast<int>(points[2].x),
-		static_cast<int>(points[2].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(points[1].x),
-		static_cast<int>(points[1].y),
-		static_cast<int>(points[3].x),
-		static_cast<int>(points[3].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(points[2].x),
-		static_cast<int>(points[2].y),
-		static_cast<int>(points[1].x),
-		static_cast<int>(points[1].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(points[3].x),
-		static_cast<int>(points[3].y),
-		static_cast<int>(points[0].x),
-		static_cast<int>(points[0].y),
-		color
-	);
-}
-
-void Draw::DrawSegment(const Segment& segment, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
-	Vector3 start = Transform(Transform(segment.origin, viewProjectionMatrix), viewportMatrix);
-	Vector3 end = Transform(Transform(segment.origin + segment.diff, viewProjectionMatrix), viewportMatrix);
-	Novice::DrawLine(
-		static_cast<int>(start.x),
-		static_cast<int>(start.y),
-		static_cast<int>(end.x),
-		static_cast<int>(end.y),
-		color
-	);
-}
-
-void Draw::DrawTriangle(const Triangle& triangle, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
-	Vector3 a = Transform(Transform(triangle.vertices[0], viewProjectionMatrix), viewportMatrix);
-	Vector3 b = Transform(Transform(triangle.vertices[1], viewProjectionMatrix), viewportMatrix);
-	Vector3 c = Transform(Transform(triangle.vertices[2], viewProjectionMatrix), viewportMatrix);
-
-	Novice::DrawLine(
-		static_cast<int>(a.x),
-		static_cast<int>(a.y),
-		static_cast<int>(b.x),
-		static_cast<int>(b.y),
-		color
-	);
-	Novice::DrawLine(
-		static_cast<int>(b.x),
-		static_cast<int>(b.y),
-		static_cast<int>(c.x),
-		static_cast<int>(c.y),
-		color
-	);
-	Novice::DrawLine(
-		static_cast<int>(c.x),
-		static_cast<int>(c.y),
-		static_cast<int>(a.x),
-		static_cast<int>(a.y),
-		color
-	);
-}
-
-void Draw::DrawAABB(const AABB& aabb, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
-	Vector3 vertices[8] = {
-		{ aabb.min.x, aabb.min.y, aabb.min.z },
-		{ aabb.min.x, aabb.min.y, aabb.max.z },
-		{ aabb.max.x, aabb.min.y, aabb.max.z },
-		{ aabb.max.x, aabb.min.y, aabb.min.z },
-		{ aabb.min.x, aabb.max.y, aabb.min.z },
-		{ aabb.min.x, aabb.max.y, aabb.max.z },
-		{ aabb.max.x, aabb.max.y, aabb.max.z },
-		{ aabb.max.x, aabb.max.y, aabb.min.z }
-	};
-
-	for (int32_t i = 0; i < 8; ++i) {
-		vertices[i] = Transform(Transform(vertices[i], viewProjectionMatrix), viewportMatrix);
-	}
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[0].x),
-		static_cast<int>(vertices[0].y),
-		static_cast<int>(vertices[1].x),
-		static_cast<int>(vertices[1].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[1].x),
-		static_cast<int>(vertices[1].y),
-		static_cast<int>(vertices[2].x),
-		static_cast<int>(vertices[2].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[2].x),
-		static_cast<int>(vertices[2].y),
-		static_cast<int>(vertices[3].x),
-		static_cast<int>(vertices[3].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[3].x),
-		static_cast<int>(vertices[3].y),
-		static_cast<int>(vertices[0].x),
-		static_cast<int>(vertices[0].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[4].x),
-		static_cast<int>(vertices[4].y),
-		static_cast<int>(vertices[5].x),
-		static_cast<int>(vertices[5].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[5].x),
-		static_cast<int>(vertices[5].y),
-		static_cast<int>(vertices[6].x),
-		static_cast<int>(vertices[6].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[6].x),
-		static_cast<int>(vertices[6].y),
-		static_cast<int>(vertices[7].x),
-		static_cast<int>(vertices[7].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[7].x),
-		static_cast<int>(vertices[7].y),
-		static_cast<int>(vertices[4].x),
-		static_cast<int>(vertices[4].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[0].x),
-		static_cast<int>(vertices[0].y),
-		static_cast<int>(vertices[4].x),
-		static_cast<int>(vertices[4].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[1].x),
-		static_cast<int>(vertices[1].y),
-		static_cast<int>(vertices[5].x),
-		static_cast<int>(vertices[5].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[2].x),
-		static_cast<int>(vertices[2].y),
-		static_cast<int>(vertices[6].x),
-		static_cast<int>(vertices[6].y),
-		color
-	);
-
-	Novice::DrawLine(
-		static_cast<int>(vertices[3].x),
-		static_cast<int>(vertices[3].y),
-		static_cast<int>(vertices[7].x),
-		static_cast<int>(vertices[7].y),
-		color
-	);
-}
-
-void Draw::DrawBezier(const Vector3& controlPoint0, const Vector3& contorlPoint1, const Vector3& contorlPoint2, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color) {
-	const int32_t kSubdivision = 100;
-	for (int32_t i = 0; i < kSubdivision; ++i) {
-		float t0 = static_cast<float>(i) / static_cast<float>(kSubdivision);
-		float t1 = static_cast<float>(i + 1) / static_cast<float>(kSubdivision);
-		Vector3 p0 = controlPoint0 * (1.0f - t0) * (1.0f - t0) + contorlPoint1 * 2.0f * (1.0f - t0) * t0 + contorlPoint2 * t0 * t0;
-		Vector3 p1 = controlPoint0 * (1.0f - t1) * (1.0f - t1) + contorlPoint1 * 2.0f * (1.0f - t1) * t1 + contorlPoint2 * t1 * t1;
-		p0 = Transform(Transform(p0, viewProjectionMatrix), viewportMatrix);
-		p1 = Transform(Transform(p1, viewProjectionMatrix), viewportMatrix);
-		Novice::DrawLine(
-			static_cast<int>(p0.x),
-			static_cast<int>(p0.y),
-			static_cast<int>(p1.x),
-			static_cast<int>(p1.y),
-			color
-		);
-	}
-}
-
 Vector3 ClosestPoint(const Vector3& point, const Segment& segment) {
 	Vector3 result = segment.origin + (point - segment.origin).Project(segment.diff);
 	return result;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include "Vector3.h"
 #include "Matrix4x4.h"
 
@@ -85,6 +87,11 @@ Matrix4x4 MakeRotateYMatrix(float radian);
 Matrix4x4 MakeRotateZMatrix(float radian);
 Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
 Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix);
+// 頂点配列をまとめて変換する(透視除算は1頂点につき1回)
+void TransformPoints(const Vector3* in, Vector3* out, size_t n, const Matrix4x4& matrix);
+// 透視除算の逆数を Precision の精度で求める (FastMath::Exact / Precise / Fast)
+template<typename Precision>
+void TransformPoints(const Vector3* in, Vector3* out, size_t n, const Matrix4x4& matrix);
 Vector3 ClosestPoint(const Vector3& point, const Segment& segment);
 
 Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip);
@@ -95,16 +102,6 @@ Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t);
 
 Vector3 Reflect(const Vector3& input, const Vector3& normal);
 
-namespace Draw {
-	void DrawGrid(const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix);
-	void DrawSphere(const Sphere& sphere, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
-	void DrawPlane(const Plane& plane, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
-	void DrawSegment(const Segment& segment, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
-	void DrawTriangle(const Triangle& triangle, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
-	void DrawAABB(const AABB& aabb, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
-	void DrawBezier(const Vector3& controlPoint0, const Vector3& contorlPoint1, const Vector3& contorlPoint2, const Matrix4x4& viewProjectionMatrix, const Matrix4x4& viewportMatrix, uint32_t color);
-}
-
 namespace Collision {
 	bool isCollision(const Sphere& s1, const Sphere& s2);
 	bool isCollision(const Sphere& sphere, const Plane& plane);
@@ -121,4 +118,15 @@ namespace Collision {
 	bool isCollision(const AABB& aabb, const Ray& ray);
 	bool isCollision(const AABB& aabb, const Line& line);
 	bool IsCollision(const Capsule& capsule, const Plane& plane);
+
+	// 近似を許す場合は距離の2乗で比べて平方根を省く (Exact は上と同じ判定)
+	template<typename Precision>
+	bool isCollision(const Sphere& s1, const Sphere& s2) {
+		if constexpr (FastMath::kIsExact<Precision>) {
+			return isCollision(s1, s2);
+		} else {
+			float radiusSum = s1.radius + s2.radius;
+			return (s1.center - s2.center).LengthSquared() <= radiusSum * radiusSum;
+		}
+	}
 }
\ No newline at end of file
@@ -1,5 +1,11 @@
 #pragma once
 #include <cmath>
+#include "Simd.h"
+
+// 乗算・転置・逆行列はSIMD実装(SSE/AVX/NEON)をコンパイル時に選択する
+//  operator* と Transpose はスカラー実装と同じ演算順序なのでビット単位で一致する
+//  Inverse / InverseAffine は演算順序が旧実装と異なるため、行の最大成分のULPを単位として
+//  アフィン行列では 8ULP 以内、一般の行列では条件数に応じて増える(Benchmark/MatrixBenchmark.cpp で計測)
 
 struct Matrix4x4 {
 	float m[4][4];
@@ -26,79 +32,243 @@ struct Matrix4x4 {
 
 	Matrix4x4 operator*(const Matrix4x4& a) const {
 		Matrix4x4 result;
+#if defined(MT3_SIMD_AVX)
+		// 2行ずつ256bitで計算する
+		__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.m[0]));
+		__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.m[1]));
+		__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.m[2]));
+		__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.m[3]));
+		for (int i = 0; i < 4; i += 2) {
+			__m256 rows = _mm256_loadu_ps(m[i]);
+			__m256 r = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1));
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xAA), b2));
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xFF), b3));
+			_mm256_storeu_ps(result.m[i], r);
+		}
+#elif defined(MT3_SIMD_SSE)
+		__m128 b0 = _mm_loadu_ps(a.m[0]);
+		__m128 b1 = _mm_loadu_ps(a.m[1]);
+		__m128 b2 = _mm_loadu_ps(a.m[2]);
+		__m128 b3 = _mm_loadu_ps(a.m[3]);
+		for (int i = 0; i < 4; i++) {
+			__m128 row = _mm_loadu_ps(m[i]);
+			__m128 r = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+			_mm_storeu_ps(result.m[i], r);
+		}
+#elif defined(MT3_SIMD_NEON)
+		// vmlaq は融合積和になる環境があるので mul + add で順序を揃える
+		float32x4_t b0 = vld1q_f32(a.m[0]);
+		float32x4_t b1 = vld1q_f32(a.m[1]);
+		float32x4_t b2 = vld1q_f32(a.m[2]);
+		float32x4_t b3 = vld1q_f32(a.m[3]);
+		for (int i = 0; i < 4; i++) {
+			float32x4_t r = vmulq_n_f32(b0, m[i][0]);
+			r = vaddq_f32(r, vmulq_n_f32(b1, m[i][1]));
+			r = vaddq_f32(r, vmulq_n_f32(b2, m[i][2]));
+			r = vaddq_f32(r, vmulq_n_f32(b3, m[i][3]));
+			vst1q_f32(result.m[i], r);
+		}
+#else
 		for (int i = 0; i < 4; i++) {
 			for (int j = 0; j < 4; j++) {
-				result.m[i][j] = 0;
-				for (int k = 0; k < 4; k++) {
+				result.m[i][j] = m[i][0] * a.m[0][j];
+				for (int k = 1; k < 4; k++) {
 					result.m[i][j] += m[i][k] * a.m[k][j];
 				}
 			}
 		}
+#endif
 		return result;
 	}
 
 	Matrix4x4 Inverse() const {
 		Matrix4x4 result;
-		Matrix4x4 mat = *this; // オリジナルの行列を保持するためにコピーを作成
+#if defined(MT3_SIMD_SSE)
+		// 2x2のブロックに分割して逆行列を求める
+		//  M = | A B |   A,B,C,Dは行優先の2x2行列を1レジスタに格納
+		//      | C D |
+		__m128 r0 = _mm_loadu_ps(m[0]);
+		__m128 r1 = _mm_loadu_ps(m[1]);
+		__m128 r2 = _mm_loadu_ps(m[2]);
+		__m128 r3 = _mm_loadu_ps(m[3]);
+
+		__m128 a = _mm_movelh_ps(r0, r1);
+		__m128 b = _mm_movehl_ps(r1, r0);
+		__m128 c = _mm_movelh_ps(r2, r3);
+		__m128 d = _mm_movehl_ps(r3, r2);
+
+		// (|A| |B| |C| |D|)
+		__m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(r0, r2, MT3_SHUFFLE_MASK(0, 2, 0, 2)), _mm_shuffle_ps(r1, r3, MT3_SHUFFLE_MASK(1, 3, 1, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(r0, r2, MT3_SHUFFLE_MASK(1, 3, 1, 3)), _mm_shuffle_ps(r1, r3, MT3_SHUFFLE_MASK(0, 2, 0, 2)))
+		);
+		__m128 detA = _mm_shuffle_ps(detSub, detSub, 0x00);
+		__m128 detB = _mm_shuffle_ps(detSub, detSub, 0x55);
+		__m128 detC = _mm_shuffle_ps(detSub, detSub, 0xAA);
+		__m128 detD = _mm_shuffle_ps(detSub, detSub, 0xFF);
+
+		// D#C, A#B (#は余因子行列)
+		__m128 dc = Mat2AdjMul(d, c);
+		__m128 ab = Mat2AdjMul(a, b);
+		// X# = |D|A - B(D#C), W# = |A|D - C(A#B)
+		__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, dc));
+		__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, ab));
+		// Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+		__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, ab));
+		__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, dc));
 
-		float det = 0;
+		// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+		__m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+		__m128 tr = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, MT3_SHUFFLE_MASK(0, 2, 1, 3)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, MT3_SHUFFLE_MASK(2, 3, 0, 1)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, MT3_SHUFFLE_MASK(1, 0, 3, 2)));
+		detM = _mm_sub_ps(detM, tr);
+
+		__m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+		x = _mm_mul_ps(x, rDetM);
+		y = _mm_mul_ps(y, rDetM);
+		z = _mm_mul_ps(z, rDetM);
+		w = _mm_mul_ps(w, rDetM);
+
+		// 余因子行列の並べ替えと格納を同時に行う
+		_mm_storeu_ps(result.m[0], _mm_shuffle_ps(x, y, MT3_SHUFFLE_MASK(3, 1, 3, 1)));
+		_mm_storeu_ps(result.m[1], _mm_shuffle_ps(x, y, MT3_SHUFFLE_MASK(2, 0, 2, 0)));
+		_mm_storeu_ps(result.m[2], _mm_shuffle_ps(z, w, MT3_SHUFFLE_MASK(3, 1, 3, 1)));
+		_mm_storeu_ps(result.m[3], _mm_shuffle_ps(z, w, MT3_SHUFFLE_MASK(2, 0, 2, 0)));
+#else
+		// 上2行と下2行の2x2小行列式を一度だけ計算し、余因子展開で共有する
+		float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+		float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+		float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+		float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+		float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+		float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+		float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+		float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+		float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+		float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+		float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+		float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
 
 		// 行列式を計算
-		for (int i = 0; i < 4; ++i) {
-			// 部分行列を作成
-			float subMat[3][3];
-			for (int sub_i = 1; sub_i < 4; ++sub_i) {
-				int sub_j = 0;
-				for (int sub_k = 0; sub_k < 4; ++sub_k) {
-					if (sub_k == i) continue;
-					subMat[sub_i - 1][sub_j] = mat.m[sub_i][sub_k];
-					++sub_j;
-				}
-			}
+		float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		float invDet = 1.0f / det;
 
-			// 行列式を計算
-			float subDet =
-				subMat[0][0] * (subMat[1][1] * subMat[2][2] - subMat[1][2] * subMat[2][1])
-				- subMat[0][1] * (subMat[1][0] * subMat[2][2] - subMat[1][2] * subMat[2][0])
-				+ subMat[0][2] * (subMat[1][0] * subMat[2][1] - subMat[1][1] * subMat[2][0]);
-			det += (i % 2 == 0 ? 1 : -1) * mat.m[0][i] * subDet;
-		}
+		result.m[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet;
+		result.m[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet;
+		result.m[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet;
+		result.m[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet;
 
-		// 各要素の余因子を計算して逆行列を求める
-		for (int i = 0; i < 4; ++i) {
-			for (int j = 0; j < 4; ++j) {
-				// 部分行列を作成
-				float subMat[3][3];
-				for (int sub_i = 0, row = 0; sub_i < 4; ++sub_i) {
-					if (sub_i == i) continue;
-					for (int sub_j = 0, col = 0; sub_j < 4; ++sub_j) {
-						if (sub_j == j) continue;
-						subMat[row][col] = mat.m[sub_i][sub_j];
-						++col;
-					}
-					++row;
-				}
+		result.m[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet;
+		result.m[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet;
+		result.m[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet;
+		result.m[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet;
 
-				// 余因子行列の計算
-				float subDet =
-					subMat[0][0] * (subMat[1][1] * subMat[2][2] - subMat[1][2] * subMat[2][1])
-					- subMat[0][1] * (subMat[1][0] * subMat[2][2] - subMat[1][2] * subMat[2][0])
-					+ subMat[0][2] * (subMat[1][0] * subMat[2][1] - subMat[1][1] * subMat[2][0]);
+		result.m[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet;
+		result.m[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet;
+		result.m[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet;
+		result.m[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet;
 
-				result.m[j][i] = ((i + j) % 2 == 0 ? 1 : -1) * subDet / det;
-			}
+		result.m[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet;
+		result.m[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet;
+		result.m[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet;
+		result.m[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet;
+#endif
+		return result;
+	}
+
+	// アフィン変換行列(4列目が(0,0,0,1))専用の逆行列
+	Matrix4x4 InverseAffine() const {
+		// 3x3部分の逆行列は行ベクトルの外積から求める
+		float c0[3] = {
+			m[1][1] * m[2][2] - m[1][2] * m[2][1],
+			m[1][2] * m[2][0] - m[1][0] * m[2][2],
+			m[1][0] * m[2][1] - m[1][1] * m[2][0]
+		};
+		float c1[3] = {
+			m[2][1] * m[0][2] - m[2][2] * m[0][1],
+			m[2][2] * m[0][0] - m[2][0] * m[0][2],
+			m[2][0] * m[0][1] - m[2][1] * m[0][0]
+		};
+		float c2[3] = {
+			m[0][1] * m[1][2] - m[0][2] * m[1][1],
+			m[0][2] * m[1][0] - m[0][0] * m[1][2],
+			m[0][0] * m[1][1] - m[0][1] * m[1][0]
+		};
+		float invDet = 1.0f / (m[0][0] * c0[0] + m[0][1] * c0[1] + m[0][2] * c0[2]);
+
+		Matrix4x4 result;
+		for (int i = 0; i < 3; ++i) {
+			result.m[i][0] = c0[i] * invDet;
+			result.m[i][1] = c1[i] * invDet;
+			result.m[i][2] = c2[i] * invDet;
+			result.m[i][3] = 0.0f;
 		}
 
+		// 平行移動は -t * L^-1
+		for (int j = 0; j < 3; ++j) {
+			result.m[3][j] = -(m[3][0] * result.m[0][j] + m[3][1] * result.m[1][j] + m[3][2] * result.m[2][j]);
+		}
+		result.m[3][3] = 1.0f;
+
 		return result;
 	}
 
 	Matrix4x4 Transpose() const {
 		Matrix4x4 result;
+#if defined(MT3_SIMD_SSE)
+		__m128 r0 = _mm_loadu_ps(m[0]);
+		__m128 r1 = _mm_loadu_ps(m[1]);
+		__m128 r2 = _mm_loadu_ps(m[2]);
+		__m128 r3 = _mm_loadu_ps(m[3]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(result.m[0], r0);
+		_mm_storeu_ps(result.m[1], r1);
+		_mm_storeu_ps(result.m[2], r2);
+		_mm_storeu_ps(result.m[3], r3);
+#elif defined(MT3_SIMD_NEON)
+		// 4要素おきのデインターリーブ読み込みがそのまま転置になる
+		float32x4x4_t columns = vld4q_f32(&m[0][0]);
+		vst1q_f32(result.m[0], columns.val[0]);
+		vst1q_f32(result.m[1], columns.val[1]);
+		vst1q_f32(result.m[2], columns.val[2]);
+		vst1q_f32(result.m[3], columns.val[3]);
+#else
 		for (int i = 0; i < 4; ++i) {
 			for (int j = 0; j < 4; ++j) {
 				result.m[i][j] = m[j][i];
 			}
 		}
+#endif
 		return result;
 	}
-};
\ No newline at end of file
+
+private:
+#if defined(MT3_SIMD_SSE)
+	// 2x2行列 A*B
+	static __m128 Mat2Mul(__m128 a, __m128 b) {
+		return _mm_add_ps(
+			_mm_mul_ps(a, _mm_shuffle_ps(b, b, MT3_SHUFFLE_MASK(0, 3, 0, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, MT3_SHUFFLE_MASK(1, 0, 3, 2)), _mm_shuffle_ps(b, b, MT3_SHUFFLE_MASK(2, 1, 2, 1))));
+	}
+
+	// 2x2行列 A#*B
+	static __m128 Mat2AdjMul(__m128 a, __m128 b) {
+		return _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(a, a, MT3_SHUFFLE_MASK(3, 3, 0, 0)), b),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, MT3_SHUFFLE_MASK(1, 1, 2, 2)), _mm_shuffle_ps(b, b, MT3_SHUFFLE_MASK(2, 3, 0, 1))));
+	}
+
+	// 2x2行列 A*B#
+	static __m128 Mat2MulAdj(__m128 a, __m128 b) {
+		return _mm_sub_ps(
+			_mm_mul_ps(a, _mm_shuffle_ps(b, b, MT3_SHUFFLE_MASK(3, 0, 3, 0))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, MT3_SHUFFLE_MASK(1, 0, 3, 2)), _mm_shuffle_ps(b, b, MT3_SHUFFLE_MASK(2, 1, 2, 1))));
+	}
+#endif
+};
@@ -0,0 +1,362 @@
+#include "PendulumSystem.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+#include "SimdFloat.h"
+#include "Profiler.h"
+
+namespace {
+	const size_t kChunkSize = 4096;
+	// 配列を揃える要素数 (AVXの幅)
+	const size_t kPadding = 8;
+
+#if defined(MT3_SIMD_AVX)
+	using FloatN = Simd::Float8;
+	const size_t kLanes = 8;
+#else
+	using FloatN = Simd::Float4;
+	const size_t kLanes = 4;
+#endif
+
+	size_t PaddedSize(size_t count) {
+		return (count + kPadding - 1) / kPadding * kPadding;
+	}
+
+	void ParallelFor(JobSystem* jobSystem, size_t count, const JobSystem::RangeFunction& function) {
+		if (jobSystem == nullptr) {
+			function(0, count);
+			return;
+		}
+		jobSystem->ParallelFor(count, kChunkSize, function);
+	}
+
+	FloatN Sin(FloatN x) {
+		FloatN sinX;
+		FloatN cosX;
+		Simd::SinCos(x, sinX, cosX);
+		return sinX;
+	}
+
+	FloatN Abs(FloatN x) {
+		return Max(x, FloatN::Set(0.0f) - x);
+	}
+
+	// SIMDで求めた値を Vector3 の配列へ並べ直す
+	void StorePositions(FloatN x, FloatN y, FloatN z, size_t begin, size_t count, std::vector<Vector3>& positions) {
+		alignas(32) float bufferX[kLanes];
+		alignas(32) float bufferY[kLanes];
+		alignas(32) float bufferZ[kLanes];
+		x.Store(bufferX);
+		y.Store(bufferY);
+		z.Store(bufferZ);
+		size_t lanes = std::min(kLanes, count - begin);
+		for (size_t lane = 0; lane < lanes; ++lane) {
+			positions[begin + lane] = { bufferX[lane], bufferY[lane], bufferZ[lane] };
+		}
+	}
+}
+
+size_t PendulumSystem::Add(const Pendulum& pendulum) {
+	size_t index = count_;
+	Resize(count_ + 1);
+	Set(index, pendulum);
+	return index;
+}
+
+void PendulumSystem::Clear() {
+	count_ = 0;
+	for (AlignedVector<float>* array : { &anchorX_, &anchorY_, &anchorZ_, &length_, &angle_, &angularVelocity_, &angularAcceleration_, &referenceEnergy_ }) {
+		array->clear();
+	}
+}
+
+void PendulumSystem::Reserve(size_t capacity) {
+	size_t padded = PaddedSize(capacity);
+	for (AlignedVector<float>* array : { &anchorX_, &anchorY_, &anchorZ_, &length_, &angle_, &angularVelocity_, &angularAcceleration_, &referenceEnergy_ }) {
+		array->reserve(padded);
+	}
+}
+
+void PendulumSystem::Resize(size_t count) {
+	count_ = count;
+	size_t padded = PaddedSize(count);
+	for (AlignedVector<float>* array : { &anchorX_, &anchorY_, &anchorZ_, &angle_, &angularVelocity_, &angularAcceleration_, &referenceEnergy_ }) {
+		array->resize(padded, 0.0f);
+	}
+	length_.resize(padded, 1.0f);
+}
+
+Pendulum PendulumSystem::Get(size_t index) const {
+	assert(index < count_);
+	Pendulum pendulum;
+	pendulum.anchor = { anchorX_[index], anchorY_[index], anchorZ_[index] };
+	pendulum.length = length_[index];
+	pendulum.angle = angle_[index];
+	pendulum.angularVelocity = angularVelocity_[index];
+	pendulum.angularAcceleration = angularAcceleration_[index];
+	return pendulum;
+}
+
+void PendulumSystem::Set(size_t index, const Pendulum& pendulum) {
+	assert(index < count_);
+	assert(pendulum.length > 0.0f);
+	anchorX_[index] = pendulum.anchor.x;
+	anchorY_[index] = pendulum.anchor.y;
+	anchorZ_[index] = pendulum.anchor.z;
+	length_[index] = pendulum.length;
+	angle_[index] = pendulum.angle;
+	angularVelocity_[index] = pendulum.angularVelocity;
+	// 速度ベルレ法は前のステップの角加速度を使うので、角度から求め直しておく
+	angularAcceleration_[index] = -(gravity_ / pendulum.length) * std::sin(pendulum.angle);
+	referenceEnergy_[index] = Energy(index);
+}
+
+void PendulumSystem::SetGravity(float gravity) {
+	gravity_ = gravity;
+	// 速度ベルレ法の最初の半ステップが古い重力の角加速度を使わないようにする
+	for (size_t i = 0; i < count_; ++i) {
+		angularAcceleration_[i] = -(gravity_ / length_[i]) * std::sin(angle_[i]);
+	}
+	ResetEnergyReference();
+}
+
+void PendulumSystem::Step(float deltaTime, JobSystem* jobSystem) {
+	MT3_PROFILE_ZONE("PendulumSystem::Step");
+	PendulumIntegrator integrator = integrator_;
+	float gravity = gravity_;
+	ParallelFor(jobSystem, PaddedSize(count_), [&](size_t begin, size_t end) {
+		FloatN h = FloatN::Set(deltaTime);
+		FloatN halfH = FloatN::Set(deltaTime * 0.5f);
+		FloatN sixthH = FloatN::Set(deltaTime / 6.0f);
+		FloatN two = FloatN::Set(2.0f);
+		for (size_t i = begin; i < end; i += kLanes) {
+			FloatN angle = FloatN::Load(&angle_[i]);
+			FloatN angularVelocity = FloatN::Load(&angularVelocity_[i]);
+			// α = -k sin θ
+			FloatN k = FloatN::Set(0.0f) - FloatN::Set(gravity) / FloatN::Load(&length_[i]);
+			FloatN angularAcceleration;
+
+			switch (integrator) {
+			case PendulumIntegrator::kSymplecticEuler:
+				angularAcceleration = k * Sin(angle);
+				angularVelocity = angularVelocity + angularAcceleration * h;
+				angle = angle + angularVelocity * h;
+				break;
+			case PendulumIntegrator::kVelocityVerlet: {
+				FloatN halfVelocity = angularVelocity + FloatN::Load(&angularAcceleration_[i]) * halfH;
+				angle = angle + halfVelocity * h;
+				angularAcceleration = k * Sin(angle);
+				angularVelocity = halfVelocity + angularAcceleration * halfH;
+				break;
+			}
+			default: {
+				FloatN velocity1 = angularVelocity;
+				FloatN acceleration1 = k * Sin(angle);
+				FloatN velocity2 = angularVelocity + acceleration1 * halfH;
+				FloatN acceleration2 = k * Sin(angle + velocity1 * halfH);
+				FloatN velocity3 = angularVelocity + acceleration2 * halfH;
+				FloatN acceleration3 = k * Sin(angle + velocity2 * halfH);
+				FloatN velocity4 = angularVelocity + acceleration3 * h;
+				FloatN acceleration4 = k * Sin(angle + velocity3 * h);
+				angle = angle + (velocity1 + two * (velocity2 + velocity3) + velocity4) * sixthH;
+				angularVelocity = angularVelocity + (acceleration1 + two * (acceleration2 + acceleration3) + acceleration4) * sixthH;
+				angularAcceleration = k * Sin(angle);
+				break;
+			}
+			}
+
+			angle.Store(&angle_[i]);
+			angularVelocity.Store(&angularVelocity_[i]);
+			angularAcceleration.Store(&angularAcceleration_[i]);
+		}
+		});
+}
+
+Vector3 PendulumSystem::GetPosition(size_t index) const {
+	assert(index < count_);
+	float length = length_[index];
+	float angle = angle_[index];
+	return { anchorX_[index] + std::sin(angle) * length, anchorY_[index] - std::cos(angle) * length, anchorZ_[index] };
+}
+
+void PendulumSystem::ComputePositions(std::vector<Vector3>& positions, JobSystem* jobSystem) const {
+	positions.resize(count_);
+	ParallelFor(jobSystem, PaddedSize(count_), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end && i < count_; i += kLanes) {
+			FloatN sinAngle;
+			FloatN cosAngle;
+			Simd::SinCos(FloatN::Load(&angle_[i]), sinAngle, cosAngle);
+			FloatN length = FloatN::Load(&length_[i]);
+			StorePositions(FloatN::Load(&anchorX_[i]) + sinAngle * length, FloatN::Load(&anchorY_[i]) - cosAngle * length, FloatN::Load(&anchorZ_[i]), i, count_, positions);
+		}
+		});
+}
+
+float PendulumSystem::Energy(size_t index) const {
+	float length = length_[index];
+	float speed = length * angularVelocity_[index];
+	return 0.5f * speed * speed + gravity_ * length * (1.0f - std::cos(angle_[index]));
+}
+
+void PendulumSystem::ComputeEnergy(size_t begin, size_t end, float* energy) const {
+	FloatN half = FloatN::Set(0.5f);
+	FloatN one = FloatN::Set(1.0f);
+	FloatN gravity = FloatN::Set(gravity_);
+	for (size_t i = begin; i < end; i += kLanes) {
+		FloatN sinAngle;
+		FloatN cosAngle;
+		Simd::SinCos(FloatN::Load(&angle_[i]), sinAngle, cosAngle);
+		FloatN length = FloatN::Load(&length_[i]);
+		FloatN speed = length * FloatN::Load(&angularVelocity_[i]);
+		(half * speed * speed + gravity * length * (one - cosAngle)).Store(energy + (i - begin));
+	}
+}
+
+void PendulumSystem::ResetEnergyReference(JobSystem* jobSystem) {
+	ParallelFor(jobSystem, PaddedSize(count_), [&](size_t begin, size_t end) {
+		ComputeEnergy(begin, end, &referenceEnergy_[begin]);
+		});
+}
+
+PendulumEnergyDrift PendulumSystem::ComputeEnergyDrift(JobSystem* jobSystem) const {
+	if (count_ == 0) {
+		return { 0.0f, 0.0f };
+	}
+
+	// チャンクごとの最大と合計を、チャンク順にまとめる
+	size_t padded = PaddedSize(count_);
+	size_t chunkCount = (padded + kChunkSize - 1) / kChunkSize;
+	std::vector<float> chunkMax(chunkCount);
+	std::vector<double> chunkSum(chunkCount);
+	ParallelFor(jobSystem, padded, [&](size_t begin, size_t end) {
+		thread_local AlignedVector<float> energy;
+		energy.resize(end - begin);
+		ComputeEnergy(begin, end, energy.data());
+		FloatN gravity = FloatN::Set(gravity_);
+		alignas(32) float drift[kLanes];
+		float maxDrift = 0.0f;
+		double sumDrift = 0.0;
+		for (size_t i = begin; i < end; i += kLanes) {
+			// 余りの要素はエネルギーも基準も0なのでずれも0
+			FloatN difference = FloatN::Load(&energy[i - begin]) - FloatN::Load(&referenceEnergy_[i]);
+			(Abs(difference) / Max(gravity * FloatN::Load(&length_[i]), FloatN::Set(1e-12f))).Store(drift);
+			for (size_t lane = 0; lane < kLanes; ++lane) {
+				maxDrift = std::max(maxDrift, drift[lane]);
+				sumDrift += drift[lane];
+			}
+		}
+		chunkMax[begin / kChunkSize] = maxDrift;
+		chunkSum[begin / kChunkSize] = sumDrift;
+		});
+
+	float maxDrift = 0.0f;
+	double sumDrift = 0.0;
+	for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+		maxDrift = std::max(maxDrift, chunkMax[chunk]);
+		sumDrift += chunkSum[chunk];
+	}
+	return { maxDrift, static_cast<float>(sumDrift / static_cast<double>(count_)) };
+}
+
+size_t ConicalPendulumSystem::Add(const ConicalPendulum& pendulum) {
+	size_t index = count_;
+	Resize(count_ + 1);
+	Set(index, pendulum);
+	return index;
+}
+
+void ConicalPendulumSystem::Clear() {
+	count_ = 0;
+	for (AlignedVector<float>* array : { &anchorX_, &anchorY_, &anchorZ_, &length_, &halfApexAngle_, &angle_, &angularVelocity_ }) {
+		array->clear();
+	}
+}
+
+void ConicalPendulumSystem::Reserve(size_t capacity) {
+	size_t padded = PaddedSize(capacity);
+	for (AlignedVector<float>* array : { &anchorX_, &anchorY_, &anchorZ_, &length_, &halfApexAngle_, &angle_, &angularVelocity_ }) {
+		array->reserve(padded);
+	}
+}
+
+void ConicalPendulumSystem::Resize(size_t count) {
+	count_ = count;
+	size_t padded = PaddedSize(count);
+	for (AlignedVector<float>* array : { &anchorX_, &anchorY_, &anchorZ_, &length_, &halfApexAngle_, &angle_, &angularVelocity_ }) {
+		array->resize(padded, 0.0f);
+	}
+}
+
+ConicalPendulum ConicalPendulumSystem::Get(size_t index) const {
+	assert(index < count_);
+	ConicalPendulum pendulum;
+	pendulum.anchor = { anchorX_[index], anchorY_[index], anchorZ_[index] };
+	pendulum.length = length_[index];
+	pendulum.halfApexAngle = halfApexAngle_[index];
+	pendulum.angle = angle_[index];
+	pendulum.angularVelocity = angularVelocity_[index];
+	return pendulum;
+}
+
+void ConicalPendulumSystem::Set(size_t index, const ConicalPendulum& pendulum) {
+	assert(index < count_);
+	assert(pendulum.length > 0.0f);
+	anchorX_[index] = pendulum.anchor.x;
+	anchorY_[index] = pendulum.anchor.y;
+	anchorZ_[index] = pendulum.anchor.z;
+	length_[index] = pendulum.length;
+	halfApexAngle_[index] = pendulum.halfApexAngle;
+	angle_[index] = pendulum.angle;
+	angularVelocity_[index] = AngularVelocity(pendulum.length, pendulum.halfApexAngle);
+}
+
+void ConicalPendulumSystem::SetGravity(float gravity) {
+	gravity_ = gravity;
+	for (size_t i = 0; i < count_; ++i) {
+		angularVelocity_[i] = AngularVelocity(length_[i], halfApexAngle_[i]);
+	}
+}
+
+float ConicalPendulumSystem::AngularVelocity(float length, float halfApexAngle) const {
+	return std::sqrt(gravity_ / (length * std::cos(halfApexAngle)));
+}
+
+void ConicalPendulumSystem::Step(float deltaTime, JobSystem* jobSystem) {
+	MT3_PROFILE_ZONE("ConicalPendulumSystem::Step");
+	ParallelFor(jobSystem, PaddedSize(count_), [&](size_t begin, size_t end) {
+		FloatN h = FloatN::Set(deltaTime);
+		FloatN twoPi = FloatN::Set(2.0f * std::numbers::pi_v<float>);
+		FloatN inverseTwoPi = FloatN::Set(0.5f * std::numbers::inv_pi_v<float>);
+		for (size_t i = begin; i < end; i += kLanes) {
+			FloatN angle = FloatN::Load(&angle_[i]) + FloatN::Load(&angularVelocity_[i]) * h;
+			angle = angle - Simd::Round(angle * inverseTwoPi) * twoPi;
+			angle.Store(&angle_[i]);
+		}
+		});
+}
+
+Vector3 ConicalPendulumSystem::GetPosition(size_t index) const {
+	assert(index < count_);
+	float radius = std::sin(halfApexAngle_[index]) * length_[index];
+	float height = std::cos(halfApexAngle_[index]) * length_[index];
+	float angle = angle_[index];
+	return { anchorX_[index] + std::cos(angle) * radius, anchorY_[index] - height, anchorZ_[index] - std::sin(angle) * radius };
+}
+
+void ConicalPendulumSystem::ComputePositions(std::vector<Vector3>& positions, JobSystem* jobSystem) const {
+	positions.resize(count_);
+	ParallelFor(jobSystem, PaddedSize(count_), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end && i < count_; i += kLanes) {
+			FloatN sinApex;
+			FloatN cosApex;
+			Simd::SinCos(FloatN::Load(&halfApexAngle_[i]), sinApex, cosApex);
+			FloatN sinAngle;
+			FloatN cosAngle;
+			Simd::SinCos(FloatN::Load(&angle_[i]), sinAngle, cosAngle);
+			FloatN length = FloatN::Load(&length_[i]);
+			FloatN radius = sinApex * length;
+			StorePositions(FloatN::Load(&anchorX_[i]) + cosAngle * radius, FloatN::Load(&anchorY_[i]) - cosApex * length, FloatN::Load(&anchorZ_[i]) - sinAngle * radius, i, count_, positions);
+		}
+		});
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+#include "AlignedAllocator.h"
+#include "JobSystem.h"
+
+enum class PendulumIntegrator {
+	kSymplecticEuler, //!< ω += α dt, θ += ω dt (1次、シンプレクティック)
+	kVelocityVerlet, //!< 速度ベルレ法 (2次、シンプレクティック。sin は1ステップ1回)
+	kRK4, //!< 4次のルンゲ・クッタ法 (誤差は小さいがエネルギーは少しずつ減る)
+};
+
+struct PendulumEnergyDrift {
+	float maxDrift; //!< 最大のずれ
+	float meanDrift; //!< 平均のずれ
+};
+
+// Pendulum をSoAで保持し、SIMDでまとめて進める (パラメータを振った大量の振り子用)
+//  sin / cos は Simd::SinCos の多項式近似を使う
+//  角加速度は -g / L * sin θ。エネルギーは単位質量あたり 1/2 (Lω)^2 + gL(1 - cos θ)
+class PendulumSystem {
+public:
+	size_t Add(const Pendulum& pendulum);
+	void Clear();
+	void Reserve(size_t capacity);
+	size_t Size() const { return count_; }
+
+	Pendulum Get(size_t index) const;
+	void Set(size_t index, const Pendulum& pendulum);
+
+	// 角加速度を求め直し、エネルギーの基準も新しい重力でのエネルギーにする (位置エネルギーが g に比例するため)
+	void SetGravity(float gravity);
+	float Gravity() const { return gravity_; }
+	void SetIntegrator(PendulumIntegrator integrator) { integrator_ = integrator; }
+	PendulumIntegrator Integrator() const { return integrator_; }
+
+	void Step(float deltaTime, JobSystem* jobSystem = nullptr);
+
+	// おもりの位置 (アンカーから XY 平面内に振れる)
+	Vector3 GetPosition(size_t index) const;
+	void ComputePositions(std::vector<Vector3>& positions, JobSystem* jobSystem = nullptr) const;
+
+	float Energy(size_t index) const;
+	// 現在のエネルギーを基準にする (Add / Set した振り子はその時点のエネルギーが基準)
+	void ResetEnergyReference(JobSystem* jobSystem = nullptr);
+	// 基準からのエネルギーのずれを gL で割った値の統計 (静止した振り子でも割り算が発散しない)
+	PendulumEnergyDrift ComputeEnergyDrift(JobSystem* jobSystem = nullptr) const;
+
+	const float* Angle() const { return angle_.data(); }
+	const float* AngularVelocity() const { return angularVelocity_.data(); }
+
+private:
+	void Resize(size_t count);
+	void ComputeEnergy(size_t begin, size_t end, float* energy) const;
+
+	PendulumIntegrator integrator_ = PendulumIntegrator::kVelocityVerlet;
+	float gravity_ = 9.8f;
+	size_t count_ = 0;
+
+	// 配列はSIMDの幅の倍数まで埋めてある (余りの要素は長さ1・静止の振り子)
+	AlignedVector<float> anchorX_;
+	AlignedVector<float> anchorY_;
+	AlignedVector<float> anchorZ_;
+	AlignedVector<float> length_;
+	AlignedVector<float> angle_;
+	AlignedVector<float> angularVelocity_;
+	AlignedVector<float> angularAcceleration_;
+	AlignedVector<float> referenceEnergy_;
+};
+
+// ConicalPendulum をSoAで保持し、SIMDでまとめて進める
+//  円錐振り子は等速円運動なので角速度 √(g / (L cos β)) で角度を正確に進める (積分方法は選ばない)
+//  角度は [-π, π] に折り返して、長く回しても sin / cos の精度が落ちないようにする
+class ConicalPendulumSystem {
+public:
+	// angularVelocity は半頂角と重力から求め直す
+	size_t Add(const ConicalPendulum& pendulum);
+	void Clear();
+	void Reserve(size_t capacity);
+	size_t Size() const { return count_; }
+
+	ConicalPendulum Get(size_t index) const;
+	void Set(size_t index, const ConicalPendulum& pendulum);
+
+	void SetGravity(float gravity);
+	float Gravity() const { return gravity_; }
+
+	void Step(float deltaTime, JobSystem* jobSystem = nullptr);
+
+	Vector3 GetPosition(size_t index) const;
+	void ComputePositions(std::vector<Vector3>& positions, JobSystem* jobSystem = nullptr) const;
+
+private:
+	void Resize(size_t count);
+	float AngularVelocity(float length, float halfApexAngle) const;
+
+	float gravity_ = 9.8f;
+	size_t count_ = 0;
+
+	AlignedVector<float> anchorX_;
+	AlignedVector<float> anchorY_;
+	AlignedVector<float> anchorZ_;
+	AlignedVector<float> length_;
+	AlignedVector<float> halfApexAngle_;
+	AlignedVector<float> angle_;
+	AlignedVector<float> angularVelocity_;
+};
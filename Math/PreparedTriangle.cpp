@@ -0,0 +1,73 @@
+#include "PreparedTriangle.h"
+#include <cmath>
+
+namespace {
+	// 平面との交点のパラメータを求める (平行なら false)
+	bool IntersectPlane(const PreparedTriangle& triangle, const Vector3& origin, const Vector3& diff, float& t) {
+		float dot = triangle.normal.Dot(diff);
+		if (dot == 0.0f) {
+			return false;
+		}
+		t = (triangle.distance - triangle.normal.Dot(origin)) / dot;
+		return true;
+	}
+
+	bool Contains(const PreparedTriangle& triangle, const Vector3& point) {
+		return triangle.edgeNormals[0].Dot(point) <= triangle.edgeDistances[0] &&
+			triangle.edgeNormals[1].Dot(point) <= triangle.edgeDistances[1] &&
+			triangle.edgeNormals[2].Dot(point) <= triangle.edgeDistances[2];
+	}
+}
+
+PreparedTriangle PrepareTriangle(const Triangle& triangle) {
+	PreparedTriangle prepared;
+	Vector3 normal = (triangle.vertices[1] - triangle.vertices[0]).Cross(triangle.vertices[2] - triangle.vertices[0]);
+	float length = normal.Length();
+	prepared.normal = length > 0.0f ? normal / length : Vector3{ 0.0f, 0.0f, 0.0f };
+	prepared.distance = prepared.normal.Dot(triangle.vertices[0]);
+
+	// isCollision の (v[i] - v[i+1]) × (v[i+1] - p)・n >= 0 を (n × (v[i] - v[i+1]))・p <= (n × (v[i] - v[i+1]))・v[i+1] に変形したもの
+	for (int i = 0; i < 3; ++i) {
+		const Vector3& start = triangle.vertices[i];
+		const Vector3& end = triangle.vertices[(i + 1) % 3];
+		prepared.edgeNormals[i] = prepared.normal.Cross(start - end);
+		prepared.edgeDistances[i] = prepared.edgeNormals[i].Dot(end);
+	}
+	return prepared;
+}
+
+void PrepareTriangles(const Triangle* triangles, size_t count, PreparedTriangle* prepared) {
+	for (size_t i = 0; i < count; ++i) {
+		prepared[i] = PrepareTriangle(triangles[i]);
+	}
+}
+
+std::vector<PreparedTriangle> PrepareTriangles(const std::vector<Triangle>& triangles) {
+	std::vector<PreparedTriangle> prepared(triangles.size());
+	PrepareTriangles(triangles.data(), triangles.size(), prepared.data());
+	return prepared;
+}
+
+bool Collision::isCollision(const PreparedTriangle& triangle, const Segment& segment) {
+	float t;
+	if (!IntersectPlane(triangle, segment.origin, segment.diff, t) || t < 0.0f || t > 1.0f) {
+		return false;
+	}
+	return Contains(triangle, segment.origin + segment.diff * t);
+}
+
+bool Collision::isCollision(const PreparedTriangle& triangle, const Ray& ray) {
+	float t;
+	if (!IntersectPlane(triangle, ray.origin, ray.diff, t) || t < 0.0f) {
+		return false;
+	}
+	return Contains(triangle, ray.origin + ray.diff * t);
+}
+
+bool Collision::isCollision(const PreparedTriangle& triangle, const Line& line) {
+	float t;
+	if (!IntersectPlane(triangle, line.origin, line.diff, t)) {
+		return false;
+	}
+	return Contains(triangle, line.origin + line.diff * t);
+}
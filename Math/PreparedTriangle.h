@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Math.h"
+
+// 交差判定用に前計算した三角形 (静的なメッシュを何度も判定するとき用)
+//  法線・平面の距離と、辺ごとの外向き法線を保持し、判定1回あたりの外積をなくす
+//  判定結果は Collision::isCollision(const Triangle&, ...) と同じく両面・辺上を含む
+struct PreparedTriangle {
+	Vector3 normal; //!< 単位法線 (縮退した三角形ならゼロベクトル)
+	float distance; //!< 平面の原点からの距離 (normal・頂点)
+	Vector3 edgeNormals[3]; //!< 辺の外向き法線 (normal × (辺の始点 - 終点))
+	float edgeDistances[3]; //!< edgeNormals[i]・辺の終点 (内側なら edgeNormals[i]・点 <= edgeDistances[i])
+};
+
+PreparedTriangle PrepareTriangle(const Triangle& triangle);
+// メッシュの三角形配列をまとめて変換する
+void PrepareTriangles(const Triangle* triangles, size_t count, PreparedTriangle* prepared);
+std::vector<PreparedTriangle> PrepareTriangles(const std::vector<Triangle>& triangles);
+
+namespace Collision {
+	bool isCollision(const PreparedTriangle& triangle, const Segment& segment);
+	bool isCollision(const PreparedTriangle& triangle, const Ray& ray);
+	bool isCollision(const PreparedTriangle& triangle, const Line& line);
+}
@@ -0,0 +1,196 @@
+#include "Profiler.h"
+
+#ifdef MT3_PROFILER_ENABLED
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+	// 記録したスレッドの ThreadBuffer (Profiler が所有する)
+	//  スレッドの終了時に手放し、別のスレッドが使い回せるようにする
+	struct LocalBufferHandle {
+		void* buffer = nullptr;
+		std::atomic<bool>* inUse = nullptr;
+		~LocalBufferHandle() {
+			if (inUse != nullptr) {
+				inUse->store(false, std::memory_order_release);
+			}
+		}
+	};
+	thread_local LocalBufferHandle tLocalBuffer;
+
+	// JSON の文字列として書き出す
+	void WriteJsonString(FILE* file, const char* text) {
+		std::fputc('"', file);
+		for (const char* c = text; *c != '\0'; ++c) {
+			if (*c == '"' || *c == '\\') {
+				std::fputc('\\', file);
+			}
+			std::fputc(*c, file);
+		}
+		std::fputc('"', file);
+	}
+
+	double Microseconds(int64_t nanoseconds) {
+		return static_cast<double>(nanoseconds) * 1e-3;
+	}
+
+	// フレームを並べるトレース上のスレッド番号 (実際のスレッドと重ならない値)
+	const uint32_t kFrameTrack = 0xFFFF;
+}
+
+Profiler& Profiler::Get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler() : epoch_(std::chrono::steady_clock::now()), history_(kHistorySize) {
+}
+
+int64_t Profiler::Now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+uint32_t Profiler::Register(const char* name, std::string* names, std::atomic<uint32_t>& count, uint32_t maxCount) {
+	std::lock_guard<std::mutex> lock(registerMutex_);
+	uint32_t registered = count.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < registered; ++i) {
+		if (names[i] == name) {
+			return i;
+		}
+	}
+	// 上限を超えたら最後の枠を共有する
+	assert(registered < maxCount);
+	if (registered == maxCount) {
+		return maxCount - 1;
+	}
+	names[registered] = name;
+	count.store(registered + 1, std::memory_order_release);
+	return registered;
+}
+
+uint32_t Profiler::RegisterZone(const char* name) {
+	return Register(name, zoneNames_, zoneCount_, kMaxZones);
+}
+
+uint32_t Profiler::RegisterCounter(const char* name) {
+	return Register(name, counterNames_, counterCount_, kMaxCounters);
+}
+
+Profiler::ThreadBuffer& Profiler::LocalBuffer() {
+	if (tLocalBuffer.buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(threadMutex_);
+		ThreadBuffer* buffer = nullptr;
+		// 終了したスレッドの記録を引き継ぐ (スレッドを作っては捨てても ThreadBuffer が増えない)
+		for (const std::unique_ptr<ThreadBuffer>& thread : threads_) {
+			if (!thread->inUse.load(std::memory_order_acquire)) {
+				thread->inUse.store(true, std::memory_order_relaxed);
+				buffer = thread.get();
+				break;
+			}
+		}
+		if (buffer == nullptr) {
+			threads_.push_back(std::make_unique<ThreadBuffer>());
+			buffer = threads_.back().get();
+			buffer->id = static_cast<uint32_t>(threads_.size() - 1);
+		}
+		tLocalBuffer.buffer = buffer;
+		tLocalBuffer.inUse = &buffer->inUse;
+	}
+	return *static_cast<ThreadBuffer*>(tLocalBuffer.buffer);
+}
+
+void Profiler::RecordZone(uint32_t zone, int64_t start, int64_t end) {
+	ThreadBuffer& buffer = LocalBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	if (buffer.events.size() < kMaxEventsPerFrame) {
+		buffer.events.push_back({ zone, buffer.id, start, end });
+	} else {
+		buffer.droppedTime[zone] += end - start;
+		buffer.droppedCalls[zone]++;
+		buffer.droppedEvents++;
+	}
+}
+
+void Profiler::EndFrame() {
+	int64_t now = Now();
+	Frame& frame = history_[historyHead_];
+	frame.index = frameIndex_++;
+	frame.start = frameStart_;
+	frame.duration = now - frameStart_;
+	std::memset(frame.zoneTime, 0, sizeof(frame.zoneTime));
+	std::memset(frame.zoneCalls, 0, sizeof(frame.zoneCalls));
+	frame.events.clear();
+	frame.droppedEvents = 0;
+
+	{
+		std::lock_guard<std::mutex> threadLock(threadMutex_);
+		for (const std::unique_ptr<ThreadBuffer>& thread : threads_) {
+			std::lock_guard<std::mutex> lock(thread->mutex);
+			for (uint32_t zone = 0; zone < kMaxZones; ++zone) {
+				frame.zoneTime[zone] += thread->droppedTime[zone];
+				frame.zoneCalls[zone] += thread->droppedCalls[zone];
+			}
+			frame.droppedEvents += thread->droppedEvents;
+			std::memset(thread->droppedTime, 0, sizeof(thread->droppedTime));
+			std::memset(thread->droppedCalls, 0, sizeof(thread->droppedCalls));
+			thread->droppedEvents = 0;
+			for (const Event& event : thread->events) {
+				frame.zoneTime[event.zone] += event.end - event.start;
+				frame.zoneCalls[event.zone]++;
+				if (frame.events.size() < kMaxEventsPerFrame) {
+					frame.events.push_back(event);
+				} else {
+					frame.droppedEvents++;
+				}
+			}
+			thread->events.clear();
+		}
+	}
+	for (uint32_t i = 0; i < kMaxCounters; ++i) {
+		frame.counters[i] = counters_[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	historyHead_ = (historyHead_ + 1) % kHistorySize;
+	historyCount_ = historyCount_ < kHistorySize ? historyCount_ + 1 : kHistorySize;
+	frameStart_ = now;
+}
+
+const Profiler::Frame& Profiler::GetFrame(size_t age) const {
+	assert(age < historyCount_);
+	return history_[(historyHead_ + kHistorySize - 1 - age) % kHistorySize];
+}
+
+bool Profiler::WriteChromeTrace(const char* path) const {
+	FILE* file = std::fopen(path, "w");
+	if (file == nullptr) {
+		return false;
+	}
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Frames\"}}", kFrameTrack);
+
+	uint32_t counterCount = CounterCount();
+	for (size_t age = historyCount_; age-- > 0;) {
+		const Frame& frame = GetFrame(age);
+		std::fprintf(file, ",\n{\"name\":\"Frame %llu\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			static_cast<unsigned long long>(frame.index), kFrameTrack, Microseconds(frame.start), Microseconds(frame.duration));
+		for (const Event& event : frame.events) {
+			std::fprintf(file, ",\n{\"name\":");
+			WriteJsonString(file, ZoneName(event.zone));
+			std::fprintf(file, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				event.thread, Microseconds(event.start), Microseconds(event.end - event.start));
+		}
+		// カウンタはフレームの開始時刻に、そのフレームの値として出す
+		for (uint32_t i = 0; i < counterCount; ++i) {
+			std::fprintf(file, ",\n{\"name\":");
+			WriteJsonString(file, CounterName(i));
+			std::fprintf(file, ",\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+				Microseconds(frame.start), static_cast<long long>(frame.counters[i]));
+		}
+	}
+	std::fprintf(file, "\n]}\n");
+	return std::fclose(file) == 0;
+}
+
+#endif
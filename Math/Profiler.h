@@ -0,0 +1,152 @@
+#pragma once
+
+// フレームごとの計測 (スコープ単位のゾーン・カウンタ・直近フレームの履歴)
+//  デバッグビルド (_DEBUG) か MT3_ENABLE_PROFILER を定義したときだけ有効になる
+//  無効なときは MT3_PROFILE_* マクロが空になり、Profiler クラスもコンパイルされない
+//
+//  MT3_PROFILE_ZONE("Physics");              // スコープの終わりまでを計測する
+//  MT3_PROFILE_COUNTER("Lines emitted", n);  // 今のフレームのカウンタに n を足す (無効なときは n を評価しない)
+//  MT3_PROFILE_FRAME();                      // フレームの区切り (メインループの最後で呼ぶ)
+#if defined(_DEBUG) || defined(MT3_ENABLE_PROFILER)
+#define MT3_PROFILER_ENABLED
+#endif
+
+#ifdef MT3_PROFILER_ENABLED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ゾーンとカウンタはどのスレッドからでも記録できる
+// EndFrame と履歴の読み出し・書き出しは同じスレッド (メインループ) から呼ぶ
+class Profiler {
+public:
+	static const uint32_t kMaxZones = 64;
+	static const uint32_t kMaxCounters = 32;
+	static const size_t kHistorySize = 240;
+	// 1フレームに保持するゾーンの記録の上限 (超えた分は合計時間には入るがトレースには出ない)
+	//  スレッドごとの記録もこの数で打ち切るので、EndFrame を呼ばずに走らせてもメモリは増え続けない
+	static const size_t kMaxEventsPerFrame = 8192;
+
+	struct Event {
+		uint32_t zone; //!< ゾーン
+		uint32_t thread; //!< 記録したスレッドの番号
+		int64_t start; //!< 開始時刻 (ns)
+		int64_t end; //!< 終了時刻 (ns)
+	};
+
+	struct Frame {
+		uint64_t index; //!< フレーム番号
+		int64_t start; //!< 開始時刻 (ns)
+		int64_t duration; //!< フレームの時間 (ns)
+		int64_t zoneTime[kMaxZones]; //!< ゾーンごとの合計時間 (ns、入れ子のゾーンは親にも含まれる)
+		uint32_t zoneCalls[kMaxZones]; //!< ゾーンごとの回数
+		int64_t counters[kMaxCounters]; //!< カウンタの値
+		std::vector<Event> events; //!< ゾーンの記録 (Chrome トレース用)
+		size_t droppedEvents; //!< 上限を超えて捨てた記録の数
+	};
+
+	static Profiler& Get();
+
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	// 同じ名前は同じ番号になる
+	uint32_t RegisterZone(const char* name);
+	uint32_t RegisterCounter(const char* name);
+	uint32_t ZoneCount() const { return zoneCount_.load(std::memory_order_acquire); }
+	uint32_t CounterCount() const { return counterCount_.load(std::memory_order_acquire); }
+	const char* ZoneName(uint32_t zone) const { return zoneNames_[zone].c_str(); }
+	const char* CounterName(uint32_t counter) const { return counterNames_[counter].c_str(); }
+
+	// 計測の基準時刻からの経過時間 (ns)
+	int64_t Now() const;
+	void RecordZone(uint32_t zone, int64_t start, int64_t end);
+	void AddCounter(uint32_t counter, int64_t value) { counters_[counter].fetch_add(value, std::memory_order_relaxed); }
+
+	// 今のフレームを閉じて履歴に入れ、次のフレームを始める
+	void EndFrame();
+
+	// 履歴のフレーム数と、age フレーム前 (0 が直前に閉じたフレーム) のフレーム
+	size_t FrameCount() const { return historyCount_; }
+	const Frame& GetFrame(size_t age) const;
+
+	// 履歴のフレームを Chrome のトレース形式 (chrome://tracing, Perfetto) で書き出す
+	bool WriteChromeTrace(const char* path) const;
+
+private:
+	// スレッドごとの記録 (スレッドが終了したら、次に記録を始めたスレッドが番号ごと引き継ぐ)
+	struct ThreadBuffer {
+		std::mutex mutex;
+		std::vector<Event> events;
+		int64_t droppedTime[kMaxZones] = {}; //!< 上限を超えて捨てた記録の合計時間
+		uint32_t droppedCalls[kMaxZones] = {}; //!< 上限を超えて捨てた記録の回数
+		size_t droppedEvents = 0; //!< 上限を超えて捨てた記録の数
+		uint32_t id = 0;
+		std::atomic<bool> inUse = true; //!< 記録しているスレッドが生きている
+	};
+
+	Profiler();
+	ThreadBuffer& LocalBuffer();
+	uint32_t Register(const char* name, std::string* names, std::atomic<uint32_t>& count, uint32_t maxCount);
+
+	std::chrono::steady_clock::time_point epoch_;
+
+	std::mutex registerMutex_;
+	std::string zoneNames_[kMaxZones];
+	std::string counterNames_[kMaxCounters];
+	std::atomic<uint32_t> zoneCount_ = 0;
+	std::atomic<uint32_t> counterCount_ = 0;
+	std::atomic<int64_t> counters_[kMaxCounters] = {};
+
+	std::mutex threadMutex_;
+	std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+
+	std::vector<Frame> history_;
+	size_t historyHead_ = 0;
+	size_t historyCount_ = 0;
+	uint64_t frameIndex_ = 0;
+	int64_t frameStart_ = 0;
+};
+
+// 生存期間をゾーンとして記録する
+class ProfileZone {
+public:
+	explicit ProfileZone(uint32_t zone) : zone_(zone), start_(Profiler::Get().Now()) {}
+	~ProfileZone() { Profiler::Get().RecordZone(zone_, start_, Profiler::Get().Now()); }
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	uint32_t zone_;
+	int64_t start_;
+};
+
+#define MT3_PROFILE_CONCAT_INNER(a, b) a##b
+#define MT3_PROFILE_CONCAT(a, b) MT3_PROFILE_CONCAT_INNER(a, b)
+
+#define MT3_PROFILE_ZONE(name) \
+	static const uint32_t MT3_PROFILE_CONCAT(mt3ProfileZoneId, __LINE__) = Profiler::Get().RegisterZone(name); \
+	ProfileZone MT3_PROFILE_CONCAT(mt3ProfileZone, __LINE__)(MT3_PROFILE_CONCAT(mt3ProfileZoneId, __LINE__))
+
+#define MT3_PROFILE_COUNTER(name, value) \
+	do { \
+		static const uint32_t mt3ProfileCounterId = Profiler::Get().RegisterCounter(name); \
+		Profiler::Get().AddCounter(mt3ProfileCounterId, static_cast<int64_t>(value)); \
+	} while (false)
+
+#define MT3_PROFILE_FRAME() Profiler::Get().EndFrame()
+
+#else
+
+#define MT3_PROFILE_ZONE(name)
+#define MT3_PROFILE_COUNTER(name, value) do {} while (false)
+#define MT3_PROFILE_FRAME() do {} while (false)
+
+#endif
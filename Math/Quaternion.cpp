@@ -0,0 +1,101 @@
+#include "Quaternion.h"
+#include <cassert>
+
+namespace {
+	// 単位クォータニオンの回転行列の 3x3 部分 (行ベクトルに右からかける形)
+	void RotationRows(const Quaternion& q, float rows[3][3]) {
+		float xx = q.x * q.x;
+		float yy = q.y * q.y;
+		float zz = q.z * q.z;
+		float xy = q.x * q.y;
+		float xz = q.x * q.z;
+		float yz = q.y * q.z;
+		float wx = q.w * q.x;
+		float wy = q.w * q.y;
+		float wz = q.w * q.z;
+		rows[0][0] = 1.0f - 2.0f * (yy + zz);
+		rows[0][1] = 2.0f * (xy + wz);
+		rows[0][2] = 2.0f * (xz - wy);
+		rows[1][0] = 2.0f * (xy - wz);
+		rows[1][1] = 1.0f - 2.0f * (xx + zz);
+		rows[1][2] = 2.0f * (yz + wx);
+		rows[2][0] = 2.0f * (xz + wy);
+		rows[2][1] = 2.0f * (yz - wx);
+		rows[2][2] = 1.0f - 2.0f * (xx + yy);
+	}
+}
+
+Quaternion IdentityQuaternion() {
+	return { 0.0f, 0.0f, 0.0f, 1.0f };
+}
+
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle) {
+	float s = std::sin(angle * 0.5f);
+	return { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f) };
+}
+
+Quaternion MakeRotateXYZQuaternion(const Vector3& rotate) {
+	float sx = std::sin(rotate.x * 0.5f);
+	float cx = std::cos(rotate.x * 0.5f);
+	float sy = std::sin(rotate.y * 0.5f);
+	float cy = std::cos(rotate.y * 0.5f);
+	float sz = std::sin(rotate.z * 0.5f);
+	float cz = std::cos(rotate.z * 0.5f);
+	// X, Y, Z の順に回すので qz * qy * qx を展開したもの
+	return {
+		sx * cy * cz - cx * sy * sz,
+		cx * sy * cz + sx * cy * sz,
+		cx * cy * sz - sx * sy * cz,
+		cx * cy * cz + sx * sy * sz,
+	};
+}
+
+Vector3 RotateVector(const Vector3& vector, const Quaternion& quaternion) {
+	// q v q* を展開した v + 2w (u × v) + 2 u × (u × v) (u は虚部)
+	Vector3 u = { quaternion.x, quaternion.y, quaternion.z };
+	Vector3 t = u.Cross(vector) * 2.0f;
+	return vector + t * quaternion.w + u.Cross(t);
+}
+
+Matrix4x4 MakeRotateMatrix(const Quaternion& quaternion) {
+	float rows[3][3];
+	RotationRows(quaternion, rows);
+	return {
+		rows[0][0],rows[0][1],rows[0][2],0.0f,
+		rows[1][0],rows[1][1],rows[1][2],0.0f,
+		rows[2][0],rows[2][1],rows[2][2],0.0f,
+		0.0f,0.0f,0.0f,1.0f
+	};
+}
+
+Matrix4x4 MakeAffineMatrixFromQuaternion(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	float rows[3][3];
+	RotationRows(rotate, rows);
+	return {
+		scale.x * rows[0][0],scale.x * rows[0][1],scale.x * rows[0][2],0.0f,
+		scale.y * rows[1][0],scale.y * rows[1][1],scale.y * rows[1][2],0.0f,
+		scale.z * rows[2][0],scale.z * rows[2][1],scale.z * rows[2][2],0.0f,
+		translate.x,translate.y,translate.z,1.0f
+	};
+}
+
+Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t) {
+	float dot = q0.Dot(q1);
+	Quaternion end = q1;
+	// q と -q は同じ回転なので、近い方へ補間する
+	if (dot < 0.0f) {
+		dot = -dot;
+		end = -q1;
+	}
+	// ほぼ同じ向きでは sin(θ) が0に近づくので線形補間して正規化する
+	const float kLinearThreshold = 0.9995f;
+	if (dot > kLinearThreshold) {
+		return (q0 * (1.0f - t) + end * t).Normalize();
+	}
+	float theta = std::acos(dot);
+	float sinTheta = std::sin(theta);
+	assert(sinTheta > 0.0f);
+	float scale0 = std::sin((1.0f - t) * theta) / sinTheta;
+	float scale1 = std::sin(t * theta) / sinTheta;
+	return q0 * scale0 + end * scale1;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cmath>
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+// 回転を表す単位クォータニオン (x, y, z が虚部、w が実部)
+//  a * b は「b で回してから a で回す」回転になる
+struct Quaternion {
+	float x, y, z, w;
+
+	Quaternion operator-() const {
+		return { -x, -y, -z, -w };
+	}
+
+	Quaternion operator+(const Quaternion& quaternion) const {
+		return { x + quaternion.x, y + quaternion.y, z + quaternion.z, w + quaternion.w };
+	}
+
+	Quaternion operator-(const Quaternion& quaternion) const {
+		return { x - quaternion.x, y - quaternion.y, z - quaternion.z, w - quaternion.w };
+	}
+
+	Quaternion operator*(const Quaternion& q) const {
+		return {
+			w * q.x + x * q.w + y * q.z - z * q.y,
+			w * q.y - x * q.z + y * q.w + z * q.x,
+			w * q.z + x * q.y - y * q.x + z * q.w,
+			w * q.w - x * q.x - y * q.y - z * q.z,
+		};
+	}
+
+	Quaternion operator*(const float& scalar) const {
+		return { x * scalar, y * scalar, z * scalar, w * scalar };
+	}
+
+	float Dot(const Quaternion& quaternion) const {
+		return x * quaternion.x + y * quaternion.y + z * quaternion.z + w * quaternion.w;
+	}
+
+	float Norm() const {
+		return std::sqrt(x * x + y * y + z * z + w * w);
+	}
+
+	Quaternion Normalize() const {
+		float norm = Norm();
+		return { x / norm, y / norm, z / norm, w / norm };
+	}
+
+	Quaternion Conjugate() const {
+		return { -x, -y, -z, w };
+	}
+
+	Quaternion Inverse() const {
+		float normSquared = x * x + y * y + z * z + w * w;
+		return { -x / normSquared, -y / normSquared, -z / normSquared, w / normSquared };
+	}
+};
+
+Quaternion IdentityQuaternion();
+// axis (単位ベクトル) まわりに angle ラジアン回す
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle);
+// MakeAffineMatrix と同じ X → Y → Z の順のオイラー角 (MakeRotateXMatrix * MakeRotateYMatrix * MakeRotateZMatrix と同じ回転)
+Quaternion MakeRotateXYZQuaternion(const Vector3& rotate);
+
+Vector3 RotateVector(const Vector3& vector, const Quaternion& quaternion);
+// 回転行列を直接作る (行列の積も三角関数も使わない)
+Matrix4x4 MakeRotateMatrix(const Quaternion& quaternion);
+// 拡大・回転・平行移動の行列を直接作る (scale * 回転行列 * translate と同じ)
+Matrix4x4 MakeAffineMatrixFromQuaternion(const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+
+// 球面線形補間 (q0 と q1 の近い方の回りで補間する)
+Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t);
@@ -0,0 +1,182 @@
+#include "RayPacket.h"
+#include <cmath>
+#include "SimdFloat.h"
+
+namespace {
+	using Simd::Float4;
+#if defined(MT3_SIMD_AVX)
+	using Simd::Float8;
+#endif
+
+	// 軸に平行なレーンは、始点がスラブの内側なら制限なし、外側なら外れにする
+	template<typename V>
+	void Slab(V origin, V diff, float min, float max, V& tMin, V& tMax, V& miss) {
+		V zero = V::Set(0.0f);
+		V boxMin = V::Set(min);
+		V boxMax = V::Set(max);
+		V parallel = Equal(diff, zero);
+		V outside = Or(Less(origin, boxMin), Less(boxMax, origin));
+		miss = Or(miss, And(parallel, outside));
+
+		V inv = V::Set(1.0f) / diff;
+		V t1 = Select(parallel, V::Set(-INFINITY), (boxMin - origin) * inv);
+		V t2 = Select(parallel, V::Set(INFINITY), (boxMax - origin) * inv);
+		tMin = Max(tMin, Min(t1, t2));
+		tMax = Min(tMax, Max(t1, t2));
+	}
+
+	template<typename V, size_t N>
+	uint32_t IntersectLanes(const AABB& aabb, const RayPacket<N>& rays, size_t offset, float* t) {
+		V tMin = V::Set(-INFINITY);
+		V tMax = V::Set(INFINITY);
+		V miss = V::Set(0.0f);
+		Slab(V::Load(rays.originX + offset), V::Load(rays.diffX + offset), aabb.min.x, aabb.max.x, tMin, tMax, miss);
+		Slab(V::Load(rays.originY + offset), V::Load(rays.diffY + offset), aabb.min.y, aabb.max.y, tMin, tMax, miss);
+		Slab(V::Load(rays.originZ + offset), V::Load(rays.diffZ + offset), aabb.min.z, aabb.max.z, tMin, tMax, miss);
+
+		V zero = V::Set(0.0f);
+		V hit = AndNot(miss, And(LessEqual(tMin, tMax), LessEqual(zero, tMax)));
+		Select(hit, Max(tMin, zero), V::Set(INFINITY)).Store(t + offset);
+		return MoveMask(hit) << offset;
+	}
+
+	// Möller–Trumbore法 (辺は前計算して全レーンで共有する)
+	template<typename V, size_t N>
+	uint32_t IntersectLanes(const Triangle& triangle, const Vector3& edge1, const Vector3& edge2, const RayPacket<N>& rays, size_t offset, float* t) {
+		V ox = V::Load(rays.originX + offset);
+		V oy = V::Load(rays.originY + offset);
+		V oz = V::Load(rays.originZ + offset);
+		V dx = V::Load(rays.diffX + offset);
+		V dy = V::Load(rays.diffY + offset);
+		V dz = V::Load(rays.diffZ + offset);
+		V e1x = V::Set(edge1.x), e1y = V::Set(edge1.y), e1z = V::Set(edge1.z);
+		V e2x = V::Set(edge2.x), e2y = V::Set(edge2.y), e2z = V::Set(edge2.z);
+
+		// p = diff × edge2
+		V px = dy * e2z - dz * e2y;
+		V py = dz * e2x - dx * e2z;
+		V pz = dx * e2y - dy * e2x;
+		V det = e1x * px + e1y * py + e1z * pz;
+		V invDet = V::Set(1.0f) / det;
+
+		// s = origin - v0
+		V sx = ox - V::Set(triangle.vertices[0].x);
+		V sy = oy - V::Set(triangle.vertices[0].y);
+		V sz = oz - V::Set(triangle.vertices[0].z);
+		V u = (sx * px + sy * py + sz * pz) * invDet;
+
+		// q = s × edge1
+		V qx = sy * e1z - sz * e1y;
+		V qy = sz * e1x - sx * e1z;
+		V qz = sx * e1y - sy * e1x;
+		V v = (dx * qx + dy * qy + dz * qz) * invDet;
+		V hitT = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+		V zero = V::Set(0.0f);
+		V hit = AndNot(Equal(det, zero), LessEqual(zero, u));
+		hit = And(hit, LessEqual(zero, v));
+		hit = And(hit, LessEqual(u + v, V::Set(1.0f)));
+		hit = And(hit, LessEqual(zero, hitT));
+		Select(hit, hitT, V::Set(INFINITY)).Store(t + offset);
+		return MoveMask(hit) << offset;
+	}
+
+	template<typename V>
+	V Dot(const Vector3& a, V x, V y, V z) {
+		return V::Set(a.x) * x + V::Set(a.y) * y + V::Set(a.z) * z;
+	}
+
+	// 平面との交点を求め、辺の外向き法線で内側か調べる (PreparedTriangle のスカラー版と同じ順で計算する)
+	template<typename V, size_t N>
+	uint32_t IntersectLanes(const PreparedTriangle& triangle, const RayPacket<N>& rays, size_t offset, float* t) {
+		V ox = V::Load(rays.originX + offset);
+		V oy = V::Load(rays.originY + offset);
+		V oz = V::Load(rays.originZ + offset);
+		V dx = V::Load(rays.diffX + offset);
+		V dy = V::Load(rays.diffY + offset);
+		V dz = V::Load(rays.diffZ + offset);
+
+		V zero = V::Set(0.0f);
+		V dot = Dot(triangle.normal, dx, dy, dz);
+		V hitT = (V::Set(triangle.distance) - Dot(triangle.normal, ox, oy, oz)) / dot;
+		V px = ox + dx * hitT;
+		V py = oy + dy * hitT;
+		V pz = oz + dz * hitT;
+
+		V hit = AndNot(Equal(dot, zero), LessEqual(zero, hitT));
+		for (int i = 0; i < 3; ++i) {
+			hit = And(hit, LessEqual(Dot(triangle.edgeNormals[i], px, py, pz), V::Set(triangle.edgeDistances[i])));
+		}
+		Select(hit, hitT, V::Set(INFINITY)).Store(t + offset);
+		return MoveMask(hit) << offset;
+	}
+
+	// 無効なレーンの結果を捨てる
+	template<size_t N>
+	void ApplyActiveMask(RayPacketHit<N>& result, const RayPacket<N>& rays) {
+		result.mask &= rays.activeMask;
+		for (size_t lane = 0; lane < N; ++lane) {
+			if ((result.mask & (1u << lane)) == 0) {
+				result.t[lane] = INFINITY;
+			}
+		}
+	}
+}
+
+RayPacketHit<4> Collision::Intersect(const AABB& aabb, const RayPacket4& rays) {
+	RayPacketHit<4> result;
+	result.mask = IntersectLanes<Float4>(aabb, rays, 0, result.t);
+	ApplyActiveMask(result, rays);
+	return result;
+}
+
+RayPacketHit<8> Collision::Intersect(const AABB& aabb, const RayPacket8& rays) {
+	RayPacketHit<8> result;
+#if defined(MT3_SIMD_AVX)
+	result.mask = IntersectLanes<Float8>(aabb, rays, 0, result.t);
+#else
+	result.mask = IntersectLanes<Float4>(aabb, rays, 0, result.t) | IntersectLanes<Float4>(aabb, rays, 4, result.t);
+#endif
+	ApplyActiveMask(result, rays);
+	return result;
+}
+
+RayPacketHit<4> Collision::Intersect(const Triangle& triangle, const RayPacket4& rays) {
+	Vector3 edge1 = triangle.vertices[1] - triangle.vertices[0];
+	Vector3 edge2 = triangle.vertices[2] - triangle.vertices[0];
+	RayPacketHit<4> result;
+	result.mask = IntersectLanes<Float4>(triangle, edge1, edge2, rays, 0, result.t);
+	ApplyActiveMask(result, rays);
+	return result;
+}
+
+RayPacketHit<8> Collision::Intersect(const Triangle& triangle, const RayPacket8& rays) {
+	Vector3 edge1 = triangle.vertices[1] - triangle.vertices[0];
+	Vector3 edge2 = triangle.vertices[2] - triangle.vertices[0];
+	RayPacketHit<8> result;
+#if defined(MT3_SIMD_AVX)
+	result.mask = IntersectLanes<Float8>(triangle, edge1, edge2, rays, 0, result.t);
+#else
+	result.mask = IntersectLanes<Float4>(triangle, edge1, edge2, rays, 0, result.t) | IntersectLanes<Float4>(triangle, edge1, edge2, rays, 4, result.t);
+#endif
+	ApplyActiveMask(result, rays);
+	return result;
+}
+
+RayPacketHit<4> Collision::Intersect(const PreparedTriangle& triangle, const RayPacket4& rays) {
+	RayPacketHit<4> result;
+	result.mask = IntersectLanes<Float4>(triangle, rays, 0, result.t);
+	ApplyActiveMask(result, rays);
+	return result;
+}
+
+RayPacketHit<8> Collision::Intersect(const PreparedTriangle& triangle, const RayPacket8& rays) {
+	RayPacketHit<8> result;
+#if defined(MT3_SIMD_AVX)
+	result.mask = IntersectLanes<Float8>(triangle, rays, 0, result.t);
+#else
+	result.mask = IntersectLanes<Float4>(triangle, rays, 0, result.t) | IntersectLanes<Float4>(triangle, rays, 4, result.t);
+#endif
+	ApplyActiveMask(result, rays);
+	return result;
+}
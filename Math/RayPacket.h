@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Math.h"
+#include "PreparedTriangle.h"
+
+// N本のレイをSoA(成分ごとの配列)で保持するパケット
+//  activeMask のビットが立っているレーンだけが判定の対象になる (Set していないレーンは0のまま)
+template<size_t N>
+struct RayPacket {
+	static_assert(N == 4 || N == 8, "RayPacket supports 4 or 8 lanes");
+
+	alignas(32) float originX[N] = {}; //!< 始点X
+	alignas(32) float originY[N] = {}; //!< 始点Y
+	alignas(32) float originZ[N] = {}; //!< 始点Z
+	alignas(32) float diffX[N] = {}; //!< 方向X
+	alignas(32) float diffY[N] = {}; //!< 方向Y
+	alignas(32) float diffZ[N] = {}; //!< 方向Z
+	uint32_t activeMask = 0; //!< 有効なレーンのビットマスク
+
+	void Set(size_t lane, const Ray& ray) {
+		originX[lane] = ray.origin.x;
+		originY[lane] = ray.origin.y;
+		originZ[lane] = ray.origin.z;
+		diffX[lane] = ray.diff.x;
+		diffY[lane] = ray.diff.y;
+		diffZ[lane] = ray.diff.z;
+		activeMask |= 1u << lane;
+	}
+
+	Ray Get(size_t lane) const {
+		return { { originX[lane], originY[lane], originZ[lane] }, { diffX[lane], diffY[lane], diffZ[lane] } };
+	}
+};
+
+using RayPacket4 = RayPacket<4>;
+using RayPacket8 = RayPacket<8>;
+
+template<size_t N>
+struct RayPacketHit {
+	uint32_t mask; //!< 当たったレーンのビットマスク
+	alignas(32) float t[N]; //!< 交差パラメータ (当たらなかったレーンは INFINITY)
+};
+
+// パケット単位のレイ判定
+//  判定の範囲は Collision::isCollision(const AABB&, const Ray&) / (const Triangle&, const Ray&) と同じ
+//  AABB の t は箱に入る位置 (始点が内側なら0)、Triangle は両面・辺上を含む
+//  同じ三角形に何度もパケットを当てるときは PreparedTriangle を渡すと辺の計算を毎回しなくて済む
+//  (判定は Collision::isCollision(const PreparedTriangle&, const Ray&) と同じ式で行う)
+namespace Collision {
+	RayPacketHit<4> Intersect(const AABB& aabb, const RayPacket4& rays);
+	RayPacketHit<8> Intersect(const AABB& aabb, const RayPacket8& rays);
+	RayPacketHit<4> Intersect(const Triangle& triangle, const RayPacket4& rays);
+	RayPacketHit<8> Intersect(const Triangle& triangle, const RayPacket8& rays);
+	RayPacketHit<4> Intersect(const PreparedTriangle& triangle, const RayPacket4& rays);
+	RayPacketHit<8> Intersect(const PreparedTriangle& triangle, const RayPacket8& rays);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// SIMD命令セットのコンパイル時選択
+//  MT3_SIMD_AVX  : AVX (SSEも併用)
+//  MT3_SIMD_SSE  : SSE2 (x64では常に有効)
+//  MT3_SIMD_NEON : ARM NEON (AArch64)
+//  どれも定義されない場合はスカラー実装にフォールバックする
+//  MT3_NO_SIMD を定義すると強制的にスカラー実装を使う
+
+#if !defined(MT3_NO_SIMD)
+#if defined(__AVX__)
+#define MT3_SIMD_AVX
+#define MT3_SIMD_SSE
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MT3_SIMD_SSE
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MT3_SIMD_NEON
+#endif
+#endif
+
+#if defined(MT3_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(MT3_SIMD_SSE)
+#include <emmintrin.h>
+#elif defined(MT3_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(MT3_SIMD_SSE)
+#define MT3_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#endif
@@ -0,0 +1,188 @@
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "Simd.h"
+
+// Simd.h で選ばれた命令セットの浮動小数点ベクトル
+//  SoA の配列を4/8要素ずつ処理するカーネルで使う (Load/Store は16/32バイト境界に揃えたアドレスが必要。揃っていない配列は LoadUnaligned)
+//  RsqrtEstimate / ReciprocalEstimate は相対誤差 1.5 * 2^-12 程度の推定値 (スカラー実装では正確な値)
+namespace Simd {
+	// 4レーンの浮動小数点ベクトル (比較結果は全ビットが立ったレーンのマスク)
+	struct Float4 {
+#if defined(MT3_SIMD_SSE)
+		__m128 v;
+		static Float4 Load(const float* p) { return { _mm_load_ps(p) }; }
+		static Float4 LoadUnaligned(const float* p) { return { _mm_loadu_ps(p) }; }
+		static Float4 Set(float s) { return { _mm_set1_ps(s) }; }
+		void Store(float* p) const { _mm_store_ps(p, v); }
+		friend Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+		friend Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+		friend Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+		friend Float4 operator/(Float4 a, Float4 b) { return { _mm_div_ps(a.v, b.v) }; }
+		friend Float4 Min(Float4 a, Float4 b) { return { _mm_min_ps(a.v, b.v) }; }
+		friend Float4 Max(Float4 a, Float4 b) { return { _mm_max_ps(a.v, b.v) }; }
+		friend Float4 Sqrt(Float4 a) { return { _mm_sqrt_ps(a.v) }; }
+		friend Float4 RsqrtEstimate(Float4 a) { return { _mm_rsqrt_ps(a.v) }; }
+		friend Float4 ReciprocalEstimate(Float4 a) { return { _mm_rcp_ps(a.v) }; }
+		friend Float4 Less(Float4 a, Float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+		friend Float4 LessEqual(Float4 a, Float4 b) { return { _mm_cmple_ps(a.v, b.v) }; }
+		friend Float4 Equal(Float4 a, Float4 b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+		friend Float4 And(Float4 a, Float4 b) { return { _mm_and_ps(a.v, b.v) }; }
+		friend Float4 AndNot(Float4 a, Float4 b) { return { _mm_andnot_ps(a.v, b.v) }; }
+		friend Float4 Or(Float4 a, Float4 b) { return { _mm_or_ps(a.v, b.v) }; }
+		friend Float4 Select(Float4 mask, Float4 a, Float4 b) { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+		friend uint32_t MoveMask(Float4 mask) { return static_cast<uint32_t>(_mm_movemask_ps(mask.v)); }
+#elif defined(MT3_SIMD_NEON)
+		float32x4_t v;
+		static Float4 Load(const float* p) { return { vld1q_f32(p) }; }
+		static Float4 LoadUnaligned(const float* p) { return { vld1q_f32(p) }; }
+		static Float4 Set(float s) { return { vdupq_n_f32(s) }; }
+		void Store(float* p) const { vst1q_f32(p, v); }
+		friend Float4 operator+(Float4 a, Float4 b) { return { vaddq_f32(a.v, b.v) }; }
+		friend Float4 operator-(Float4 a, Float4 b) { return { vsubq_f32(a.v, b.v) }; }
+		friend Float4 operator*(Float4 a, Float4 b) { return { vmulq_f32(a.v, b.v) }; }
+		friend Float4 operator/(Float4 a, Float4 b) { return { vdivq_f32(a.v, b.v) }; }
+		friend Float4 Min(Float4 a, Float4 b) { return { vminq_f32(a.v, b.v) }; }
+		friend Float4 Max(Float4 a, Float4 b) { return { vmaxq_f32(a.v, b.v) }; }
+		friend Float4 Sqrt(Float4 a) { return { vsqrtq_f32(a.v) }; }
+		// NEON の推定値は8ビット程度なので、ニュートン法を1回入れてSSEと同じくらいの精度にする
+		friend Float4 RsqrtEstimate(Float4 a) {
+			float32x4_t y = vrsqrteq_f32(a.v);
+			return { vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(a.v, y), y)) };
+		}
+		friend Float4 ReciprocalEstimate(Float4 a) {
+			float32x4_t y = vrecpeq_f32(a.v);
+			return { vmulq_f32(y, vrecpsq_f32(a.v, y)) };
+		}
+		friend Float4 Less(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vcltq_f32(a.v, b.v)) }; }
+		friend Float4 LessEqual(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vcleq_f32(a.v, b.v)) }; }
+		friend Float4 Equal(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vceqq_f32(a.v, b.v)) }; }
+		friend Float4 And(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) }; }
+		friend Float4 AndNot(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(b.v), vreinterpretq_u32_f32(a.v))) }; }
+		friend Float4 Or(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) }; }
+		friend Float4 Select(Float4 mask, Float4 a, Float4 b) { return { vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v) }; }
+		friend uint32_t MoveMask(Float4 mask) {
+			const uint32_t kBits[4] = { 1, 2, 4, 8 };
+			return vaddvq_u32(vandq_u32(vreinterpretq_u32_f32(mask.v), vld1q_u32(kBits)));
+		}
+#else
+		float v[4];
+		static Float4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+		static Float4 LoadUnaligned(const float* p) { return Load(p); }
+		static Float4 Set(float s) { return { { s, s, s, s } }; }
+		void Store(float* p) const { for (size_t i = 0; i < 4; ++i) { p[i] = v[i]; } }
+		template<typename Function>
+		static Float4 Map(Float4 a, Float4 b, Function function) {
+			Float4 result;
+			for (size_t i = 0; i < 4; ++i) {
+				result.v[i] = function(a.v[i], b.v[i]);
+			}
+			return result;
+		}
+		static float FromBool(bool b) { return b ? std::bit_cast<float>(0xffffffffu) : 0.0f; }
+		static bool ToBool(float f) { return std::bit_cast<uint32_t>(f) != 0; }
+		friend Float4 operator+(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x + y; }); }
+		friend Float4 operator-(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x - y; }); }
+		friend Float4 operator*(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x * y; }); }
+		friend Float4 operator/(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x / y; }); }
+		friend Float4 Min(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+		friend Float4 Max(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+		friend Float4 Sqrt(Float4 a) { return Map(a, a, [](float x, float) { return std::sqrt(x); }); }
+		friend Float4 RsqrtEstimate(Float4 a) { return Map(a, a, [](float x, float) { return 1.0f / std::sqrt(x); }); }
+		friend Float4 ReciprocalEstimate(Float4 a) { return Map(a, a, [](float x, float) { return 1.0f / x; }); }
+		friend Float4 Less(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return FromBool(x < y); }); }
+		friend Float4 LessEqual(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return FromBool(x <= y); }); }
+		friend Float4 Equal(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return FromBool(x == y); }); }
+		friend Float4 And(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return FromBool(ToBool(x) && ToBool(y)); }); }
+		friend Float4 AndNot(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return FromBool(!ToBool(x) && ToBool(y)); }); }
+		friend Float4 Or(Float4 a, Float4 b) { return Map(a, b, [](float x, float y) { return FromBool(ToBool(x) || ToBool(y)); }); }
+		friend Float4 Select(Float4 mask, Float4 a, Float4 b) {
+			Float4 result;
+			for (size_t i = 0; i < 4; ++i) {
+				result.v[i] = ToBool(mask.v[i]) ? a.v[i] : b.v[i];
+			}
+			return result;
+		}
+		friend uint32_t MoveMask(Float4 mask) {
+			uint32_t result = 0;
+			for (size_t i = 0; i < 4; ++i) {
+				result |= ToBool(mask.v[i]) ? 1u << i : 0u;
+			}
+			return result;
+		}
+#endif
+	};
+
+#if defined(MT3_SIMD_AVX)
+	// 8レーン版 (AVX)
+	struct Float8 {
+		__m256 v;
+		static Float8 Load(const float* p) { return { _mm256_load_ps(p) }; }
+		static Float8 LoadUnaligned(const float* p) { return { _mm256_loadu_ps(p) }; }
+		static Float8 Set(float s) { return { _mm256_set1_ps(s) }; }
+		void Store(float* p) const { _mm256_store_ps(p, v); }
+		friend Float8 operator+(Float8 a, Float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+		friend Float8 operator-(Float8 a, Float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+		friend Float8 operator*(Float8 a, Float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+		friend Float8 operator/(Float8 a, Float8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+		friend Float8 Min(Float8 a, Float8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+		friend Float8 Max(Float8 a, Float8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+		friend Float8 Sqrt(Float8 a) { return { _mm256_sqrt_ps(a.v) }; }
+		friend Float8 RsqrtEstimate(Float8 a) { return { _mm256_rsqrt_ps(a.v) }; }
+		friend Float8 ReciprocalEstimate(Float8 a) { return { _mm256_rcp_ps(a.v) }; }
+		friend Float8 Less(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+		friend Float8 LessEqual(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+		friend Float8 Equal(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+		friend Float8 And(Float8 a, Float8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+		friend Float8 AndNot(Float8 a, Float8 b) { return { _mm256_andnot_ps(a.v, b.v) }; }
+		friend Float8 Or(Float8 a, Float8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+		friend Float8 Select(Float8 mask, Float8 a, Float8 b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+		friend uint32_t MoveMask(Float8 mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask.v)); }
+	};
+#endif
+
+	// 最も近い整数に丸める (|x| < 2^22 の範囲。1.5 * 2^23 を足して引くと仮数部の端数が丸められる)
+	template<typename V>
+	V Round(V x) {
+		V magic = V::Set(12582912.0f);
+		return (x + magic) - magic;
+	}
+
+	// x を π/2 の倍数 q と余り r (|r| <= π/4) に分ける。quadrant は q mod 4
+	template<typename V>
+	void SinCosReduce(V x, V& r, V& quadrant) {
+		V q = Round(x * V::Set(0.636619772f));
+		// π/2 を3つに分けて引き、桁落ちを抑える
+		r = x - q * V::Set(1.5703125f) - q * V::Set(4.83751297e-4f) - q * V::Set(7.54978995e-8f);
+		// q mod 4 (整数の q について (q - 1.5) / 4 の丸めは floor(q / 4) になる)
+		quadrant = q - Round((q - V::Set(1.5f)) * V::Set(0.25f)) * V::Set(4.0f);
+	}
+
+	// 余り r の sin / cos から象限に応じて元の角度の sin / cos を組み立てる
+	template<typename V>
+	void SinCosSelect(V sinR, V cosR, V quadrant, V& sinResult, V& cosResult) {
+		V zero = V::Set(0.0f);
+		V odd = Or(Equal(quadrant, V::Set(1.0f)), Equal(quadrant, V::Set(3.0f)));
+		V sinValue = Select(odd, cosR, sinR);
+		V cosValue = Select(odd, sinR, cosR);
+		V sinNegative = LessEqual(V::Set(2.0f), quadrant);
+		V cosNegative = Or(Equal(quadrant, V::Set(1.0f)), Equal(quadrant, V::Set(2.0f)));
+		sinResult = Select(sinNegative, zero - sinValue, sinValue);
+		cosResult = Select(cosNegative, zero - cosValue, cosValue);
+	}
+
+	// sin と cos の近似 (|x| が数千ラジアン程度までで誤差は約1e-7)
+	//  余り r の多項式と q の下位2ビットで象限を選ぶ
+	template<typename V>
+	void SinCos(V x, V& sinResult, V& cosResult) {
+		V r;
+		V quadrant;
+		SinCosReduce(x, r, quadrant);
+		V r2 = r * r;
+		V sinR = r + r * r2 * (V::Set(-1.6666654611e-1f) + r2 * (V::Set(8.3321608736e-3f) + r2 * V::Set(-1.9515295891e-4f)));
+		V cosR = V::Set(1.0f) - V::Set(0.5f) * r2 + r2 * r2 * (V::Set(4.166664568e-2f) + r2 * (V::Set(-1.388731625e-3f) + r2 * V::Set(2.443315711e-5f)));
+		SinCosSelect(sinR, cosR, quadrant, sinResult, cosResult);
+	}
+}
@@ -0,0 +1,379 @@
+#include "SpatialHashGrid.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+	const size_t kChunkSize = 4096;
+	// 並列のカウンティングソートで先に振り分ける上位の桁のビット数
+	const uint32_t kDigitBits = 8;
+	// 近傍探索で調べるセル範囲の上限 (超える場合はセルを大きくする)
+	const int32_t kMaxSearchRange = 3;
+	const size_t kMaxGatherBuckets = (kMaxSearchRange * 2 + 1) * (kMaxSearchRange * 2 + 1) * (kMaxSearchRange * 2 + 1);
+
+	uint32_t NextPowerOfTwo(size_t value) {
+		uint32_t result = 1;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	void ParallelFor(JobSystem* jobSystem, size_t count, const JobSystem::RangeFunction& function) {
+		if (jobSystem == nullptr) {
+			function(0, count);
+			return;
+		}
+		jobSystem->ParallelFor(count, kChunkSize, function);
+	}
+
+	// kChunkSize ごとの区間に分けて function(チャンク番号, begin, end) を呼ぶ (チャンクごとの集計用)
+	template<typename Function>
+	void ParallelForChunks(JobSystem* jobSystem, size_t count, const Function& function) {
+		ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+			for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += kChunkSize) {
+				function(chunkBegin / kChunkSize, chunkBegin, std::min(chunkBegin + kChunkSize, end));
+			}
+			});
+	}
+
+	struct Bounds {
+		float maxRadius;
+		float min[3];
+		float max[3];
+	};
+}
+
+void SpatialHashGrid::Build(const Sphere* spheres, size_t count, JobSystem* jobSystem) {
+	centerX_.resize(count);
+	centerY_.resize(count);
+	centerZ_.resize(count);
+	radius_.resize(count);
+	ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			centerX_[i] = spheres[i].center.x;
+			centerY_[i] = spheres[i].center.y;
+			centerZ_[i] = spheres[i].center.z;
+			radius_[i] = spheres[i].radius;
+		}
+		});
+	Prepare(jobSystem);
+}
+
+void SpatialHashGrid::Build(const BallSystem& balls, JobSystem* jobSystem) {
+	size_t count = balls.Size();
+	centerX_.resize(count);
+	centerY_.resize(count);
+	centerZ_.resize(count);
+	radius_.resize(count);
+	ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+		std::copy(balls.PositionX() + begin, balls.PositionX() + end, centerX_.begin() + begin);
+		std::copy(balls.PositionY() + begin, balls.PositionY() + end, centerY_.begin() + begin);
+		std::copy(balls.PositionZ() + begin, balls.PositionZ() + end, centerZ_.begin() + begin);
+		std::copy(balls.Radius() + begin, balls.Radius() + end, radius_.begin() + begin);
+		});
+	Prepare(jobSystem);
+}
+
+void SpatialHashGrid::Prepare(JobSystem* jobSystem) {
+	size_t count = radius_.size();
+
+	// セルの大きさは指定がなければ最大直径にして、隣接する27セルだけを調べれば済むようにする
+	//  範囲と最大半径はチャンクごとに求めてからまとめる
+	const Bounds kEmpty = { 0.0f, { INFINITY, INFINITY, INFINITY }, { -INFINITY, -INFINITY, -INFINITY } };
+	std::vector<Bounds> chunkBounds((count + kChunkSize - 1) / kChunkSize, kEmpty);
+	ParallelForChunks(jobSystem, count, [&](size_t chunk, size_t begin, size_t end) {
+		Bounds bounds = kEmpty;
+		for (size_t i = begin; i < end; ++i) {
+			bounds.maxRadius = std::max(bounds.maxRadius, radius_[i]);
+			bounds.min[0] = std::min(bounds.min[0], centerX_[i]);
+			bounds.min[1] = std::min(bounds.min[1], centerY_[i]);
+			bounds.min[2] = std::min(bounds.min[2], centerZ_[i]);
+			bounds.max[0] = std::max(bounds.max[0], centerX_[i]);
+			bounds.max[1] = std::max(bounds.max[1], centerY_[i]);
+			bounds.max[2] = std::max(bounds.max[2], centerZ_[i]);
+		}
+		chunkBounds[chunk] = bounds;
+		});
+	float maxRadius = 0.0f;
+	float min[3] = { INFINITY, INFINITY, INFINITY };
+	float max[3] = { -INFINITY, -INFINITY, -INFINITY };
+	for (const Bounds& bounds : chunkBounds) {
+		maxRadius = std::max(maxRadius, bounds.maxRadius);
+		for (int axis = 0; axis < 3; ++axis) {
+			min[axis] = std::min(min[axis], bounds.min[axis]);
+			max[axis] = std::max(max[axis], bounds.max[axis]);
+		}
+	}
+	float cellSize = requestedCellSize_ > 0.0f ? requestedCellSize_ : 2.0f * maxRadius;
+	cellSize = std::max(cellSize, 2.0f * maxRadius / static_cast<float>(kMaxSearchRange));
+	if (cellSize <= 0.0f) {
+		cellSize = 1.0f;
+	}
+	maxRadius_ = maxRadius;
+	cellSize_ = cellSize;
+	inverseCellSize_ = 1.0f / cellSize;
+	searchRange_ = static_cast<int32_t>(std::ceil(2.0f * maxRadius * inverseCellSize_));
+
+	// セル座標を X → Y → Z の順に線形化してバケットにする(近いセルが近いバケットになり、キャッシュに乗りやすい)
+	//  行の端と次の行の先頭が同じバケットにならないよう探索範囲の分だけ幅を広げる
+	//  (Query は searchRange_ より広い範囲も調べるので、探索範囲の上限の分だけ広げる)
+	if (count > 0) {
+		uint32_t width = static_cast<uint32_t>(CellCoordinate(max[0]) - CellCoordinate(min[0])) + 1 + static_cast<uint32_t>(kMaxSearchRange) * 2;
+		uint32_t height = static_cast<uint32_t>(CellCoordinate(max[1]) - CellCoordinate(min[1])) + 1 + static_cast<uint32_t>(kMaxSearchRange) * 2;
+		strideY_ = width;
+		strideZ_ = width * height;
+	}
+
+	// バケット数はセルの衝突が少なくなるよう要素数の2倍以上の2のべき乗にする
+	uint32_t bucketCount = NextPowerOfTwo(std::max<size_t>(count * 2, 1));
+	bucketMask_ = bucketCount - 1;
+
+	bucketOf_.resize(count);
+	ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			bucketOf_[i] = CellHash(CellCoordinate(centerX_[i]), CellCoordinate(centerY_[i]), CellCoordinate(centerZ_[i]));
+		}
+		});
+
+	SortByBucket(bucketCount, jobSystem);
+
+	// 近傍探索で読む値をバケット順に詰めておく
+	sortedX_.resize(count);
+	sortedY_.resize(count);
+	sortedZ_.resize(count);
+	sortedRadius_.resize(count);
+	ParallelFor(jobSystem, count, [&](size_t begin, size_t end) {
+		for (size_t k = begin; k < end; ++k) {
+			uint32_t i = sorted_[k];
+			sortedX_[k] = centerX_[i];
+			sortedY_[k] = centerY_[i];
+			sortedZ_[k] = centerZ_[i];
+			sortedRadius_[k] = radius_[i];
+		}
+		});
+}
+
+void SpatialHashGrid::SortByBucket(uint32_t bucketCount, JobSystem* jobSystem) {
+	size_t count = bucketOf_.size();
+	bucketStart_.assign(bucketCount + 1, 0);
+	sorted_.resize(count);
+
+	// カウンティングソートでバケット順に並べる (同じバケットの中は番号順)
+	if (jobSystem == nullptr || jobSystem->WorkerCount() == 0) {
+		for (uint32_t bucket : bucketOf_) {
+			++bucketStart_[bucket + 1];
+		}
+		for (uint32_t bucket = 0; bucket < bucketCount; ++bucket) {
+			bucketStart_[bucket + 1] += bucketStart_[bucket];
+		}
+		std::vector<uint32_t> cursor(bucketStart_.begin(), bucketStart_.end() - 1);
+		for (size_t i = 0; i < count; ++i) {
+			sorted_[cursor[bucketOf_[i]]++] = static_cast<uint32_t>(i);
+		}
+		return;
+	}
+
+	// 並列では2段に分ける (全バケットのヒストグラムをチャンクごとに持つと大きすぎるため)
+	//  1段目: バケットの上位 kDigitBits ビットをチャンクごとに数え、桁ごと・チャンク順の位置に振り分ける
+	//  2段目: 桁ごとに下位のビットで数えて並べる。桁の中は番号順に並んでいるので、結果は逐次版と同じになる
+	uint32_t bucketBits = static_cast<uint32_t>(std::countr_zero(bucketCount));
+	uint32_t shift = bucketBits > kDigitBits ? bucketBits - kDigitBits : 0;
+	size_t digitCount = bucketCount >> shift;
+	size_t bucketsPerDigit = size_t(1) << shift;
+	size_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+
+	std::vector<uint32_t> digitCursor(chunkCount * digitCount, 0);
+	ParallelForChunks(jobSystem, count, [&](size_t chunk, size_t begin, size_t end) {
+		uint32_t* counts = &digitCursor[chunk * digitCount];
+		for (size_t i = begin; i < end; ++i) {
+			++counts[bucketOf_[i] >> shift];
+		}
+		});
+	std::vector<uint32_t> digitStart(digitCount + 1);
+	uint32_t offset = 0;
+	for (size_t digit = 0; digit < digitCount; ++digit) {
+		digitStart[digit] = offset;
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+			uint32_t digitSize = digitCursor[chunk * digitCount + digit];
+			digitCursor[chunk * digitCount + digit] = offset;
+			offset += digitSize;
+		}
+	}
+	digitStart[digitCount] = offset;
+
+	byDigit_.resize(count);
+	ParallelForChunks(jobSystem, count, [&](size_t chunk, size_t begin, size_t end) {
+		uint32_t* cursor = &digitCursor[chunk * digitCount];
+		for (size_t i = begin; i < end; ++i) {
+			byDigit_[cursor[bucketOf_[i] >> shift]++] = static_cast<uint32_t>(i);
+		}
+		});
+
+	// 桁ごとに bucketStart_ の自分の範囲だけを書く
+	jobSystem->ParallelFor(digitCount, 1, [&](size_t beginDigit, size_t endDigit) {
+		std::vector<uint32_t> cursor(bucketsPerDigit);
+		for (size_t digit = beginDigit; digit < endDigit; ++digit) {
+			uint32_t firstBucket = static_cast<uint32_t>(digit << shift);
+			std::fill(cursor.begin(), cursor.end(), 0);
+			for (uint32_t k = digitStart[digit]; k < digitStart[digit + 1]; ++k) {
+				++cursor[bucketOf_[byDigit_[k]] - firstBucket];
+			}
+			uint32_t position = digitStart[digit];
+			for (size_t j = 0; j < bucketsPerDigit; ++j) {
+				uint32_t bucketSize = cursor[j];
+				bucketStart_[firstBucket + j] = position;
+				cursor[j] = position;
+				position += bucketSize;
+			}
+			for (uint32_t k = digitStart[digit]; k < digitStart[digit + 1]; ++k) {
+				uint32_t i = byDigit_[k];
+				sorted_[cursor[bucketOf_[i] - firstBucket]++] = i;
+			}
+		}
+		});
+	bucketStart_[bucketCount] = static_cast<uint32_t>(count);
+}
+
+uint32_t SpatialHashGrid::CellHash(int32_t x, int32_t y, int32_t z) const {
+	// 符号なしの桁あふれは 2^32 を法とする演算なので、マスクを取っても隣のセルは隣のバケットのまま
+	uint32_t hash = static_cast<uint32_t>(x) + static_cast<uint32_t>(y) * strideY_ + static_cast<uint32_t>(z) * strideZ_;
+	return hash & bucketMask_;
+}
+
+int32_t SpatialHashGrid::CellCoordinate(float value) const {
+	return static_cast<int32_t>(std::floor(value * inverseCellSize_));
+}
+
+size_t SpatialHashGrid::GatherSpans(int32_t x, int32_t y, int32_t z, int32_t range, Span* spans) const {
+	uint32_t width = static_cast<uint32_t>(range) * 2 + 1;
+	size_t count = 0;
+
+	// 近傍のセルの線形インデックスの幅がバケット数を超えると同じバケットが2回現れるので、バケット単位で重複を除く
+	uint64_t keySpan = static_cast<uint64_t>(width - 1) * (1 + static_cast<uint64_t>(strideY_) + strideZ_) + 1;
+	if (keySpan > static_cast<uint64_t>(bucketMask_) + 1) {
+		uint32_t buckets[kMaxGatherBuckets];
+		for (int32_t dz = -range; dz <= range; ++dz) {
+			for (int32_t dy = -range; dy <= range; ++dy) {
+				for (int32_t dx = -range; dx <= range; ++dx) {
+					buckets[count++] = CellHash(x + dx, y + dy, z + dz);
+				}
+			}
+		}
+		std::sort(buckets, buckets + count);
+		count = static_cast<size_t>(std::unique(buckets, buckets + count) - buckets);
+		for (size_t i = 0; i < count; ++i) {
+			spans[i] = { bucketStart_[buckets[i]], bucketStart_[buckets[i] + 1] };
+		}
+		return count;
+	}
+
+	// X方向に並んだセルは連続したバケットなので、行ごとに sorted_ の1区間にまとまる
+	for (int32_t dz = -range; dz <= range; ++dz) {
+		for (int32_t dy = -range; dy <= range; ++dy) {
+			uint32_t first = CellHash(x - range, y + dy, z + dz);
+			uint32_t last = first + width - 1;
+			if (last <= bucketMask_) {
+				spans[count++] = { bucketStart_[first], bucketStart_[last + 1] };
+			} else {
+				// 表の末尾で折り返す
+				spans[count++] = { bucketStart_[first], bucketStart_[bucketMask_ + 1] };
+				spans[count++] = { bucketStart_[0], bucketStart_[last - bucketMask_] };
+			}
+		}
+	}
+	return count;
+}
+
+void SpatialHashGrid::FindPairs(std::vector<BroadPhasePair>& pairs, JobSystem* jobSystem) const {
+	pairs.clear();
+	size_t count = radius_.size();
+	if (jobSystem == nullptr) {
+		FindPairs(0, count, pairs);
+		return;
+	}
+
+	// チャンクごとに結果を分けておき、チャンク順に連結する
+	size_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+	std::vector<std::vector<BroadPhasePair>> chunkPairs(chunkCount);
+	jobSystem->ParallelFor(count, kChunkSize, [&](size_t begin, size_t end) {
+		FindPairs(begin, end, chunkPairs[begin / kChunkSize]);
+		});
+	for (const std::vector<BroadPhasePair>& chunk : chunkPairs) {
+		pairs.insert(pairs.end(), chunk.begin(), chunk.end());
+	}
+}
+
+void SpatialHashGrid::FindPairs(size_t begin, size_t end, std::vector<BroadPhasePair>& pairs) const {
+	// バケット順にたどり、同じセルが続く間は近傍の区間を使い回す
+	Span spans[kMaxGatherBuckets];
+	size_t spanCount = 0;
+	int32_t cellX = 0;
+	int32_t cellY = 0;
+	int32_t cellZ = 0;
+	bool hasCell = false;
+	for (size_t k = begin; k < end; ++k) {
+		float x = sortedX_[k];
+		float y = sortedY_[k];
+		float z = sortedZ_[k];
+		float radius = sortedRadius_[k];
+		uint32_t i = sorted_[k];
+		int32_t newX = CellCoordinate(x);
+		int32_t newY = CellCoordinate(y);
+		int32_t newZ = CellCoordinate(z);
+		if (!hasCell || newX != cellX || newY != cellY || newZ != cellZ) {
+			cellX = newX;
+			cellY = newY;
+			cellZ = newZ;
+			hasCell = true;
+			spanCount = GatherSpans(cellX, cellY, cellZ, searchRange_, spans);
+		}
+
+		for (size_t span = 0; span < spanCount; ++span) {
+			for (uint32_t other = spans[span].begin; other < spans[span].end; ++other) {
+				uint32_t j = sorted_[other];
+				// 組は小さい方のインデックスから1回だけ数える
+				if (j <= i) {
+					continue;
+				}
+				float dx = sortedX_[other] - x;
+				float dy = sortedY_[other] - y;
+				float dz = sortedZ_[other] - z;
+				float radiusSum = radius + sortedRadius_[other];
+				if (dx * dx + dy * dy + dz * dz <= radiusSum * radiusSum) {
+					pairs.push_back({ i, j });
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::Query(const Sphere& sphere, std::vector<uint32_t>& result) const {
+	result.clear();
+	auto test = [&](uint32_t k) {
+		float dx = sortedX_[k] - sphere.center.x;
+		float dy = sortedY_[k] - sphere.center.y;
+		float dz = sortedZ_[k] - sphere.center.z;
+		float radiusSum = sphere.radius + sortedRadius_[k];
+		if (dx * dx + dy * dy + dz * dz <= radiusSum * radiusSum) {
+			result.push_back(sorted_[k]);
+		}
+		};
+
+	float range = std::ceil((sphere.radius + maxRadius_) * inverseCellSize_);
+	// 範囲が広すぎるときは全件を調べる
+	if (range > static_cast<float>(kMaxSearchRange)) {
+		for (uint32_t k = 0; k < sorted_.size(); ++k) {
+			test(k);
+		}
+		return;
+	}
+
+	Span spans[kMaxGatherBuckets];
+	size_t spanCount = GatherSpans(CellCoordinate(sphere.center.x), CellCoordinate(sphere.center.y), CellCoordinate(sphere.center.z), static_cast<int32_t>(range), spans);
+	for (size_t span = 0; span < spanCount; ++span) {
+		for (uint32_t k = spans[span].begin; k < spans[span].end; ++k) {
+			test(k);
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+#include "BallSystem.h"
+#include "BroadPhase.h"
+#include "JobSystem.h"
+
+// 球の集合に対する一様グリッド (線形化したセル座標をバケット数で割った余りで固定サイズの表に詰める)
+//  球は中心のあるセルにだけ登録し、近傍探索では最大半径から決まる範囲のセルを調べる
+//  近傍探索はバケット順にたどるので、同じセルの球は近傍バケットの一覧を共有する
+//  毎ステップ作り直す前提で、構築はカウンティングソートなので O(n) (JobSystem を渡すと範囲・ソート・並べ替えの各段も並列になる)
+//  判定は距離の2乗と半径の和の2乗の比較で行い、平方根を使わない
+class SpatialHashGrid {
+public:
+	// cellSize が0なら構築時に最大直径を使う
+	//  大きさのばらつきが大きいときは典型的な直径を指定する(最大直径の1/3までは近傍の範囲を広げて対応する)
+	explicit SpatialHashGrid(float cellSize = 0.0f) : requestedCellSize_(cellSize) {}
+
+	void SetCellSize(float cellSize) { requestedCellSize_ = cellSize; }
+	float CellSize() const { return cellSize_; }
+	size_t Size() const { return radius_.size(); }
+
+	void Build(const Sphere* spheres, size_t count, JobSystem* jobSystem = nullptr);
+	void Build(const std::vector<Sphere>& spheres, JobSystem* jobSystem = nullptr) { Build(spheres.data(), spheres.size(), jobSystem); }
+	// BallSystem のSoA配列から直接構築する (インデックスは BallSystem と同じ)
+	void Build(const BallSystem& balls, JobSystem* jobSystem = nullptr);
+
+	// 重なっている球の組を列挙する (a < b、順序はスレッド数に依存しない)
+	void FindPairs(std::vector<BroadPhasePair>& pairs, JobSystem* jobSystem = nullptr) const;
+	// sphere と重なっている球のインデックスを列挙する
+	void Query(const Sphere& sphere, std::vector<uint32_t>& result) const;
+
+private:
+	void Prepare(JobSystem* jobSystem);
+	// bucketOf_ から bucketStart_ と sorted_ を作る (jobSystem があれば並列)
+	void SortByBucket(uint32_t bucketCount, JobSystem* jobSystem);
+	uint32_t CellHash(int32_t x, int32_t y, int32_t z) const;
+	int32_t CellCoordinate(float value) const;
+	// sorted_ の区間
+	struct Span {
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	// (x, y, z) の周囲 range セルが入っているバケットを、重複しない sorted_ の区間として集める
+	size_t GatherSpans(int32_t x, int32_t y, int32_t z, int32_t range, Span* spans) const;
+	void FindPairs(size_t begin, size_t end, std::vector<BroadPhasePair>& pairs) const;
+
+	float requestedCellSize_;
+	float cellSize_ = 1.0f;
+	float inverseCellSize_ = 1.0f;
+	float maxRadius_ = 0.0f;
+	// 2球が重なるときの中心間距離の上限をセル数にしたもの
+	int32_t searchRange_ = 1;
+	uint32_t bucketMask_ = 0;
+	uint32_t strideY_ = 1;
+	uint32_t strideZ_ = 1;
+
+	std::vector<float> centerX_;
+	std::vector<float> centerY_;
+	std::vector<float> centerZ_;
+	std::vector<float> radius_;
+	std::vector<uint32_t> bucketOf_;
+	// バケットごとの開始位置 (bucketStart_[b] 〜 bucketStart_[b + 1] が sorted_ の範囲)
+	std::vector<uint32_t> bucketStart_;
+	std::vector<uint32_t> sorted_;
+	std::vector<uint32_t> byDigit_; //!< 並列のソートで上位の桁だけ並べた途中結果
+	std::vector<float> sortedX_;
+	std::vector<float> sortedY_;
+	std::vector<float> sortedZ_;
+	std::vector<float> sortedRadius_;
+};
@@ -0,0 +1,328 @@
+#include "SpringNetwork.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include "SimdFloat.h"
+#include "Profiler.h"
+
+namespace {
+	const size_t kChunkSize = 1024;
+	// 同じ色のばねは互いに独立なので細かく分けてよい
+	const size_t kColorChunkSize = 256;
+	// ばねの配列を揃える要素数 (AVXの幅)
+	const size_t kPadding = 8;
+	// 色分けに使う色の数。足りなかったばねは最後のグループに入れて1スレッドで処理する
+	const uint32_t kColorCount = 64;
+	const uint32_t kSerialGroup = kColorCount;
+
+#if defined(MT3_SIMD_AVX)
+	using FloatN = Simd::Float8;
+	const size_t kLanes = 8;
+#else
+	using FloatN = Simd::Float4;
+	const size_t kLanes = 4;
+#endif
+
+	size_t PaddedSize(size_t count) {
+		return (count + kPadding - 1) / kPadding * kPadding;
+	}
+
+	void ParallelFor(JobSystem* jobSystem, size_t count, const JobSystem::RangeFunction& function) {
+		if (jobSystem == nullptr) {
+			function(0, count);
+			return;
+		}
+		jobSystem->ParallelFor(count, kChunkSize, function);
+	}
+}
+
+uint32_t SpringNetwork::AddParticle(const Vector3& position, float mass) {
+	positionX_.push_back(position.x);
+	positionY_.push_back(position.y);
+	positionZ_.push_back(position.z);
+	velocityX_.push_back(0.0f);
+	velocityY_.push_back(0.0f);
+	velocityZ_.push_back(0.0f);
+	inverseMass_.push_back(mass > 0.0f ? 1.0f / mass : 0.0f);
+	colorsDirty_ = true;
+	return static_cast<uint32_t>(inverseMass_.size() - 1);
+}
+
+uint32_t SpringNetwork::AddSpring(uint32_t a, uint32_t b, float naturalLength, float stiffness, float dampingCoefficient) {
+	assert(a < ParticleCount() && b < ParticleCount() && a != b);
+	assert(naturalLength >= 0.0f && stiffness > 0.0f && dampingCoefficient >= 0.0f);
+	size_t index = springA_.size();
+	springA_.push_back(a);
+	springB_.push_back(b);
+	size_t padded = PaddedSize(index + 1);
+	naturalLength_.resize(padded, 0.0f);
+	stiffness_.resize(padded, 0.0f);
+	damping_.resize(padded, 0.0f);
+	naturalLength_[index] = naturalLength;
+	stiffness_[index] = stiffness;
+	damping_[index] = dampingCoefficient;
+	colorsDirty_ = true;
+	return static_cast<uint32_t>(index);
+}
+
+uint32_t SpringNetwork::AddSpring(uint32_t particle, const Spring& spring) {
+	uint32_t anchor = AddAnchor(spring.anchor);
+	return AddSpring(particle, anchor, spring.naturalLength, spring.stiffness, spring.dampingCoefficient);
+}
+
+void SpringNetwork::Clear() {
+	positionX_.clear();
+	positionY_.clear();
+	positionZ_.clear();
+	velocityX_.clear();
+	velocityY_.clear();
+	velocityZ_.clear();
+	inverseMass_.clear();
+	springA_.clear();
+	springB_.clear();
+	naturalLength_.clear();
+	stiffness_.clear();
+	damping_.clear();
+	colorsDirty_ = true;
+}
+
+void SpringNetwork::SetPosition(size_t index, const Vector3& position) {
+	positionX_[index] = position.x;
+	positionY_[index] = position.y;
+	positionZ_[index] = position.z;
+}
+
+void SpringNetwork::SetVelocity(size_t index, const Vector3& velocity) {
+	velocityX_[index] = velocity.x;
+	velocityY_[index] = velocity.y;
+	velocityZ_[index] = velocity.z;
+}
+
+void SpringNetwork::BuildColors() {
+	// 貪欲法で、動く粒子を共有しないばねに同じ色を付ける (動かない粒子は書き換えないので共有してよい)
+	size_t springCount = SpringCount();
+	std::vector<uint64_t> usedColors(ParticleCount(), 0);
+	std::vector<uint32_t> colors(springCount);
+	colorStart_.assign(kColorCount + 2, 0);
+	for (size_t s = 0; s < springCount; ++s) {
+		uint32_t a = springA_[s];
+		uint32_t b = springB_[s];
+		bool movableA = inverseMass_[a] > 0.0f;
+		bool movableB = inverseMass_[b] > 0.0f;
+		uint64_t used = (movableA ? usedColors[a] : 0) | (movableB ? usedColors[b] : 0);
+		uint32_t color = used == ~0ull ? kSerialGroup : static_cast<uint32_t>(std::countr_one(used));
+		if (color != kSerialGroup) {
+			uint64_t bit = 1ull << color;
+			if (movableA) {
+				usedColors[a] |= bit;
+			}
+			if (movableB) {
+				usedColors[b] |= bit;
+			}
+		}
+		colors[s] = color;
+		++colorStart_[color + 1];
+	}
+
+	// 色ごとにばねのインデックス順のまま並べる
+	for (uint32_t color = 0; color <= kColorCount; ++color) {
+		colorStart_[color + 1] += colorStart_[color];
+	}
+	colorOrder_.resize(springCount);
+	std::vector<uint32_t> cursor(colorStart_.begin(), colorStart_.end() - 1);
+	for (size_t s = 0; s < springCount; ++s) {
+		colorOrder_[cursor[colors[s]]++] = static_cast<uint32_t>(s);
+	}
+	colorsDirty_ = false;
+}
+
+template<typename Function>
+void SpringNetwork::ForEachColor(JobSystem* jobSystem, const Function& function) {
+	for (uint32_t color = 0; color <= kColorCount; ++color) {
+		size_t begin = colorStart_[color];
+		size_t end = colorStart_[color + 1];
+		if (begin == end) {
+			continue;
+		}
+		if (jobSystem == nullptr || color == kSerialGroup) {
+			function(begin, end);
+			continue;
+		}
+		jobSystem->ParallelFor(end - begin, kColorChunkSize, [&](size_t chunkBegin, size_t chunkEnd) {
+			function(begin + chunkBegin, begin + chunkEnd);
+			});
+	}
+}
+
+void SpringNetwork::Step(float deltaTime, JobSystem* jobSystem) {
+	MT3_PROFILE_ZONE("SpringNetwork::Step");
+	assert(deltaTime > 0.0f);
+	assert(settings_.substeps > 0);
+	if (colorsDirty_) {
+		BuildColors();
+	}
+	scratchX_.resize(ParticleCount());
+	scratchY_.resize(ParticleCount());
+	scratchZ_.resize(ParticleCount());
+
+	float substepTime = deltaTime / static_cast<float>(settings_.substeps);
+	for (uint32_t substep = 0; substep < settings_.substeps; ++substep) {
+		if (settings_.integrator == SpringIntegrator::kExplicit) {
+			StepExplicit(substepTime, jobSystem);
+		} else {
+			StepXPBD(substepTime, jobSystem);
+		}
+	}
+}
+
+void SpringNetwork::ComputeSpringForces(size_t begin, size_t end) {
+	// 両端の差を詰めてから、SIMDで力を求める
+	size_t gatherEnd = std::min(end, SpringCount());
+	for (size_t s = begin; s < gatherEnd; ++s) {
+		uint32_t a = springA_[s];
+		uint32_t b = springB_[s];
+		springDeltaX_[s] = positionX_[a] - positionX_[b];
+		springDeltaY_[s] = positionY_[a] - positionY_[b];
+		springDeltaZ_[s] = positionZ_[a] - positionZ_[b];
+		springVelocityX_[s] = velocityX_[a] - velocityX_[b];
+		springVelocityY_[s] = velocityY_[a] - velocityY_[b];
+		springVelocityZ_[s] = velocityZ_[a] - velocityZ_[b];
+	}
+
+	// 長さ0のばねは向きが0になるので力も0になる
+	FloatN epsilon = FloatN::Set(1e-12f);
+	for (size_t s = begin; s < end; s += kLanes) {
+		FloatN dx = FloatN::Load(&springDeltaX_[s]);
+		FloatN dy = FloatN::Load(&springDeltaY_[s]);
+		FloatN dz = FloatN::Load(&springDeltaZ_[s]);
+		FloatN length = Sqrt(dx * dx + dy * dy + dz * dz);
+		FloatN inverseLength = FloatN::Set(1.0f) / Max(length, epsilon);
+		FloatN nx = dx * inverseLength;
+		FloatN ny = dy * inverseLength;
+		FloatN nz = dz * inverseLength;
+		FloatN relativeVelocity = FloatN::Load(&springVelocityX_[s]) * nx + FloatN::Load(&springVelocityY_[s]) * ny + FloatN::Load(&springVelocityZ_[s]) * nz;
+		FloatN stretch = length - FloatN::Load(&naturalLength_[s]);
+		FloatN magnitude = FloatN::Set(0.0f) - FloatN::Load(&stiffness_[s]) * stretch - FloatN::Load(&damping_[s]) * relativeVelocity;
+		(nx * magnitude).Store(&springForceX_[s]);
+		(ny * magnitude).Store(&springForceY_[s]);
+		(nz * magnitude).Store(&springForceZ_[s]);
+	}
+}
+
+void SpringNetwork::StepExplicit(float deltaTime, JobSystem* jobSystem) {
+	size_t padded = PaddedSize(SpringCount());
+	for (AlignedVector<float>* array : { &springDeltaX_, &springDeltaY_, &springDeltaZ_, &springVelocityX_, &springVelocityY_, &springVelocityZ_, &springForceX_, &springForceY_, &springForceZ_ }) {
+		array->resize(padded, 0.0f);
+	}
+	ParallelFor(jobSystem, padded, [&](size_t begin, size_t end) {
+		ComputeSpringForces(begin, end);
+		});
+
+	// 粒子ごとに力を足し合わせる (同じ色のばねは粒子を共有しないので並列に書き込める)
+	std::fill(scratchX_.begin(), scratchX_.end(), 0.0f);
+	std::fill(scratchY_.begin(), scratchY_.end(), 0.0f);
+	std::fill(scratchZ_.begin(), scratchZ_.end(), 0.0f);
+	ForEachColor(jobSystem, [&](size_t begin, size_t end) {
+		for (size_t k = begin; k < end; ++k) {
+			uint32_t s = colorOrder_[k];
+			uint32_t a = springA_[s];
+			uint32_t b = springB_[s];
+			if (inverseMass_[a] > 0.0f) {
+				scratchX_[a] += springForceX_[s];
+				scratchY_[a] += springForceY_[s];
+				scratchZ_[a] += springForceZ_[s];
+			}
+			if (inverseMass_[b] > 0.0f) {
+				scratchX_[b] -= springForceX_[s];
+				scratchY_[b] -= springForceY_[s];
+				scratchZ_[b] -= springForceZ_[s];
+			}
+		}
+		});
+
+	Vector3 gravity = settings_.gravity;
+	ParallelFor(jobSystem, ParticleCount(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			float inverseMass = inverseMass_[i];
+			if (inverseMass == 0.0f) {
+				continue;
+			}
+			velocityX_[i] += (scratchX_[i] * inverseMass + gravity.x) * deltaTime;
+			velocityY_[i] += (scratchY_[i] * inverseMass + gravity.y) * deltaTime;
+			velocityZ_[i] += (scratchZ_[i] * inverseMass + gravity.z) * deltaTime;
+			positionX_[i] += velocityX_[i] * deltaTime;
+			positionY_[i] += velocityY_[i] * deltaTime;
+			positionZ_[i] += velocityZ_[i] * deltaTime;
+		}
+		});
+}
+
+void SpringNetwork::StepXPBD(float deltaTime, JobSystem* jobSystem) {
+	// 予測位置まで進めてから、ばねの拘束で位置を直し、位置の変化から速度を求める
+	Vector3 gravity = settings_.gravity;
+	ParallelFor(jobSystem, ParticleCount(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			scratchX_[i] = positionX_[i];
+			scratchY_[i] = positionY_[i];
+			scratchZ_[i] = positionZ_[i];
+			if (inverseMass_[i] == 0.0f) {
+				continue;
+			}
+			velocityX_[i] += gravity.x * deltaTime;
+			velocityY_[i] += gravity.y * deltaTime;
+			velocityZ_[i] += gravity.z * deltaTime;
+			positionX_[i] += velocityX_[i] * deltaTime;
+			positionY_[i] += velocityY_[i] * deltaTime;
+			positionZ_[i] += velocityZ_[i] * deltaTime;
+		}
+		});
+
+	// サブステップを細かく取る代わりに反復は1回にする (ラグランジュ乗数の累積が不要になる)
+	//  コンプライアンス α = 1 / (k * dt^2)、減衰 γ = c / (k * dt)
+	float inverseDeltaTime = 1.0f / deltaTime;
+	ForEachColor(jobSystem, [&](size_t begin, size_t end) {
+		for (size_t k = begin; k < end; ++k) {
+			uint32_t s = colorOrder_[k];
+			uint32_t a = springA_[s];
+			uint32_t b = springB_[s];
+			float inverseMassA = inverseMass_[a];
+			float inverseMassB = inverseMass_[b];
+			float inverseMassSum = inverseMassA + inverseMassB;
+			if (inverseMassSum == 0.0f) {
+				continue;
+			}
+			Vector3 positionA = GetPosition(a);
+			Vector3 positionB = GetPosition(b);
+			Vector3 delta = positionA - positionB;
+			float length = delta.Length();
+			if (length == 0.0f) {
+				continue;
+			}
+			Vector3 normal = delta * (1.0f / length);
+			float compliance = inverseDeltaTime * inverseDeltaTime / stiffness_[s];
+			float damping = damping_[s] * inverseDeltaTime / stiffness_[s];
+			Vector3 moveA = positionA - Vector3(scratchX_[a], scratchY_[a], scratchZ_[a]);
+			Vector3 moveB = positionB - Vector3(scratchX_[b], scratchY_[b], scratchZ_[b]);
+			float constraint = length - naturalLength_[s];
+			float lambda = (-constraint - damping * normal.Dot(moveA - moveB)) / ((1.0f + damping) * inverseMassSum + compliance);
+			if (inverseMassA > 0.0f) {
+				SetPosition(a, positionA + normal * (lambda * inverseMassA));
+			}
+			if (inverseMassB > 0.0f) {
+				SetPosition(b, positionB - normal * (lambda * inverseMassB));
+			}
+		}
+		});
+
+	ParallelFor(jobSystem, ParticleCount(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			if (inverseMass_[i] == 0.0f) {
+				continue;
+			}
+			velocityX_[i] = (positionX_[i] - scratchX_[i]) * inverseDeltaTime;
+			velocityY_[i] = (positionY_[i] - scratchY_[i]) * inverseDeltaTime;
+			velocityZ_[i] = (positionZ_[i] - scratchZ_[i]) * inverseDeltaTime;
+		}
+		});
+}
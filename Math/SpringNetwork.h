@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+#include "AlignedAllocator.h"
+#include "JobSystem.h"
+
+enum class SpringIntegrator {
+	kExplicit, //!< ばねの力を求めて半陰的オイラー法で進める (硬いばねは刻み幅を小さくしないと発散する)
+	kXPBD, //!< 拡張位置ベース法 (硬いばね・伸びないばねでも発散しない)
+};
+
+struct SpringNetworkSettings {
+	SpringIntegrator integrator = SpringIntegrator::kXPBD; //!< 積分方法
+	uint32_t substeps = 8; //!< 1ステップの分割数
+	Vector3 gravity = { 0.0f, -9.8f, 0.0f }; //!< 重力加速度
+};
+
+// 粒子をSoAで持ち、ばねを粒子インデックスの組で持つばね-質点系 (布やロープ用)
+//  Spring 構造体のアンカーは動かない粒子 (質量0) として追加し、粒子同士のばねと同じに扱う
+//  ばねの減衰は両端の相対速度のうち、ばねの向きの成分に掛かる
+//  ばねは両端の粒子が重ならないよう色分けしておき、同じ色のばねはまとめて(並列に)処理する
+//  処理の順番は色分けだけで決まるので、結果はスレッド数に依存しない
+class SpringNetwork {
+public:
+	// mass が0以下なら動かない粒子になる
+	uint32_t AddParticle(const Vector3& position, float mass);
+	uint32_t AddAnchor(const Vector3& position) { return AddParticle(position, 0.0f); }
+	// 粒子 a, b をつなぐ。stiffness に INFINITY を渡すと XPBD では伸びないばねになる
+	uint32_t AddSpring(uint32_t a, uint32_t b, float naturalLength, float stiffness, float dampingCoefficient);
+	// spring.anchor に動かない粒子を作って particle とつなぐ
+	uint32_t AddSpring(uint32_t particle, const Spring& spring);
+	void Clear();
+
+	size_t ParticleCount() const { return inverseMass_.size(); }
+	size_t SpringCount() const { return springA_.size(); }
+
+	void SetSettings(const SpringNetworkSettings& settings) { settings_ = settings; }
+	const SpringNetworkSettings& Settings() const { return settings_; }
+
+	Vector3 GetPosition(size_t index) const { return { positionX_[index], positionY_[index], positionZ_[index] }; }
+	void SetPosition(size_t index, const Vector3& position);
+	Vector3 GetVelocity(size_t index) const { return { velocityX_[index], velocityY_[index], velocityZ_[index] }; }
+	void SetVelocity(size_t index, const Vector3& velocity);
+
+	const float* PositionX() const { return positionX_.data(); }
+	const float* PositionY() const { return positionY_.data(); }
+	const float* PositionZ() const { return positionZ_.data(); }
+	const uint32_t* SpringA() const { return springA_.data(); }
+	const uint32_t* SpringB() const { return springB_.data(); }
+
+	void Step(float deltaTime, JobSystem* jobSystem = nullptr);
+
+private:
+	void BuildColors();
+	void StepExplicit(float deltaTime, JobSystem* jobSystem);
+	void StepXPBD(float deltaTime, JobSystem* jobSystem);
+	// 全てのばねの力を springForce に求める
+	void ComputeSpringForces(size_t begin, size_t end);
+	// 色ごとに [begin, end) の処理を並列に呼ぶ
+	template<typename Function>
+	void ForEachColor(JobSystem* jobSystem, const Function& function);
+
+	SpringNetworkSettings settings_;
+
+	AlignedVector<float> positionX_;
+	AlignedVector<float> positionY_;
+	AlignedVector<float> positionZ_;
+	AlignedVector<float> velocityX_;
+	AlignedVector<float> velocityY_;
+	AlignedVector<float> velocityZ_;
+	AlignedVector<float> inverseMass_;
+	// 力 (陽解法) または1サブステップ前の位置 (XPBD)
+	AlignedVector<float> scratchX_;
+	AlignedVector<float> scratchY_;
+	AlignedVector<float> scratchZ_;
+
+	AlignedVector<uint32_t> springA_;
+	AlignedVector<uint32_t> springB_;
+	// 力のカーネルで読み書きする配列はSIMDの幅の倍数まで0で埋めてある
+	AlignedVector<float> naturalLength_;
+	AlignedVector<float> stiffness_;
+	AlignedVector<float> damping_;
+	AlignedVector<float> springDeltaX_;
+	AlignedVector<float> springDeltaY_;
+	AlignedVector<float> springDeltaZ_;
+	AlignedVector<float> springVelocityX_;
+	AlignedVector<float> springVelocityY_;
+	AlignedVector<float> springVelocityZ_;
+	AlignedVector<float> springForceX_;
+	AlignedVector<float> springForceY_;
+	AlignedVector<float> springForceZ_;
+
+	// 色順に並べたばねのインデックス (colorStart_[c] 〜 colorStart_[c + 1] が色 c)
+	std::vector<uint32_t> colorOrder_;
+	std::vector<uint32_t> colorStart_;
+	bool colorsDirty_ = true;
+};
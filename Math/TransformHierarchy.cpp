@@ -0,0 +1,95 @@
+#include "TransformHierarchy.h"
+#include <cassert>
+
+uint32_t TransformHierarchy::Add(uint32_t parent, const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	assert(parent == kNoParent || parent < Size());
+	uint32_t index = static_cast<uint32_t>(Size());
+	parents_.push_back(parent);
+	scales_.push_back(scale);
+	rotates_.push_back(rotate);
+	translates_.push_back(translate);
+	localMatrices_.emplace_back();
+	worldMatrices_.emplace_back();
+	flags_.push_back(0);
+	MarkDirty(index);
+	return index;
+}
+
+void TransformHierarchy::Clear() {
+	parents_.clear();
+	scales_.clear();
+	rotates_.clear();
+	translates_.clear();
+	localMatrices_.clear();
+	worldMatrices_.clear();
+	flags_.clear();
+	firstDirty_ = 0;
+}
+
+void TransformHierarchy::Reserve(size_t capacity) {
+	parents_.reserve(capacity);
+	scales_.reserve(capacity);
+	rotates_.reserve(capacity);
+	translates_.reserve(capacity);
+	localMatrices_.reserve(capacity);
+	worldMatrices_.reserve(capacity);
+	flags_.reserve(capacity);
+}
+
+void TransformHierarchy::SetScale(uint32_t index, const Vector3& scale) {
+	scales_[index] = scale;
+	MarkDirty(index);
+}
+
+void TransformHierarchy::SetRotate(uint32_t index, const Quaternion& rotate) {
+	rotates_[index] = rotate;
+	MarkDirty(index);
+}
+
+void TransformHierarchy::SetTranslate(uint32_t index, const Vector3& translate) {
+	translates_[index] = translate;
+	MarkDirty(index);
+}
+
+void TransformHierarchy::SetTransform(uint32_t index, const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	scales_[index] = scale;
+	rotates_[index] = rotate;
+	translates_[index] = translate;
+	MarkDirty(index);
+}
+
+size_t TransformHierarchy::Update() {
+	size_t count = Size();
+	size_t begin = firstDirty_;
+	size_t updated = 0;
+	for (size_t i = begin; i < count; ++i) {
+		uint8_t flags = flags_[i];
+		uint32_t parent = parents_[i];
+		// begin より前の親はこの Update で変わっていない (前回の kWorldChanged が残っていても見ない)
+		bool parentChanged = parent != kNoParent && parent >= begin && (flags_[parent] & kWorldChanged) != 0;
+		// ローカル行列は手元で作ってからかける (書いたばかりの配列を SIMD の乗算で読み直すと遅い)
+		Matrix4x4 local;
+		if (flags & kLocalDirty) {
+			local = MakeAffineMatrixFromQuaternion(scales_[i], rotates_[i], translates_[i]);
+			localMatrices_[i] = local;
+		} else if (!parentChanged) {
+			flags_[i] = 0;
+			continue;
+		} else {
+			local = localMatrices_[i];
+		}
+		worldMatrices_[i] = parent == kNoParent ? local : local * worldMatrices_[parent];
+		flags_[i] = kWorldChanged;
+		++updated;
+	}
+	firstDirty_ = count;
+	return updated;
+}
+
+void TransformHierarchy::MarkDirty(uint32_t index) {
+	assert(index < Size());
+	flags_[index] |= kLocalDirty;
+	if (index < firstDirty_) {
+		firstDirty_ = index;
+	}
+}
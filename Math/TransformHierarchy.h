@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+#include "Quaternion.h"
+
+// 親子関係のある拡大・回転・平行移動 (TRS) の階層
+//  ノードは親より後ろに並べる (親には追加済みのノードしか指定できない) ので、前から1回なめるだけで親のワールド行列が先に決まる
+//  値を変えたノードとその子孫だけ、ローカル行列・ワールド行列を作り直す (変えたノードより前はなめない)
+class TransformHierarchy {
+public:
+	static const uint32_t kNoParent = 0xffffffffu;
+
+	// 追加したノードの番号を返す (parent は kNoParent か追加済みのノード)
+	uint32_t Add(uint32_t parent, const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+	void Clear();
+	void Reserve(size_t capacity);
+	size_t Size() const { return parents_.size(); }
+
+	uint32_t GetParent(uint32_t index) const { return parents_[index]; }
+	const Vector3& GetScale(uint32_t index) const { return scales_[index]; }
+	const Quaternion& GetRotate(uint32_t index) const { return rotates_[index]; }
+	const Vector3& GetTranslate(uint32_t index) const { return translates_[index]; }
+
+	void SetScale(uint32_t index, const Vector3& scale);
+	void SetRotate(uint32_t index, const Quaternion& rotate);
+	void SetTranslate(uint32_t index, const Vector3& translate);
+	void SetTransform(uint32_t index, const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+
+	// 前回から変わったノードとその子孫の行列を作り直す。戻り値は作り直したワールド行列の数
+	size_t Update();
+
+	// Update 後の行列 (ワールド行列はローカル行列 * 親のワールド行列)
+	const Matrix4x4& GetLocalMatrix(uint32_t index) const { return localMatrices_[index]; }
+	const Matrix4x4& GetWorldMatrix(uint32_t index) const { return worldMatrices_[index]; }
+	// 全ノードのワールド行列 (ノードの番号順に Size() 個)
+	const Matrix4x4* WorldMatrices() const { return worldMatrices_.data(); }
+
+private:
+	enum NodeFlag : uint8_t {
+		kLocalDirty = 1 << 0, //!< TRS が変わり、ローカル行列を作り直す
+		kWorldChanged = 1 << 1, //!< 直前の Update でワールド行列を作り直した (子の判定用)
+	};
+
+	void MarkDirty(uint32_t index);
+
+	std::vector<uint32_t> parents_;
+	std::vector<Vector3> scales_;
+	std::vector<Quaternion> rotates_;
+	std::vector<Vector3> translates_;
+	std::vector<Matrix4x4> localMatrices_;
+	std::vector<Matrix4x4> worldMatrices_;
+	std::vector<uint8_t> flags_; //!< NodeFlag の組み合わせ
+	size_t firstDirty_ = 0; //!< 次の Update でなめ始める番号 (変わったノードがなければ Size())
+};
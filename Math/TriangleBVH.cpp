@@ -0,0 +1,310 @@
+#include "TriangleBVH.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	const uint32_t kBinCount = 16;
+	// SAHで分割しない方が得でも、この数を超える葉は作らない
+	const uint32_t kMaxLeafSize = 8;
+	// 走査スタックの上限を決めるため、この深さで打ち切って葉にする
+	const uint32_t kMaxDepth = 64;
+
+	float Component(const Vector3& v, int axis) {
+		return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+	}
+
+	AABB EmptyBounds() {
+		return { { INFINITY, INFINITY, INFINITY }, { -INFINITY, -INFINITY, -INFINITY } };
+	}
+
+	void Grow(AABB& bounds, const Vector3& point) {
+		bounds.min = { std::min(bounds.min.x, point.x), std::min(bounds.min.y, point.y), std::min(bounds.min.z, point.z) };
+		bounds.max = { std::max(bounds.max.x, point.x), std::max(bounds.max.y, point.y), std::max(bounds.max.z, point.z) };
+	}
+
+	void Grow(AABB& bounds, const AABB& other) {
+		Grow(bounds, other.min);
+		Grow(bounds, other.max);
+	}
+
+	float HalfArea(const AABB& bounds) {
+		Vector3 e = bounds.max - bounds.min;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	// スラブ法で [tMin, tMax] と境界の交差区間を求める
+	bool IntersectBounds(const AABB& bounds, const Vector3& origin, const Vector3& invDiff, float tMin, float tMax, float& entry) {
+		for (int axis = 0; axis < 3; ++axis) {
+			float o = Component(origin, axis);
+			float inv = Component(invDiff, axis);
+			float min = Component(bounds.min, axis);
+			float max = Component(bounds.max, axis);
+			if (std::isinf(inv)) {
+				// 軸に平行な場合は始点がスラブの内側にあるか
+				if (o < min || o > max) {
+					return false;
+				}
+				continue;
+			}
+			float t1 = (min - o) * inv;
+			float t2 = (max - o) * inv;
+			tMin = std::max(tMin, std::min(t1, t2));
+			tMax = std::min(tMax, std::max(t1, t2));
+		}
+		entry = tMin;
+		return tMin <= tMax;
+	}
+}
+
+void TriangleBVH::Build(const Triangle* triangles, size_t count) {
+	nodes_.clear();
+	triangles_.clear();
+	if (count == 0) {
+		return;
+	}
+
+	std::vector<AABB> triangleBounds(count);
+	std::vector<Vector3> centroids(count);
+	std::vector<uint32_t> indices(count);
+	for (size_t i = 0; i < count; ++i) {
+		AABB bounds = EmptyBounds();
+		for (const Vector3& vertex : triangles[i].vertices) {
+			Grow(bounds, vertex);
+		}
+		triangleBounds[i] = bounds;
+		centroids[i] = (triangles[i].vertices[0] + triangles[i].vertices[1] + triangles[i].vertices[2]) / 3.0f;
+		indices[i] = static_cast<uint32_t>(i);
+	}
+
+	nodes_.reserve(count * 2);
+	nodes_.push_back({ EmptyBounds(), 0, static_cast<uint32_t>(count) });
+	Subdivide(0, 0, triangleBounds, centroids, indices);
+
+	// 葉の並び順で三角形を前計算しておく
+	triangles_.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		const Triangle& triangle = triangles[indices[i]];
+		triangles_[i] = {
+			triangle.vertices[0],
+			triangle.vertices[1] - triangle.vertices[0],
+			triangle.vertices[2] - triangle.vertices[0],
+			indices[i]
+		};
+	}
+}
+
+void TriangleBVH::Subdivide(uint32_t nodeIndex, uint32_t depth, const std::vector<AABB>& triangleBounds, const std::vector<Vector3>& centroids, std::vector<uint32_t>& indices) {
+	uint32_t first = nodes_[nodeIndex].first;
+	uint32_t count = nodes_[nodeIndex].count;
+
+	AABB bounds = EmptyBounds();
+	AABB centroidBounds = EmptyBounds();
+	for (uint32_t i = first; i < first + count; ++i) {
+		Grow(bounds, triangleBounds[indices[i]]);
+		Grow(centroidBounds, centroids[indices[i]]);
+	}
+	nodes_[nodeIndex].bounds = bounds;
+
+	if (count <= 2 || depth >= kMaxDepth) {
+		return;
+	}
+
+	// 各軸でビニングし、SAHコストが最小になる分割面を探す
+	float bestCost = INFINITY;
+	int bestAxis = -1;
+	uint32_t bestSplit = 0;
+	for (int axis = 0; axis < 3; ++axis) {
+		float min = Component(centroidBounds.min, axis);
+		float max = Component(centroidBounds.max, axis);
+		if (max <= min) {
+			continue;
+		}
+
+		AABB binBounds[kBinCount];
+		uint32_t binCounts[kBinCount] = {};
+		for (AABB& binBound : binBounds) {
+			binBound = EmptyBounds();
+		}
+		float scale = static_cast<float>(kBinCount) / (max - min);
+		for (uint32_t i = first; i < first + count; ++i) {
+			uint32_t bin = std::min(kBinCount - 1, static_cast<uint32_t>((Component(centroids[indices[i]], axis) - min) * scale));
+			++binCounts[bin];
+			Grow(binBounds[bin], triangleBounds[indices[i]]);
+		}
+
+		// 左からの累積面積を求めてから右から走査する
+		float leftArea[kBinCount - 1];
+		uint32_t leftCount[kBinCount - 1];
+		AABB leftBounds = EmptyBounds();
+		uint32_t leftSum = 0;
+		for (uint32_t i = 0; i < kBinCount - 1; ++i) {
+			leftSum += binCounts[i];
+			if (binCounts[i] > 0) {
+				Grow(leftBounds, binBounds[i]);
+			}
+			leftCount[i] = leftSum;
+			leftArea[i] = leftSum > 0 ? HalfArea(leftBounds) : 0.0f;
+		}
+		AABB rightBounds = EmptyBounds();
+		uint32_t rightSum = 0;
+		for (uint32_t i = kBinCount - 1; i > 0; --i) {
+			rightSum += binCounts[i];
+			if (binCounts[i] > 0) {
+				Grow(rightBounds, binBounds[i]);
+			}
+			if (leftCount[i - 1] == 0 || rightSum == 0) {
+				continue;
+			}
+			float cost = static_cast<float>(leftCount[i - 1]) * leftArea[i - 1] + static_cast<float>(rightSum) * HalfArea(rightBounds);
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = i;
+			}
+		}
+	}
+
+	float leafCost = static_cast<float>(count) * HalfArea(bounds);
+	if (bestAxis < 0 || (bestCost >= leafCost && count <= kMaxLeafSize)) {
+		return;
+	}
+
+	// 分割面の左右に並べ替える
+	float min = Component(centroidBounds.min, bestAxis);
+	float scale = static_cast<float>(kBinCount) / (Component(centroidBounds.max, bestAxis) - min);
+	auto middle = std::partition(indices.begin() + first, indices.begin() + first + count, [&](uint32_t index) {
+		uint32_t bin = std::min(kBinCount - 1, static_cast<uint32_t>((Component(centroids[index], bestAxis) - min) * scale));
+		return bin < bestSplit;
+		});
+	uint32_t leftCount = static_cast<uint32_t>(middle - indices.begin()) - first;
+	if (leftCount == 0 || leftCount == count) {
+		return;
+	}
+
+	uint32_t left = static_cast<uint32_t>(nodes_.size());
+	nodes_.push_back({ EmptyBounds(), first, leftCount });
+	nodes_.push_back({ EmptyBounds(), first + leftCount, count - leftCount });
+	nodes_[nodeIndex].first = left;
+	nodes_[nodeIndex].count = 0;
+	Subdivide(left, depth + 1, triangleBounds, centroids, indices);
+	Subdivide(left + 1, depth + 1, triangleBounds, centroids, indices);
+}
+
+bool TriangleBVH::Traverse(const Vector3& origin, const Vector3& diff, float tMin, float tMax, bool anyHit, TriangleHit* hit) const {
+	if (nodes_.empty()) {
+		return false;
+	}
+
+	Vector3 invDiff = { 1.0f / diff.x, 1.0f / diff.y, 1.0f / diff.z };
+	struct Entry {
+		uint32_t node;
+		float t;
+	};
+	Entry stack[kMaxDepth * 2 + 2];
+	int stackSize = 0;
+	bool found = false;
+
+	float entry;
+	if (!IntersectBounds(nodes_[0].bounds, origin, invDiff, tMin, tMax, entry)) {
+		return false;
+	}
+	stack[stackSize++] = { 0, entry };
+
+	while (stackSize > 0) {
+		Entry current = stack[--stackSize];
+		// より近い交点が見つかっていれば飛ばす
+		if (current.t > tMax) {
+			continue;
+		}
+		const Node& node = nodes_[current.node];
+
+		if (node.count > 0) {
+			for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+				// Möller–Trumbore法
+				const PackedTriangle& triangle = triangles_[i];
+				Vector3 p = diff.Cross(triangle.edge2);
+				float det = triangle.edge1.Dot(p);
+				if (det == 0.0f) {
+					continue;
+				}
+				float invDet = 1.0f / det;
+				Vector3 s = origin - triangle.v0;
+				float u = s.Dot(p) * invDet;
+				if (u < 0.0f || u > 1.0f) {
+					continue;
+				}
+				Vector3 q = s.Cross(triangle.edge1);
+				float v = diff.Dot(q) * invDet;
+				if (v < 0.0f || u + v > 1.0f) {
+					continue;
+				}
+				float t = triangle.edge2.Dot(q) * invDet;
+				if (t < tMin || t > tMax) {
+					continue;
+				}
+				if (anyHit) {
+					return true;
+				}
+				found = true;
+				tMax = t;
+				*hit = { t, u, v, triangle.index };
+			}
+			continue;
+		}
+
+		// 近い子を後に積んで先に調べる
+		float leftEntry;
+		float rightEntry;
+		bool hitLeft = IntersectBounds(nodes_[node.first].bounds, origin, invDiff, tMin, tMax, leftEntry);
+		bool hitRight = IntersectBounds(nodes_[node.first + 1].bounds, origin, invDiff, tMin, tMax, rightEntry);
+		if (hitLeft && hitRight) {
+			if (leftEntry <= rightEntry) {
+				stack[stackSize++] = { node.first + 1, rightEntry };
+				stack[stackSize++] = { node.first, leftEntry };
+			} else {
+				stack[stackSize++] = { node.first, leftEntry };
+				stack[stackSize++] = { node.first + 1, rightEntry };
+			}
+		} else if (hitLeft) {
+			stack[stackSize++] = { node.first, leftEntry };
+		} else if (hitRight) {
+			stack[stackSize++] = { node.first + 1, rightEntry };
+		}
+	}
+
+	return found;
+}
+
+bool TriangleBVH::AnyHit(const Ray& ray) const {
+	return Traverse(ray.origin, ray.diff, 0.0f, INFINITY, true, nullptr);
+}
+
+bool TriangleBVH::AnyHit(const Segment& segment) const {
+	return Traverse(segment.origin, segment.diff, 0.0f, 1.0f, true, nullptr);
+}
+
+bool TriangleBVH::AnyHit(const Line& line) const {
+	return Traverse(line.origin, line.diff, -INFINITY, INFINITY, true, nullptr);
+}
+
+bool TriangleBVH::ClosestHit(const Ray& ray, TriangleHit& hit) const {
+	return Traverse(ray.origin, ray.diff, 0.0f, INFINITY, false, &hit);
+}
+
+bool TriangleBVH::ClosestHit(const Segment& segment, TriangleHit& hit) const {
+	return Traverse(segment.origin, segment.diff, 0.0f, 1.0f, false, &hit);
+}
+
+bool TriangleBVH::ClosestHit(const Line& line, TriangleHit& hit) const {
+	// 正方向と逆方向をそれぞれ半直線として調べ、|t| が小さい方を採用する
+	bool found = Traverse(line.origin, line.diff, 0.0f, INFINITY, false, &hit);
+	TriangleHit backward;
+	if (Traverse(line.origin, -line.diff, 0.0f, found ? hit.t : INFINITY, false, &backward)) {
+		if (!found || backward.t < hit.t) {
+			hit = backward;
+			hit.t = -backward.t;
+		}
+		return true;
+	}
+	return found;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+
+struct TriangleHit {
+	float t; //!< 交点のパラメータ (origin + diff * t)
+	float u; //!< 重心座標 (vertices[1] の重み)
+	float v; //!< 重心座標 (vertices[2] の重み)
+	uint32_t triangleIndex; //!< Build に渡した配列でのインデックス
+};
+
+// Triangle 配列に対するBVH (SAHのビニングで構築)
+//  交差判定は Collision::isCollision(const Triangle&, ...) と同じく両面・辺上を含む
+//  Ray は t >= 0、Segment は 0 <= t <= 1、Line は全ての t を対象にする
+//  Line の ClosestHit は |t| が最小の交点を返す
+class TriangleBVH {
+public:
+	void Build(const Triangle* triangles, size_t count);
+	void Build(const std::vector<Triangle>& triangles) { Build(triangles.data(), triangles.size()); }
+
+	bool AnyHit(const Ray& ray) const;
+	bool AnyHit(const Segment& segment) const;
+	bool AnyHit(const Line& line) const;
+	bool ClosestHit(const Ray& ray, TriangleHit& hit) const;
+	bool ClosestHit(const Segment& segment, TriangleHit& hit) const;
+	bool ClosestHit(const Line& line, TriangleHit& hit) const;
+
+	size_t TriangleCount() const { return triangles_.size(); }
+	size_t NodeCount() const { return nodes_.size(); }
+
+private:
+	struct Node {
+		AABB bounds; //!< 境界
+		uint32_t first; //!< 内部ノードなら左の子のインデックス(右は+1)、葉なら最初の三角形
+		uint32_t count; //!< 葉の三角形数(0なら内部ノード)
+	};
+
+	// 交差判定用に前計算した三角形
+	struct PackedTriangle {
+		Vector3 v0; //!< 頂点0
+		Vector3 edge1; //!< 頂点1 - 頂点0
+		Vector3 edge2; //!< 頂点2 - 頂点0
+		uint32_t index; //!< 元の配列でのインデックス
+	};
+
+	void Subdivide(uint32_t nodeIndex, uint32_t depth, const std::vector<AABB>& triangleBounds, const std::vector<Vector3>& centroids, std::vector<uint32_t>& indices);
+	bool Traverse(const Vector3& origin, const Vector3& diff, float tMin, float tMax, bool anyHit, TriangleHit* hit) const;
+
+	std::vector<Node> nodes_;
+	std::vector<PackedTriangle> triangles_;
+};
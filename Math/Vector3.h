@@ -1,5 +1,6 @@
 #pragma once
 #include <cmath>
+#include "FastMath.h"
 
 struct Vector3 {
 	float x, y, z;
@@ -50,21 +51,30 @@ struct Vector3 {
 		return x * vector.x + y * vector.y + z * vector.z;
 	}
 
+	// Precision で平方根・逆数の精度を選べる (FastMath 参照、既定は正確な計算)
+	template<typename Precision = FastMath::Exact>
 	float Length() const {
-		return std::sqrt(x * x + y * y + z * z);
+		return FastMath::Sqrt<Precision>(x * x + y * y + z * z);
 	}
 
 	float LengthSquared() const {
 		return x * x + y * y + z * z;
 	}
 
+	template<typename Precision = FastMath::Exact>
 	Vector3 Normalize() const {
-		float length = Length();
-		return { x / length, y / length, z / length };
+		if constexpr (FastMath::kIsExact<Precision>) {
+			float length = Length();
+			return { x / length, y / length, z / length };
+		} else {
+			float inverseLength = FastMath::Rsqrt<Precision>(LengthSquared());
+			return { x * inverseLength, y * inverseLength, z * inverseLength };
+		}
 	}
 
+	template<typename Precision = FastMath::Exact>
 	Vector3 Project(const Vector3& vector) const {
-		Vector3 normalized = vector.Normalize();
+		Vector3 normalized = vector.Normalize<Precision>();
 		return normalized * Dot(normalized);
 	}
 
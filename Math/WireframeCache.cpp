@@ -0,0 +1,55 @@
+#include "WireframeCache.h"
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <numbers>
+
+namespace {
+	const uint32_t kMaxSubdivision = 256;
+
+	std::mutex cacheMutex;
+	std::unique_ptr<WireframeMesh> unitSpheres[kMaxSubdivision + 1];
+
+	void BuildUnitSphere(uint32_t subdivision, WireframeMesh& mesh) {
+		const float kPi = std::numbers::pi_v<float>;
+		const float kLonEvery = 2.0f * kPi / static_cast<float>(subdivision);
+		const float kLatEvery = kPi / static_cast<float>(subdivision);
+		// 線分は隣の緯度・経度の頂点とつなぐので、1つ余分に頂点を用意する
+		const uint32_t kStride = subdivision + 2;
+
+		mesh.vertices.resize(kStride * kStride);
+		for (uint32_t latIndex = 0; latIndex < kStride; ++latIndex) {
+			float lat = -kPi * 0.5f + kLatEvery * static_cast<float>(latIndex);
+			for (uint32_t lonIndex = 0; lonIndex < kStride; ++lonIndex) {
+				float lon = static_cast<float>(lonIndex) * kLonEvery;
+				mesh.vertices[latIndex * kStride + lonIndex] = {
+					std::cos(lat) * std::cos(lon),
+					std::sin(lat),
+					std::cos(lat) * std::sin(lon)
+				};
+			}
+		}
+
+		mesh.indices.reserve((subdivision + 1) * (subdivision + 1) * 4);
+		for (uint32_t latIndex = 0; latIndex <= subdivision; ++latIndex) {
+			for (uint32_t lonIndex = 0; lonIndex <= subdivision; ++lonIndex) {
+				uint32_t a = latIndex * kStride + lonIndex;
+				uint32_t b = (latIndex + 1) * kStride + lonIndex;
+				uint32_t c = latIndex * kStride + lonIndex + 1;
+				mesh.indices.insert(mesh.indices.end(), { a, b, a, c });
+			}
+		}
+	}
+}
+
+const WireframeMesh& GetUnitSphereWireframe(uint32_t subdivision) {
+	assert(subdivision >= 3 && subdivision <= kMaxSubdivision);
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	std::unique_ptr<WireframeMesh>& mesh = unitSpheres[subdivision];
+	if (!mesh) {
+		mesh = std::make_unique<WireframeMesh>();
+		BuildUnitSphere(subdivision, *mesh);
+	}
+	return *mesh;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Vector3.h"
+
+// 線分で描くメッシュ
+struct WireframeMesh {
+	std::vector<Vector3> vertices; //!< 頂点
+	std::vector<uint32_t> indices; //!< 線分ごとに始点と終点の頂点インデックスを並べたもの
+};
+
+// 原点中心・半径1の球のワイヤーフレーム (分割数ごとに初回だけ生成して使い回す)
+//  緯度・経度を subdivision 分割した格子で、DrawSphere と同じ順で線分を並べる
+const WireframeMesh& GetUnitSphereWireframe(uint32_t subdivision);
@@ -0,0 +1,11 @@
+#pragma once
+#include <Novice.h>
+#include "Math/LineBatch.h"
+
+// LineBatch の線分を Novice で描画する
+class NoviceLineSink : public LineSink {
+public:
+	void DrawLine(int x1, int y1, int x2, int y2, uint32_t color) override {
+		Novice::DrawLine(x1, y1, x2, y2, color);
+	}
+};
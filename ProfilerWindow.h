@@ -0,0 +1,69 @@
+#pragma once
+#include <imgui.h>
+#include "Math/Profiler.h"
+
+#ifdef MT3_PROFILER_ENABLED
+
+#include <algorithm>
+#include <cstdio>
+
+// Profiler の履歴を ImGui で表示する
+//  フレーム時間のグラフ、直前のフレームと履歴の中で一番遅いフレームのゾーンごとの時間、カウンタを出す
+inline void ShowProfilerWindow(const char* tracePath = "profile_trace.json") {
+	Profiler& profiler = Profiler::Get();
+	static bool traceWritten = false;
+	static bool traceFailed = false;
+
+	ImGui::Begin("Profiler");
+	size_t frameCount = profiler.FrameCount();
+	if (frameCount == 0) {
+		ImGui::Text("no frames");
+		ImGui::End();
+		return;
+	}
+
+	// 古い順に並べてグラフにする
+	static float frameTimes[Profiler::kHistorySize];
+	float sum = 0.0f;
+	size_t slowest = 0;
+	for (size_t age = 0; age < frameCount; ++age) {
+		float ms = static_cast<float>(profiler.GetFrame(age).duration) * 1e-6f;
+		frameTimes[frameCount - 1 - age] = ms;
+		sum += ms;
+		if (profiler.GetFrame(age).duration > profiler.GetFrame(slowest).duration) {
+			slowest = age;
+		}
+	}
+	float maxMs = *std::max_element(frameTimes, frameTimes + frameCount);
+	char overlay[64];
+	std::snprintf(overlay, sizeof(overlay), "avg %.2f ms  max %.2f ms", sum / static_cast<float>(frameCount), maxMs);
+	ImGui::PlotLines("frame", frameTimes, static_cast<int>(frameCount), 0, overlay, 0.0f, maxMs * 1.2f, ImVec2(0.0f, 60.0f));
+
+	const Profiler::Frame& latest = profiler.GetFrame(0);
+	const Profiler::Frame& spike = profiler.GetFrame(slowest);
+	ImGui::Text("%-32s %9s %9s %6s", "zone", "last(ms)", "spike(ms)", "calls");
+	for (uint32_t zone = 0; zone < profiler.ZoneCount(); ++zone) {
+		ImGui::Text("%-32s %9.3f %9.3f %6u", profiler.ZoneName(zone),
+			static_cast<double>(latest.zoneTime[zone]) * 1e-6, static_cast<double>(spike.zoneTime[zone]) * 1e-6, latest.zoneCalls[zone]);
+	}
+	ImGui::Text("spike: frame %llu (%.2f ms)", static_cast<unsigned long long>(spike.index), static_cast<double>(spike.duration) * 1e-6);
+
+	ImGui::Separator();
+	for (uint32_t counter = 0; counter < profiler.CounterCount(); ++counter) {
+		ImGui::Text("%-32s %9lld", profiler.CounterName(counter), static_cast<long long>(latest.counters[counter]));
+	}
+
+	ImGui::Separator();
+	if (ImGui::Button("Chrome trace")) {
+		traceWritten = profiler.WriteChromeTrace(tracePath);
+		traceFailed = !traceWritten;
+	}
+	if (traceWritten) {
+		ImGui::Text("wrote %s", tracePath);
+	} else if (traceFailed) {
+		ImGui::Text("cannot write %s", tracePath);
+	}
+	ImGui::End();
+}
+
+#endif
@@ -3,7 +3,14 @@
 #include <cmath>
 #include <imgui.h>
 #include <algorithm>
+#include <chrono>
 #include "Math/Math.h"
+#include "Math/Camera.h"
+#include "Math/ContactSolver.h"
+#include "Math/FixedTimestep.h"
+#include "Math/Draw.h"
+#include "NoviceLineSink.h"
+#include "ProfilerWindow.h"
 
 const char kWindowTitle[] = "LE2A_19_ヨシトダイキ_タイトル";
 static const int kRowHeight = 20;
@@ -21,21 +28,30 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// ライブラリの初期化
 	Novice::Initialize(kWindowTitle, 1280, 720);
 
+	NoviceLineSink lineSink;
+	LineBatch lineBatch;
+	lineBatch.SetCullRect(0, 0, static_cast<int>(kWindowWidth), static_cast<int>(kWindowHeight));
+	Draw::SetLineBatch(&lineBatch);
+	// 遠くの球は画面上の大きさに合わせて分割数を減らす
+	Draw::SetLodSettings(LodSettings());
+
 	// キー入力結果を受け取る箱
 	char keys[256] = { 0 };
 	char preKeys[256] = { 0 };
 
-	Vector3 cameraScale = { 1.0f,1.0f,1.0f };
-	Vector3 cameraRotate = { 0.26f,0.0f,0.0f };
-	Vector3 cameraPosition = { 0.0f,2.0f,-6.5f };
-	Matrix4x4 cameraMatrix = MakeAffineMatrix(cameraScale, cameraRotate, cameraPosition);
-	Matrix4x4 viewMatrix = cameraMatrix.Inverse();
-	Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f, kWindowWidth / kWindowHeight, 0.1f, 100.0f);
-	Matrix4x4 viewportMatrix = MakeViewportMatrix(0.0f, 0.0f, kWindowWidth, kWindowHeight, 0.0f, 1.0f);
+	// 行列はカメラを動かしたフレームだけ作り直される
+	Camera camera;
+	camera.SetRotate({ 0.26f,0.0f,0.0f });
+	camera.SetTranslate({ 0.0f,2.0f,-6.5f });
+	camera.SetPerspective(0.45f, kWindowWidth / kWindowHeight, 0.1f, 100.0f);
+	camera.SetViewport(0.0f, 0.0f, kWindowWidth, kWindowHeight, 0.0f, 1.0f);
 
 	bool isDebugCamera = true;
 
-	float deltaTime = 1.0f / 60.0f;
+	// 物理は240Hzの固定ステップで進め、描画はその間を補間する
+	FixedTimestep timestep(1.0f / 240.0f);
+	BallSnapshot snapshot;
+	auto prevFrameTime = std::chrono::steady_clock::now();
 
 	Plane plane{};
 	plane.normal = Vector3(-0.2f, 0.9f, -0.3f).Normalize();
@@ -48,9 +64,21 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	ball.color = WHITE;
 	ball.acceleration = { 0.0f, -9.8f, 0.0f };
 
+	JobSystem jobSystem;
+	BallSystem balls;
+	balls.Add(ball);
+
+	ContactSolverSettings solverSettings;
+	solverSettings.restitution = 0.8f;
+	solverSettings.friction = 0.0f;
+	ContactSolver contactSolver(solverSettings);
+	contactSolver.AddPlane(plane);
+	snapshot.Capture(balls);
+
 	Sphere sphere{};
 	sphere.center = ball.position;
 	sphere.radius = ball.radius;
+	LodState sphereLod;
 
 	bool isStrated = false;
 
@@ -77,6 +105,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 				if (delta.x != 0.0f || delta.y != 0.0f) {
 					float moveSpeed = 0.005f;
 
+					const Vector3& cameraRotate = camera.GetRotate();
 					Vector3 forward = { cosf(cameraRotate.x) * sinf(cameraRotate.y),
 						sinf(cameraRotate.x),
 						cosf(cameraRotate.x) * cosf(cameraRotate.y)
@@ -87,7 +116,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 					Vector3 move = -right * delta.x * moveSpeed + up * delta.y * moveSpeed;
 
-					cameraPosition += move;
+					camera.SetTranslate(camera.GetTranslate() + move);
 				}
 			}
 
@@ -96,56 +125,44 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 				if (delta.x != 0.0f || delta.y != 0.0f) {
 					float rotateSpeed = 0.001f;
 
+					Vector3 cameraRotate = camera.GetRotate();
 					cameraRotate.x += delta.y * rotateSpeed;
 					cameraRotate.y += delta.x * rotateSpeed;
+					camera.SetRotate(cameraRotate);
 				}
 			}
 		}
 
-		cameraMatrix = MakeAffineMatrix(cameraScale, cameraRotate, cameraPosition);
-		viewMatrix = cameraMatrix.Inverse();
-		projectionMatrix = MakePerspectiveFovMatrix(0.45f, kWindowWidth / kWindowHeight, 0.1f, 100.0f);
+		auto frameTime = std::chrono::steady_clock::now();
+		float elapsed = std::chrono::duration<float>(frameTime - prevFrameTime).count();
+		prevFrameTime = frameTime;
 
 		if (isStrated) {
-			Vector3 prevPosition = ball.position;
-
-			ball.velocity += ball.acceleration * deltaTime;
-			ball.position += ball.velocity * deltaTime;
-
-			Capsule capsule;
-			capsule.segment.origin = prevPosition;
-			capsule.segment.diff = ball.position - prevPosition;
-			capsule.radius = ball.radius;
-
-			if (Collision::IsCollision(capsule, plane)) {
-				float e = 0.8f;
-				Vector3 reflected = Reflect(ball.velocity, plane.normal);
-				Vector3 projectToNormal = reflected.Project(plane.normal);
-				Vector3 movingDirection = reflected - projectToNormal;
-				ball.velocity = projectToNormal * e + movingDirection;
-
-				float distToPlane = plane.SignedDistance(ball.position);
-				float penetration = ball.radius - distToPlane;
-				if (penetration > 0.0f) {
-					ball.position += plane.normal * penetration;
+			MT3_PROFILE_ZONE("Physics");
+			timestep.Advance(elapsed, [&](float stepTime) {
+				snapshot.Capture(balls);
+				contactSolver.Step(balls, stepTime, &jobSystem);
+
+				if (balls.GetPosition(0).y <= -2.0f) {
+					balls.SetPosition(0, { 0.8f, 3.0f, 0.9f });
+					balls.SetVelocity(0, { 0.0f, 0.0f, 0.0f });
+					// 戻した位置まで補間で線を引かないようにする
+					snapshot.Capture(balls);
 				}
-			}
+				});
 
-			sphere.center = ball.position;
-
-			if (ball.position.y <= -2.0f) {
-				ball.position = { 0.8f, 3.0f, 0.9f };
-				ball.velocity = { 0.0f, 0.0f, 0.0f };
-			}
+			sphere.center = snapshot.Interpolate(balls, 0, timestep.Alpha());
 		}
 
 		///
 		/// ↑更新処理ここまで
 		///
 
-		Draw::DrawGrid((viewMatrix * projectionMatrix), viewportMatrix);
-		Draw::DrawPlane(plane, (viewMatrix * projectionMatrix), viewportMatrix, WHITE);
-		Draw::DrawSphere(sphere, (viewMatrix * projectionMatrix), viewportMatrix, WHITE);
+		const Matrix4x4& viewProjectionMatrix = camera.GetViewProjectionMatrix();
+		const Matrix4x4& viewportMatrix = camera.GetViewportMatrix();
+		Draw::DrawGrid(viewProjectionMatrix, viewportMatrix);
+		Draw::DrawPlane(plane, viewProjectionMatrix, viewportMatrix, WHITE);
+		Draw::DrawSphere(sphere, viewProjectionMatrix, viewportMatrix, WHITE, &sphereLod);
 
 		///
 		/// ↓描画処理ここから
@@ -158,7 +175,12 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 		}
 		ImGui::End();
 #endif // _DEBUG
+#ifdef MT3_PROFILER_ENABLED
+		ShowProfilerWindow();
+#endif
+
 
+		lineBatch.Flush(lineSink);
 
 		///
 		/// ↑描画処理ここまで
@@ -166,6 +188,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 		// フレームの終了
 		Novice::EndFrame();
+		MT3_PROFILE_FRAME();
 
 		// ESCキーが押されたらループを抜ける
 		if (preKeys[DIK_ESCAPE] == 0 && keys[DIK_ESCAPE] != 0) {